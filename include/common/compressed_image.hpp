@@ -0,0 +1,145 @@
+#pragma once
+
+// STL modules
+#include <cstdint>
+#include <cstring>
+#include <cctype>
+#include <algorithm>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+// Library {fmt}
+#include <fmt/format.h>
+
+// Graphics libraries
+#include <GL/glew.h>
+
+namespace kc {
+
+namespace CompressedImageConst
+{
+    /// @brief Container extension written by texture compressor
+    constexpr const char* Extension = ".dds";
+
+    /// @brief Container extension for images compressed with vertical flip baked in
+    constexpr const char* FlippedExtension = ".flip.dds";
+}
+
+class CompressedImage
+{
+public:
+    struct Level
+    {
+        int width;
+        int height;
+        size_t offset;
+        size_t size;
+    };
+
+public:
+    /// @brief Get size of one 4x4 block of compressed format
+    /// @param format GL compressed internal format
+    /// @return Block size in bytes or 0 if format is not supported
+    static size_t BlockSize(unsigned int format);
+
+    /// @brief Get size of one compressed mipmap level
+    /// @param format GL compressed internal format
+    /// @param width Level width
+    /// @param height Level height
+    /// @return Level size in bytes
+    static size_t LevelSize(unsigned int format, int width, int height);
+
+    /// @brief Check if file is a compressed image container by its extension (.dds, .ktx)
+    /// @param filePath Path to the file
+    /// @return True if file is a compressed image container
+    static bool IsContainer(const std::string& filePath);
+
+private:
+    unsigned int m_format;
+    std::vector<uint8_t> m_data;
+    std::vector<Level> m_levels;
+
+private:
+    /// @brief Parse DDS container
+    /// @param filePath Path to the file for error messages
+    /// @param file File contents
+    /// @throw std::runtime_error if container is corrupt or format is not supported
+    void parseDds(const std::string& filePath, std::vector<uint8_t>& file);
+
+    /// @brief Parse KTX 1.1 container
+    /// @param filePath Path to the file for error messages
+    /// @param file File contents
+    /// @throw std::runtime_error if container is corrupt or format is not supported
+    void parseKtx(const std::string& filePath, std::vector<uint8_t>& file);
+
+public:
+    /// @brief Open DDS or KTX 1.1 file with compressed 2D texture and its mipmap chain
+    /// @param filePath Path to image file
+    /// @throw std::runtime_error if image couldn't be opened, is corrupt or its format is not supported
+    CompressedImage(const std::string& filePath);
+
+    /// @brief Create empty image to append mipmap levels to
+    /// @param format GL compressed internal format
+    /// @throw std::runtime_error if format is not supported
+    CompressedImage(unsigned int format);
+
+    /// @brief Append next mipmap level
+    /// @param width Level width
+    /// @param height Level height
+    /// @param data Compressed blocks, row by row
+    /// @throw std::runtime_error if data size doesn't match level size
+    void append(int width, int height, const std::vector<uint8_t>& data);
+
+    /// @brief Save image as DDS file
+    /// @param filePath Path to image file
+    /// @throw std::runtime_error if image couldn't be saved
+    void save(const std::string& filePath) const;
+
+    /// @brief Get GL compressed internal format
+    /// @return GL compressed internal format
+    inline unsigned int format() const
+    {
+        return m_format;
+    }
+
+    /// @brief Get mipmap levels, the first one is the full image
+    /// @return Mipmap levels
+    inline const std::vector<Level>& levels() const
+    {
+        return m_levels;
+    }
+
+    /// @brief Get compressed data of mipmap level
+    /// @param level Level index
+    /// @return Level data
+    inline const uint8_t* data(size_t level) const
+    {
+        return m_data.data() + m_levels[level].offset;
+    }
+
+    /// @brief Get size of every mipmap level together
+    /// @return Size in bytes
+    inline size_t size() const
+    {
+        return m_data.size();
+    }
+
+    /// @brief Get image width
+    /// @return Image width
+    inline int width() const
+    {
+        return m_levels.empty() ? 0 : m_levels.front().width;
+    }
+
+    /// @brief Get image height
+    /// @return Image height
+    inline int height() const
+    {
+        return m_levels.empty() ? 0 : m_levels.front().height;
+    }
+};
+
+} // namespace kc
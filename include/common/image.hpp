@@ -20,12 +20,16 @@ private:
     int m_channels;
 
 public:
-    /// @brief Open image file
+    /// @brief Open image file, safe to call from multiple threads
     /// @param imageFilePath Path to image file
     /// @param verticalFlip Whether to flip image vertically on load or not
     /// @throw std::runtime_error if image couldn't be opened
     Image(const std::string& imageFilePath, bool verticalFlip = false);
 
+    Image(Image&& other) noexcept;
+
+    Image(const Image& other) = delete;
+
     ~Image();
 
     /// @brief Get image data
@@ -0,0 +1,128 @@
+#pragma once
+
+// STL modules
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+#include <iterator>
+
+namespace kc {
+
+namespace JobSystemConst
+{
+    /// @brief Queue of threads outside the pool, workers own the queues after it
+    constexpr size_t External = 0;
+}
+
+/// @brief Fixed pool of workers that steal jobs from each other's queues
+class JobSystem
+{
+public:
+    /// @brief Job to run, must not throw
+    using Job = std::function<void()>;
+
+    /// @brief Body of parallel loop
+    using Range = std::function<void(size_t begin, size_t end)>;
+
+    /// @brief Counts unfinished jobs of one fork, wait() joins them
+    class Counter
+    {
+    private:
+        friend class JobSystem;
+        std::atomic<size_t> m_pending = 0;
+
+    public:
+        /// @brief Check if every counted job is finished
+        /// @return True if no counted job is left
+        inline bool done() const
+        {
+            return m_pending.load(std::memory_order_acquire) == 0;
+        }
+    };
+
+private:
+    struct Task
+    {
+        Job job;
+        Counter* counter;
+    };
+
+    /// @brief Owner pushes and pops at the back, thieves take from the front, so they rarely meet
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+private:
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_workers;
+    std::atomic<size_t> m_queued;
+    std::mutex m_sleepMutex;
+    std::condition_variable m_sleepCondition;
+    bool m_stopping;
+
+private:
+    /// @brief Get queue of calling thread
+    /// @return Queue index
+    size_t queue() const;
+
+    /// @brief Take a job from own queue or steal one from others
+    /// @param queue Queue of calling thread
+    /// @param counter Take only jobs counted by it, any job if null
+    /// @param task Set to taken job
+    /// @return True if a job was taken
+    bool take(size_t queue, const Counter* counter, Task& task);
+
+    /// @brief Run one job if there is any
+    /// @param queue Queue of calling thread
+    /// @param counter Run only jobs counted by it, any job if null
+    /// @return True if a job was run
+    bool runOne(size_t queue, const Counter* counter = nullptr);
+
+    /// @brief Worker thread loop
+    /// @param queue Worker queue
+    void work(size_t queue);
+
+public:
+    /// @brief Start workers
+    /// @param workerCount Number of workers, the thread waiting for jobs always helps them
+    JobSystem(size_t workerCount = std::max(std::thread::hardware_concurrency(), 1u) - 1);
+
+    JobSystem(const JobSystem& other) = delete;
+
+    /// @brief Stop workers, queued jobs are dropped
+    ~JobSystem();
+
+    /// @brief Queue job on calling thread's queue
+    /// @param counter Counter to count job with
+    /// @param job The job
+    void run(Counter& counter, Job&& job);
+
+    /// @brief Run jobs counted by counter until all of them are finished.
+    /// Other jobs are left to workers, so a frame waiting for its fork never picks up long streaming jobs.
+    /// @param counter Counter to wait for
+    void wait(Counter& counter);
+
+    /// @brief Split range into chunks of grain elements and run them in parallel
+    /// @param count Number of elements
+    /// @param grain Elements per chunk, chunk i always starts at i * grain
+    /// @param body Loop body, called once per chunk
+    void parallelFor(size_t count, size_t grain, const Range& body);
+
+    /// @brief Get number of workers
+    /// @return Number of workers
+    inline size_t workers() const
+    {
+        return m_workers.size();
+    }
+};
+
+} // namespace kc
@@ -0,0 +1,48 @@
+#pragma once
+
+// STL modules
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+
+// Library {fmt}
+#include <fmt/format.h>
+
+namespace kc {
+
+class MappedFile
+{
+private:
+    const uint8_t* m_data;
+    size_t m_size;
+#ifdef _WIN32
+    void* m_file;
+    void* m_mapping;
+#endif
+
+public:
+    /// @brief Map file into memory for reading
+    /// @param filePath Path to the file
+    /// @throw std::runtime_error if file couldn't be mapped
+    MappedFile(const std::string& filePath);
+
+    MappedFile(const MappedFile& other) = delete;
+
+    ~MappedFile();
+
+    /// @brief Get mapped file contents
+    /// @return Mapped file contents
+    inline const uint8_t* data() const
+    {
+        return m_data;
+    }
+
+    /// @brief Get mapped file size
+    /// @return Mapped file size
+    inline size_t size() const
+    {
+        return m_size;
+    }
+};
+
+} // namespace kc
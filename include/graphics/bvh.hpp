@@ -0,0 +1,108 @@
+#pragma once
+
+// STL modules
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <functional>
+
+// Graphics libraries
+#include <glm/glm.hpp>
+
+// Custom modules
+#include "graphics/types/bounding_box.hpp"
+#include "graphics/frustum.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace BvhConst
+    {
+        /// @brief Number of bins split candidates are evaluated at
+        constexpr size_t Bins = 16;
+
+        /// @brief Marks missing node or object
+        constexpr uint32_t Invalid = std::numeric_limits<uint32_t>::max();
+    }
+
+    /// @brief Bounding volume hierarchy over objects with boxes, refittable when objects move
+    class Bvh
+    {
+    public:
+        using Visitor = std::function<void(uint32_t object)>;
+
+    private:
+        struct Node
+        {
+            BoundingBox box;
+            uint32_t parent;
+            uint32_t left;
+            uint32_t right;
+            uint32_t object;    // leaves only, Invalid for inner nodes
+        };
+
+    private:
+        std::vector<Node> m_nodes;
+        std::vector<uint32_t> m_leaves;
+        mutable std::vector<uint32_t> m_stack;
+
+    private:
+        /// @brief Build subtree with binned surface area heuristic
+        /// @param objects Objects of subtree, reordered while building
+        /// @param boxes Boxes of all objects
+        /// @param parent Parent node
+        /// @return Subtree root node
+        uint32_t buildNode(std::span<uint32_t> objects, std::span<const BoundingBox> boxes, uint32_t parent);
+
+        /// @brief Report every object below node
+        /// @param node Subtree root node
+        /// @param visitor Visitor to report objects to
+        void collect(uint32_t node, const Visitor& visitor) const;
+
+    public:
+        /// @brief Build hierarchy from scratch
+        /// @param boxes Boxes of objects, object is its box index
+        void build(std::span<const BoundingBox> boxes);
+
+        /// @brief Move object and refit its ancestors
+        /// @param object The object that moved
+        /// @param box New object box
+        void update(uint32_t object, const BoundingBox& box);
+
+        /// @brief Refit every node to new object boxes, keeping tree structure
+        /// @param boxes Boxes of objects, same count as at build time
+        void refit(std::span<const BoundingBox> boxes);
+
+        /// @brief Report objects whose boxes intersect frustum
+        /// @param frustum World space frustum
+        /// @param visitor Visitor to report visible objects to
+        /// @return Number of reported objects
+        size_t cull(const Frustum& frustum, const Visitor& visitor) const;
+
+        /// @brief Report objects whose boxes overlap box
+        /// @param box World space box
+        /// @param visitor Visitor to report objects to
+        void query(const BoundingBox& box, const Visitor& visitor) const;
+
+        /// @brief Find the nearest object whose box ray hits
+        /// @param origin Ray origin
+        /// @param direction Ray direction
+        /// @param distance Set to distance to hit box
+        /// @return Hit object or BvhConst::Invalid if nothing is hit
+        uint32_t raycast(const glm::vec3& origin, const glm::vec3& direction, float& distance) const;
+
+        /// @brief Get number of objects
+        /// @return Number of objects
+        inline size_t size() const
+        {
+            return m_leaves.size();
+        }
+    };
+}
+
+} // namespace kc
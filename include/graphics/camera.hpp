@@ -2,7 +2,6 @@
 
 // STL modules
 #include <cmath>
-#include <vector>
 
 // Graphics libraries
 #include <glm/glm.hpp>
@@ -10,7 +9,9 @@
 
 // Custom modules
 #include "common/utility.hpp"
-#include "graphics/shader_program.hpp"
+#include "graphics/types/uniform_blocks.hpp"
+#include "graphics/frustum.hpp"
+#include "graphics/stream_buffer.hpp"
 
 namespace kc {
 
@@ -84,6 +85,9 @@ namespace Graphics
         float m_yaw;
         float m_pitch;
         float m_zoom;
+        glm::mat4 m_view;
+        glm::mat4 m_projection;
+        Frustum m_frustum;
 
     public:
         Camera();
@@ -94,6 +98,11 @@ namespace Graphics
         /// @brief Reset camera zoom
         void resetZoom();
 
+        /// @brief Place camera and turn it to target, zoom is kept
+        /// @param position New camera position
+        /// @param target Point to look at
+        void lookAt(const glm::vec3& position, const glm::vec3& target);
+
         /// @brief Tell camera that keyboard key was pressed
         /// @param key The key that was pressed
         /// @param mode Camera movement mode
@@ -109,11 +118,20 @@ namespace Graphics
         /// @param offset Scroll offset
         void mouseScrolled(int offset);
 
-        /// @brief Apply camera calculations to shader programs
-        /// @param shaderPrograms Shader programs to apply calculations to
+        /// @brief Calculate camera matrices and upload them as frame uniform block
+        /// @param stream Stream buffer to write frame block to
+        /// @param width Window width
+        /// @param height Window height
+        void capture(StreamBuffer& stream, unsigned int width, unsigned int height);
+
+        /// @brief Calculate view, projection and frustum without touching OpenGL
         /// @param width Window width
         /// @param height Window height
-        void capture(const std::vector<std::reference_wrapper<ShaderProgram>>& shaderPrograms, unsigned int width, unsigned int height);
+        void update(unsigned int width, unsigned int height);
+
+        /// @brief Upload camera calculations of last update as frame uniform block
+        /// @param stream Stream buffer to write frame block to
+        void upload(StreamBuffer& stream) const;
 
         /// @brief Get camera position
         /// @return Camera position
@@ -128,6 +146,27 @@ namespace Graphics
         {
             return m_front;
         }
+
+        /// @brief Get view matrix calculated by last capture
+        /// @return View matrix
+        inline const glm::mat4& view() const
+        {
+            return m_view;
+        }
+
+        /// @brief Get projection matrix calculated by last capture
+        /// @return Projection matrix
+        inline const glm::mat4& projection() const
+        {
+            return m_projection;
+        }
+
+        /// @brief Get world space frustum calculated by last capture
+        /// @return View frustum, counts what was culled against it since then
+        inline const Frustum& frustum() const
+        {
+            return m_frustum;
+        }
     };
 }
 
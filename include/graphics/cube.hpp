@@ -1,13 +1,24 @@
 #pragma once
 
+// STL modules
+#include <iterator>
+#include <memory>
+
 // Graphics libraries
 #include <GL/glew.h>
 
 // Custom libraries
+#include "graphics/types/bounding_box.hpp"
+#include "graphics/types/bounding_sphere.hpp"
 #include "graphics/types/color.hpp"
 #include "graphics/types/material.hpp"
 #include "graphics/types/transform.hpp"
+#include "graphics/camera.hpp"
+#include "graphics/instance_buffer.hpp"
+#include "graphics/render_queue.hpp"
 #include "graphics/shader_program.hpp"
+#include "graphics/state_cache.hpp"
+#include "graphics/stream_buffer.hpp"
 
 namespace kc {
 
@@ -16,9 +27,20 @@ namespace Graphics
     class Cube
     {
     private:
-        unsigned int m_vertexArrayObject;
-        unsigned int m_vertexBufferObject;
-        unsigned int m_elementBufferObject;
+        struct Objects
+        {
+            unsigned int vertexArray;
+            unsigned int vertexBuffer;
+            unsigned int elementBuffer;
+        };
+
+    private:
+        /// @brief Get cube geometry shared by all cubes
+        /// @return Shared objects, created if no cube exists yet
+        static std::shared_ptr<const Objects> SharedObjects();
+
+    private:
+        std::shared_ptr<const Objects> m_objects;
 
     protected:
         Transform m_transform;
@@ -35,11 +57,52 @@ namespace Graphics
         /// @param material Cube material
         Cube(const Transform& transform, Color color, const Material& material);
 
-        ~Cube();
-
         /// @brief Draw cube to the screen
         /// @param shaderProgram Shader program to draw with
-        void draw(ShaderProgram& shaderProgram) const;
+        /// @param camera Camera to draw for
+        /// @param stream Stream buffer to write object block to
+        void draw(ShaderProgram& shaderProgram, const Camera& camera, StreamBuffer& stream) const;
+
+        /// @brief Draw cube to the screen relative to parent transform
+        /// @param shaderProgram Shader program to draw with
+        /// @param camera Camera to draw for
+        /// @param stream Stream buffer to write object block to
+        /// @param parent Parent model matrix
+        void draw(ShaderProgram& shaderProgram, const Camera& camera, StreamBuffer& stream, const glm::mat4& parent) const;
+
+        /// @brief Submit cube draw to render queue, culled cubes aren't submitted
+        /// @param queue Render queue to submit to, cube must outlive its execution
+        /// @param shaderProgram Shader program to draw with
+        /// @param camera Camera to draw for
+        /// @param parent Parent model matrix
+        /// @param condition Occlusion query to render on, 0 for none
+        /// @return Submitted packet or nullptr if cube was culled
+        RenderQueue::Packet* submit(RenderQueue& queue, ShaderProgram& shaderProgram, const Camera& camera, const glm::mat4& parent = glm::mat4(1.0f), unsigned int condition = 0) const;
+
+        /// @brief Draw bare cube geometry without culling, color and material, e.g. as a proxy for bounds
+        /// @param shaderProgram Shader program to draw with
+        /// @param modelView Model-view matrix, cube transform not applied
+        /// @param stream Stream buffer to write object block to
+        void drawGeometry(ShaderProgram& shaderProgram, const glm::mat4& modelView, StreamBuffer& stream) const;
+
+        /// @brief Draw cube instances with cube material, ignoring cube transform and color
+        /// @param shaderProgram Instanced shader program to draw with
+        /// @param instances Uploaded instances
+        void drawInstanced(ShaderProgram& shaderProgram, const InstanceBuffer& instances) const;
+
+        /// @brief Get sphere enclosing cube geometry, cube transform not applied
+        /// @return Bounding sphere in cube space
+        inline BoundingSphere boundingSphere() const
+        {
+            return BoundingSphere::FromBox(glm::vec3(-0.5f), glm::vec3(0.5f));
+        }
+
+        /// @brief Get cube geometry box, cube transform not applied
+        /// @return Bounding box in cube space
+        inline BoundingBox boundingBox() const
+        {
+            return { glm::vec3(-0.5f), glm::vec3(0.5f) };
+        }
 
         /// @brief Get cube transform
         /// @return Cube transform
@@ -0,0 +1,160 @@
+#pragma once
+
+// STL modules
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <stdexcept>
+
+// Library {fmt}
+#include <fmt/format.h>
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace FramePipelineConst
+    {
+        /// @brief Frames simulation may run ahead of rendering, one more than that are kept
+        constexpr size_t MaximumLatency = 1;
+    }
+
+    /// @brief Two-stage frame pipeline: a simulation thread fills the next frame snapshot while the render thread draws the current one
+    /// @tparam Frame Snapshot of everything rendering needs, default constructible and reused from frame to frame
+    template <typename Frame>
+    class FramePipeline
+    {
+    public:
+        /// @brief Fills frame snapshot, must not touch OpenGL or throw
+        using Simulation = std::function<void(Frame& frame)>;
+
+    private:
+        enum class State
+        {
+            Free,
+            Simulated,
+            Rendering,
+        };
+
+    private:
+        Frame m_frames[FramePipelineConst::MaximumLatency + 1];
+        State m_states[FramePipelineConst::MaximumLatency + 1];
+        Simulation m_simulation;
+        std::thread m_thread;
+        std::mutex m_mutex;
+        std::condition_variable m_condition;
+        size_t m_latency;
+        size_t m_renderFrame;
+        bool m_stopping;
+
+    private:
+        /// @brief Simulation thread loop
+        void simulate()
+        {
+            for (size_t frame = 0;; frame = (frame + 1) % (m_latency + 1))
+            {
+                {
+                    std::unique_lock lock(m_mutex);
+                    m_condition.wait(lock, [this, frame]() { return m_stopping || m_states[frame] == State::Free; });
+                    if (m_stopping)
+                        return;
+                }
+
+                m_simulation(m_frames[frame]);
+                {
+                    std::lock_guard lock(m_mutex);
+                    m_states[frame] = State::Simulated;
+                }
+                m_condition.notify_all();
+            }
+        }
+
+    public:
+        FramePipeline()
+            : m_latency(0)
+            , m_renderFrame(0)
+            , m_stopping(false)
+        {}
+
+        FramePipeline(const FramePipeline& other) = delete;
+
+        ~FramePipeline()
+        {
+            stop();
+        }
+
+        /// @brief Start pipeline
+        /// @param simulation Simulation filling frame snapshots
+        /// @param latency Frames simulation may run ahead, 0 simulates each frame on the render thread right before it's drawn
+        /// @throw std::runtime_error if latency is too high
+        void start(Simulation&& simulation, size_t latency)
+        {
+            if (latency > FramePipelineConst::MaximumLatency)
+                throw std::runtime_error(fmt::format("kc::Graphics::FramePipeline::start(): Latency {} is higher than {}", latency, FramePipelineConst::MaximumLatency));
+
+            stop(); // avoid running two simulations if start() was called already
+            m_simulation = std::move(simulation);
+            m_latency = latency;
+            m_renderFrame = 0;
+            m_stopping = false;
+            for (State& state : m_states)
+                state = State::Free;
+            if (m_latency)
+                m_thread = std::thread(&FramePipeline::simulate, this);
+        }
+
+        /// @brief Stop simulation thread, must be called before anything simulation references dies
+        void stop()
+        {
+            {
+                std::lock_guard lock(m_mutex);
+                m_stopping = true;
+            }
+            m_condition.notify_all();
+            if (m_thread.joinable())
+                m_thread.join();
+        }
+
+        /// @brief Take the next simulated frame for rendering, waiting for simulation if it's behind
+        /// @return Frame snapshot, valid until release()
+        Frame& acquire()
+        {
+            Frame& frame = m_frames[m_renderFrame];
+            if (!m_latency)
+            {
+                m_simulation(frame);
+                return frame;
+            }
+
+            std::unique_lock lock(m_mutex);
+            m_condition.wait(lock, [this]() { return m_states[m_renderFrame] == State::Simulated; });
+            m_states[m_renderFrame] = State::Rendering;
+            return frame;
+        }
+
+        /// @brief Give rendered frame back to simulation
+        void release()
+        {
+            if (!m_latency)
+                return;
+
+            {
+                std::lock_guard lock(m_mutex);
+                m_states[m_renderFrame] = State::Free;
+            }
+            m_condition.notify_all();
+            m_renderFrame = (m_renderFrame + 1) % (m_latency + 1);
+        }
+
+        /// @brief Get frames simulation may run ahead of rendering
+        /// @return Pipeline latency
+        inline size_t latency() const
+        {
+            return m_latency;
+        }
+    };
+}
+
+} // namespace kc
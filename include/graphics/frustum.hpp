@@ -0,0 +1,89 @@
+#pragma once
+
+// STL modules
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <atomic>
+#include <algorithm>
+
+// Graphics libraries
+#include <glm/glm.hpp>
+
+// Custom modules
+#include "graphics/types/bounding_box.hpp"
+#include "graphics/types/bounding_sphere.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace FrustumConst
+    {
+        /// @brief Spheres tested together, a block fills two SSE registers per component
+        constexpr size_t Lanes = 8;
+    }
+
+    /// @brief View frustum planes extracted from view-projection matrix
+    class Frustum
+    {
+    public:
+        struct Statistics
+        {
+            size_t visible = 0;
+            size_t culled = 0;
+        };
+
+    private:
+        /// @brief Plane normals point inside, stored as component arrays like sphere blocks in cull()
+        float m_x[6];
+        float m_y[6];
+        float m_z[6];
+        float m_w[6];
+        mutable Statistics m_statistics;
+
+    public:
+        /// @brief Create frustum that contains everything
+        Frustum();
+
+        /// @brief Extract frustum planes
+        /// @param viewProjection Projection matrix times view matrix
+        explicit Frustum(const glm::mat4& viewProjection);
+
+        /// @brief Test sphere against frustum and count the result
+        /// @param sphere World space sphere
+        /// @return True if sphere is at least partially inside
+        bool visible(const BoundingSphere& sphere) const;
+
+        /// @brief Test spheres against frustum in one pass and count the results
+        /// @param spheres World space spheres
+        /// @param visible Result for every sphere, 1 if it is at least partially inside
+        /// @return Number of visible spheres
+        size_t cull(std::span<const BoundingSphere> spheres, std::span<uint8_t> visible) const;
+
+        /// @brief Test box against frustum without counting, used for hierarchy nodes
+        /// @param box World space box
+        /// @param inside Set to true if box is completely inside
+        /// @return True if box is at least partially inside
+        bool intersects(const BoundingBox& box, bool& inside) const;
+
+        /// @brief Add to visible and culled counts
+        /// @param visible Number of visible objects
+        /// @param culled Number of culled objects
+        inline void count(size_t visible, size_t culled) const
+        {
+            // Jobs cull against the same frustum concurrently
+            std::atomic_ref<size_t>(m_statistics.visible).fetch_add(visible, std::memory_order_relaxed);
+            std::atomic_ref<size_t>(m_statistics.culled).fetch_add(culled, std::memory_order_relaxed);
+        }
+
+        /// @brief Get visible and culled counts since frustum was extracted
+        /// @return Culling statistics
+        inline const Statistics& statistics() const
+        {
+            return m_statistics;
+        }
+    };
+}
+
+} // namespace kc
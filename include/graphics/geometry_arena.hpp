@@ -0,0 +1,177 @@
+#pragma once
+
+// STL modules
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <span>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+// Library {fmt}
+#include <fmt/format.h>
+
+// Graphics libraries
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Custom modules
+#include "graphics/types/vertex.hpp"
+#include "graphics/state_cache.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    /// @brief Vertex and index buffers shared by many meshes under a single vertex array
+    class GeometryArena
+    {
+    public:
+        /// @brief Part of the arena owned by one mesh
+        struct Range
+        {
+            int baseVertex;
+            size_t indexOffset;         // in bytes
+            size_t indexCount;
+            unsigned int indexType;     // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+        };
+
+        /// @brief Ranges with the same index type collected to be drawn with one multi-draw call
+        struct Batch
+        {
+            unsigned int indexType = GL_UNSIGNED_INT;
+            std::vector<GLsizei> counts;
+            std::vector<void*> offsets;
+            std::vector<GLint> baseVertices;
+
+            /// @brief Add range to batch
+            /// @param range The range to add, must have batch index type
+            void add(const Range& range);
+
+            /// @brief Remove every range from batch
+            void clear();
+        };
+
+    public:
+        /// @brief Get size of one vertex in GPU buffer
+        /// @param format Vertex format
+        /// @return Vertex size in bytes
+        static size_t Stride(VertexFormat format);
+
+    private:
+        unsigned int m_vertexArray;
+        unsigned int m_vertexBuffer;
+        unsigned int m_elementBuffer;
+        VertexFormat m_format;
+        glm::vec3 m_minimum;
+        glm::vec3 m_extent;
+        size_t m_vertexCapacity;
+        size_t m_indexCapacity;     // in bytes
+        size_t m_vertexCount;
+        size_t m_indexSize;         // in bytes
+
+    private:
+        /// @brief Free allocated resources
+        void free();
+
+        /// @brief Move buffer contents to a bigger buffer
+        /// @param buffer The buffer to grow, replaced with the new one
+        /// @param usedBytes Number of bytes to keep
+        /// @param capacityBytes New buffer size in bytes
+        static void Grow(unsigned int& buffer, size_t usedBytes, size_t capacityBytes);
+
+        /// @brief Point vertex array at current arena buffers
+        void attach();
+
+        /// @brief Make sure arena fits more geometry, growing buffers geometrically if it doesn't
+        /// @param vertexCount Number of vertices to fit
+        /// @param indexSize Number of index bytes to fit
+        void reserve(size_t vertexCount, size_t indexSize);
+
+        /// @brief Upload indices to the end of the index buffer
+        /// @param indices Indices to upload
+        /// @param indexType Index type to store indices as (GL_UNSIGNED_SHORT or GL_UNSIGNED_INT)
+        /// @param vertexCount Number of vertices to reserve along with indices
+        /// @return Byte offset of uploaded indices
+        size_t appendIndices(std::span<const Indice> indices, unsigned int indexType, size_t vertexCount);
+
+        /// @brief Convert vertices to arena format
+        /// @param vertices Vertices to convert
+        /// @return Converted vertices
+        std::vector<std::byte> pack(std::span<const Vertex> vertices) const;
+
+    public:
+        GeometryArena();
+
+        GeometryArena(GeometryArena&& other) noexcept;
+
+        GeometryArena(const GeometryArena& other) = delete;
+
+        ~GeometryArena();
+
+        /// @brief Create arena
+        /// @param vertexCapacity Number of vertices to preallocate
+        /// @param indexCapacity Number of indices to preallocate
+        /// @param format Vertex format to store vertices in
+        /// @param minimum Minimum corner of quantization bounds, used by quantized format only
+        /// @param maximum Maximum corner of quantization bounds, used by quantized format only
+        void create(size_t vertexCapacity, size_t indexCapacity, VertexFormat format = VertexFormat::Full,
+            const glm::vec3& minimum = glm::vec3(0.0f), const glm::vec3& maximum = glm::vec3(1.0f));
+
+        /// @brief Upload geometry to the end of the arena, meshes with less than 65536 vertices get 16-bit indices
+        /// @param vertices Mesh vertices, quantized positions are clamped to arena bounds
+        /// @param indices Mesh indices, relative to the first mesh vertex
+        /// @throw std::runtime_error if arena wasn't created
+        /// @return Arena range of uploaded geometry
+        Range allocate(std::span<const Vertex> vertices, std::span<const Indice> indices);
+
+        /// @brief Upload another index list for vertices that are already in the arena, used for detail levels
+        /// @param base Range of uploaded vertices, its index type is kept
+        /// @param indices Indices relative to the first range vertex
+        /// @throw std::runtime_error if arena wasn't created
+        /// @return Arena range sharing base vertices
+        Range allocateIndices(const Range& base, std::span<const Indice> indices);
+
+        /// @brief Bind arena vertex array
+        void bind() const;
+
+        /// @brief Draw single range, arena must be bound
+        /// @param range The range to draw
+        void draw(const Range& range) const;
+
+        /// @brief Draw every batch range with one call, arena must be bound
+        /// @param batch The batch to draw
+        void draw(const Batch& batch) const;
+
+        /// @brief Get arena vertex array
+        /// @return Arena vertex array, stays the same when arena grows
+        inline unsigned int vertexArray() const
+        {
+            return m_vertexArray;
+        }
+
+        /// @brief Get transform from stored to original positions
+        /// @return Dequantization transform, identity unless format is quantized
+        glm::mat4 dequantization() const;
+
+        /// @brief Get arena vertex format
+        /// @return Vertex format
+        inline VertexFormat format() const
+        {
+            return m_format;
+        }
+
+        /// @brief Get GPU memory used by arena buffers
+        /// @return Allocated bytes
+        inline size_t memory() const
+        {
+            return m_vertexCapacity * Stride(m_format) + m_indexCapacity;
+        }
+    };
+}
+
+} // namespace kc
@@ -0,0 +1,108 @@
+#pragma once
+
+// STL modules
+#include <vector>
+#include <cstdint>
+
+// Graphics libraries
+#include <glm/glm.hpp>
+
+// Custom modules
+#include "graphics/types/bounding_sphere.hpp"
+#include "graphics/types/color.hpp"
+#include "graphics/types/instance_record.hpp"
+#include "graphics/types/transform.hpp"
+#include "graphics/types/uniform_blocks.hpp"
+#include "graphics/frustum.hpp"
+#include "graphics/instance_buffer.hpp"
+#include "graphics/shader_program.hpp"
+#include "graphics/stream_buffer.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    /// @brief Collects instances of one drawable and draws them with one instanced call per mesh
+    /// @tparam Drawable Anything with drawInstanced(ShaderProgram&, const InstanceBuffer&) const and boundingSphere() const (Cube, Model)
+    template <typename Drawable>
+    class InstanceBatch
+    {
+    private:
+        InstanceBuffer m_buffer;
+        std::vector<InstanceRecord> m_records;
+        std::vector<InstanceRecord> m_visibleRecords;
+        std::vector<BoundingSphere> m_spheres;
+        std::vector<uint8_t> m_visible;
+
+    public:
+        /// @brief Remove all instances
+        inline void clear()
+        {
+            m_records.clear();
+        }
+
+        /// @brief Add instance
+        /// @param transform Instance transform
+        /// @param color Instance color
+        inline void add(const Transform& transform, Color color = {})
+        {
+            m_records.push_back({ transform.matrix(), UniformBlocks::Pack(color) });
+        }
+
+        /// @brief Add instance
+        /// @param model Instance model matrix
+        /// @param color Instance color
+        inline void add(const glm::mat4& model, const glm::vec4& color = glm::vec4(1.0f))
+        {
+            m_records.push_back({ model, color });
+        }
+
+        /// @brief Upload instances and draw them
+        /// @param shaderProgram Instanced shader program to draw with
+        /// @param drawable The drawable to draw instances of
+        /// @param stream Stream buffer to upload instances to
+        inline void draw(ShaderProgram& shaderProgram, const Drawable& drawable, StreamBuffer& stream)
+        {
+            if (m_records.empty())
+                return;
+
+            m_buffer.upload(stream, m_records);
+            drawable.drawInstanced(shaderProgram, m_buffer);
+        }
+
+        /// @brief Upload instances inside frustum and draw them
+        /// @param shaderProgram Instanced shader program to draw with
+        /// @param drawable The drawable to draw instances of
+        /// @param frustum World space frustum to cull instances against
+        /// @param stream Stream buffer to upload instances to
+        inline void draw(ShaderProgram& shaderProgram, const Drawable& drawable, const Frustum& frustum, StreamBuffer& stream)
+        {
+            BoundingSphere sphere = drawable.boundingSphere();
+            m_spheres.clear();
+            for (const InstanceRecord& record : m_records)
+                m_spheres.push_back(sphere.transformed(record.model));
+            m_visible.resize(m_records.size());
+            if (frustum.cull(m_spheres, m_visible) == 0)
+                return;
+
+            m_visibleRecords.clear();
+            for (size_t index = 0, size = m_records.size(); index < size; ++index)
+            {
+                if (m_visible[index])
+                    m_visibleRecords.push_back(m_records[index]);
+            }
+
+            m_buffer.upload(stream, m_visibleRecords);
+            drawable.drawInstanced(shaderProgram, m_buffer);
+        }
+
+        /// @brief Get number of instances
+        /// @return Number of instances
+        inline size_t size() const
+        {
+            return m_records.size();
+        }
+    };
+}
+
+} // namespace kc
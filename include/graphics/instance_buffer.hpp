@@ -0,0 +1,66 @@
+#pragma once
+
+// STL modules
+#include <cstddef>
+#include <span>
+
+// Graphics libraries
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Custom modules
+#include "graphics/types/instance_record.hpp"
+#include "graphics/state_cache.hpp"
+#include "graphics/stream_buffer.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace InstanceBufferConst
+    {
+        namespace Attributes
+        {
+            /// @brief First of four model matrix column attributes
+            constexpr unsigned int Model = 3;
+
+            /// @brief Instance color attribute
+            constexpr unsigned int Color = 7;
+        }
+    }
+
+    /// @brief Instance records of one draw, streamed into the current frame region of a stream buffer
+    class InstanceBuffer
+    {
+    private:
+        unsigned int m_buffer;
+        size_t m_offset;
+        size_t m_count;
+
+    public:
+        InstanceBuffer();
+
+        /// @brief Write instance records for this frame
+        /// @param stream Stream buffer to write to
+        /// @param records Records to write
+        /// @throw std::runtime_error if records don't fit in stream frame region
+        void upload(StreamBuffer& stream, std::span<const InstanceRecord> records);
+
+        /// @brief Point per-instance attributes of vertex array at this buffer
+        /// @param vertexArray The vertex array to draw with
+        void attach(unsigned int vertexArray) const;
+
+        /// @brief Disable per-instance attributes of vertex array again, so non-instanced draws sharing it read nothing stale
+        /// @param vertexArray The vertex array drawn with
+        void detach(unsigned int vertexArray) const;
+
+        /// @brief Get number of uploaded instances
+        /// @return Number of uploaded instances
+        inline size_t count() const
+        {
+            return m_count;
+        }
+    };
+}
+
+} // namespace kc
@@ -5,6 +5,8 @@
 
 // Custom modules
 #include "graphics/lighting/light.hpp"
+#include "graphics/types/uniform_blocks.hpp"
+#include "graphics/camera.hpp"
 #include "graphics/cube.hpp"
 #include "graphics/shader_program.hpp"
 
@@ -30,10 +32,22 @@ namespace Graphics
             /// @param properties Light properties
             DirectionalLight(const glm::vec3 direction = glm::vec3(0.0f, -1.0f, 0.0f), Color color = {}, const LightProperties& properties = {});
 
-            /// @brief Draw light to the screen
-            /// @param shaderProgram Shader program to illuminate
-            /// @param lightShaderProgram Separate shader program to render point light
-            void draw(ShaderProgram& shaderProgram, ShaderProgram& lightShaderProgram);
+            /// @brief Write enabled light to lights uniform block in view space
+            /// @param lights Lights uniform block
+            /// @param camera Camera to transform light for
+            void illuminate(UniformBlocks::Lights& lights, const Camera& camera) const;
+
+            /// @brief Draw light body to the screen
+            /// @param lightShaderProgram Separate shader program to render light body
+            /// @param camera Camera to draw for
+            /// @param stream Stream buffer to write object block to
+            void draw(ShaderProgram& lightShaderProgram, const Camera& camera, StreamBuffer& stream);
+
+            /// @brief Submit light body to render queue
+            /// @param queue Render queue to submit to, light must outlive its execution
+            /// @param lightShaderProgram Separate shader program to render light body
+            /// @param camera Camera to draw for
+            void submit(RenderQueue& queue, ShaderProgram& lightShaderProgram, const Camera& camera);
 
             /// @brief Get light direction
             /// @return Light direction
@@ -4,6 +4,10 @@
 #include "graphics/types/color.hpp"
 #include "graphics/types/light_attenuation.hpp"
 #include "graphics/types/light_properties.hpp"
+#include "graphics/camera.hpp"
+#include "graphics/cube.hpp"
+#include "graphics/render_queue.hpp"
+#include "graphics/shader_program.hpp"
 
 namespace kc {
 
@@ -18,6 +22,25 @@ namespace Graphics
             LightAttenuation m_attenuation;
             LightProperties m_properties;
 
+        protected:
+            /// @brief Submit light body drawn in light color
+            /// @param queue Render queue to submit to
+            /// @param body Light body
+            /// @param lightShaderProgram Separate shader program to render light body
+            /// @param camera Camera to draw for
+            inline void submitBody(RenderQueue& queue, const Cube& body, ShaderProgram& lightShaderProgram, const Camera& camera) const
+            {
+                RenderQueue::Packet* packet = body.submit(queue, lightShaderProgram, camera);
+                if (!packet)
+                    return;
+
+                packet->command = [color = m_color, command = std::move(packet->command)](ShaderProgram& shaderProgram)
+                {
+                    shaderProgram.set("LightColor", color);
+                    command(shaderProgram);
+                };
+            }
+
         public:
             /// @brief Create light
             /// @param color Light color
@@ -0,0 +1,186 @@
+#pragma once
+
+// STL modules
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Graphics libraries
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+// Custom modules
+#include "common/job_system.hpp"
+#include "graphics/lighting/point_light.hpp"
+#include "graphics/lighting/spot_light.hpp"
+#include "graphics/types/light_record.hpp"
+#include "graphics/types/uniform_blocks.hpp"
+#include "graphics/camera.hpp"
+#include "graphics/shader_program.hpp"
+#include "graphics/state_cache.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace Lighting
+    {
+        namespace LightClustersConst
+        {
+            namespace Grid
+            {
+                constexpr unsigned int X = 16;
+                constexpr unsigned int Y = 9;
+                constexpr unsigned int Z = 24;
+                constexpr unsigned int Size = X * Y * Z;
+            }
+
+            namespace Units
+            {
+                constexpr unsigned int LightData = 13;
+                constexpr unsigned int ClusterGrid = 14;
+                constexpr unsigned int LightIndices = 15;
+            }
+
+            /// @brief Light influence ends where its intensity drops below this value
+            constexpr float InfluenceThreshold = 1.0f / 256.0f;
+
+            /// @brief Lights count under which culling is not split between jobs
+            constexpr size_t ParallelThreshold = 32;
+        }
+
+        class LightClusters
+        {
+        private:
+            struct Bounds
+            {
+                glm::vec3 min;
+                glm::vec3 max;
+            };
+
+            struct Range
+            {
+                unsigned int x[2];
+                unsigned int y[2];
+                unsigned int z[2];
+            };
+
+            struct Buffer
+            {
+                unsigned int buffer;
+                unsigned int texture;
+            };
+
+        private:
+            /// @brief Calculate distance at which light intensity drops below influence threshold
+            /// @param record Light record
+            /// @return Influence radius
+            static float InfluenceRadius(const LightRecord& record);
+
+            /// @brief Create texture buffer
+            /// @param format Texel format (GL_RGBA32F, GL_R32UI, etc)
+            /// @return Created buffer
+            static Buffer CreateBuffer(int format);
+
+            /// @brief Upload texture buffer contents, orphaning previous storage
+            /// @param buffer The buffer to upload to
+            /// @param data Data to upload
+            /// @param size Data size in bytes
+            static void UploadBuffer(const Buffer& buffer, const void* data, size_t size);
+
+        private:
+            Buffer m_lightData;
+            Buffer m_clusterGrid;
+            Buffer m_lightIndices;
+            std::vector<LightRecord> m_lights;
+            std::vector<Bounds> m_clusterBounds;
+            std::vector<glm::uvec2> m_grid;
+            std::vector<uint32_t> m_indices;
+            std::vector<std::vector<uint32_t>> m_sliceIndices;
+            glm::mat4 m_boundsProjection;
+            unsigned int m_boundsWidth;
+            unsigned int m_boundsHeight;
+            glm::vec4 m_scale;
+
+        private:
+            /// @brief Free allocated resources
+            void free();
+
+            /// @brief Recalculate view space cluster bounds if projection has changed
+            /// @param camera Camera to calculate bounds for
+            /// @param width Framebuffer width
+            /// @param height Framebuffer height
+            void updateBounds(const Camera& camera, unsigned int width, unsigned int height);
+
+            /// @brief Calculate clusters a light may touch
+            /// @param record Light record
+            /// @param camera Camera to calculate range for
+            /// @param range Calculated range
+            /// @return False if light touches no clusters
+            bool lightRange(const LightRecord& record, const Camera& camera, Range& range) const;
+
+            /// @brief Assign lights to clusters of depth slices
+            /// @param ranges Light cluster ranges
+            /// @param firstSlice First depth slice to process
+            /// @param lastSlice Depth slice after last one to process
+            /// @param indices Light indices to append to, grid offsets are relative to it
+            void assign(const std::vector<Range>& ranges, unsigned int firstSlice, unsigned int lastSlice, std::vector<uint32_t>& indices);
+
+        public:
+            LightClusters();
+
+            LightClusters(const LightClusters& other) = delete;
+
+            ~LightClusters();
+
+            /// @brief Create texture buffers
+            void create();
+
+            /// @brief Remove all lights
+            void clear();
+
+            /// @brief Add point light for current frame
+            /// @param light The light to add
+            /// @param camera Camera to transform light for
+            void add(const PointLight& light, const Camera& camera);
+
+            /// @brief Add spot light for current frame
+            /// @param light The light to add
+            /// @param camera Camera to transform light for
+            void add(const SpotLight& light, const Camera& camera);
+
+            /// @brief Assign added lights to clusters and upload them
+            /// @param camera Camera to cluster for
+            /// @param width Framebuffer width
+            /// @param height Framebuffer height
+            /// @param jobs Job system to split depth slices between, nullptr to build on calling thread
+            void build(const Camera& camera, unsigned int width, unsigned int height, JobSystem* jobs = nullptr);
+
+            /// @brief Write cluster parameters to lights uniform block
+            /// @param lights Lights uniform block
+            void illuminate(UniformBlocks::Lights& lights) const;
+
+            /// @brief Bind light texture buffers to shader program
+            /// @param shaderProgram Shader program to bind to
+            void bind(ShaderProgram& shaderProgram) const;
+
+            /// @brief Get number of lights added for current frame
+            /// @return Number of lights
+            inline size_t lightCount() const
+            {
+                return m_lights.size();
+            }
+
+            /// @brief Get number of light-to-cluster assignments of last build
+            /// @return Number of assignments
+            inline size_t assignmentCount() const
+            {
+                return m_indices.size();
+            }
+        };
+    }
+}
+
+} // namespace kc
@@ -2,6 +2,9 @@
 
 // Custom modules
 #include "graphics/lighting/light.hpp"
+#include "graphics/types/light_record.hpp"
+#include "graphics/types/uniform_blocks.hpp"
+#include "graphics/camera.hpp"
 #include "graphics/cube.hpp"
 #include "graphics/shader_program.hpp"
 
@@ -24,10 +27,22 @@ namespace kc {
                 /// @param properties Light properties
                 PointLight(const Transform& transform = {}, Color color = {}, const LightAttenuation attenuation = {}, const LightProperties & properties = {});
 
-                /// @brief Draw light to the screen
-                /// @param shaderProgram Shader program to illuminate
-                /// @param lightShaderProgram Separate shader program to render point light
-                void draw(ShaderProgram& shaderProgram, ShaderProgram& lightShaderProgram);
+                /// @brief Write light to light record in view space
+                /// @param record Light record to write to
+                /// @param camera Camera to transform light for
+                void illuminate(LightRecord& record, const Camera& camera) const;
+
+                /// @brief Draw light body to the screen
+                /// @param lightShaderProgram Separate shader program to render light body
+                /// @param camera Camera to draw for
+                /// @param stream Stream buffer to write object block to
+                void draw(ShaderProgram& lightShaderProgram, const Camera& camera, StreamBuffer& stream);
+
+                /// @brief Submit light body to render queue
+                /// @param queue Render queue to submit to, light must outlive its execution
+                /// @param lightShaderProgram Separate shader program to render light body
+                /// @param camera Camera to draw for
+                void submit(RenderQueue& queue, ShaderProgram& lightShaderProgram, const Camera& camera);
 
                 /// @brief Get light transform
                 /// @return Light transform
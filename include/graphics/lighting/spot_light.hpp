@@ -6,6 +6,9 @@
 // Custom modules
 #include "graphics/lighting/light.hpp"
 #include "graphics/types/light_cutoff.hpp"
+#include "graphics/types/light_record.hpp"
+#include "graphics/types/uniform_blocks.hpp"
+#include "graphics/camera.hpp"
 #include "graphics/cube.hpp"
 #include "graphics/shader_program.hpp"
 
@@ -35,10 +38,22 @@ namespace Graphics
             /// @param cutoff Light cutoff
             SpotLight(const Transform& transform = {}, const glm::vec3 direction = glm::vec3(0.0f, -1.0f, 0.0f), Color color = {}, const LightAttenuation attenuation = {}, const LightProperties& properties = {}, const LightCutoff& cutoff = {});
 
-            /// @brief Draw light to the screen
-            /// @param shaderProgram Shader program to illuminate
-            /// @param lightShaderProgram Separate shader program to render point light
-            void draw(ShaderProgram& shaderProgram, ShaderProgram& lightShaderProgram) const;
+            /// @brief Write light to light record in view space
+            /// @param record Light record to write to
+            /// @param camera Camera to transform light for
+            void illuminate(LightRecord& record, const Camera& camera) const;
+
+            /// @brief Draw light body to the screen
+            /// @param lightShaderProgram Separate shader program to render light body
+            /// @param camera Camera to draw for
+            /// @param stream Stream buffer to write object block to
+            void draw(ShaderProgram& lightShaderProgram, const Camera& camera, StreamBuffer& stream) const;
+
+            /// @brief Submit light body to render queue
+            /// @param queue Render queue to submit to, light must outlive its execution
+            /// @param lightShaderProgram Separate shader program to render light body
+            /// @param camera Camera to draw for
+            void submit(RenderQueue& queue, ShaderProgram& lightShaderProgram, const Camera& camera) const;
 
             /// @brief Get light transform
                 /// @return Light transform
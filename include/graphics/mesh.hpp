@@ -2,14 +2,22 @@
 
 // STL modules
 #include <vector>
+#include <span>
+#include <limits>
 #include <functional>
+#include <algorithm>
+#include <stdexcept>
 
 // Graphics libraries
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
 // Custom modules
+#include "graphics/types/bounding_sphere.hpp"
+#include "graphics/types/vertex.hpp"
+#include "graphics/geometry_arena.hpp"
 #include "graphics/shader_program.hpp"
+#include "graphics/state_cache.hpp"
 #include "graphics/texture.hpp"
 
 namespace kc {
@@ -19,15 +27,17 @@ namespace Graphics
     class Mesh
     {
     public:
-        struct Vertex
+        using Vertex = Graphics::Vertex;
+        using Indice = Graphics::Indice;
+
+        /// @brief What CPU side geometry is kept after upload
+        enum class Residency
         {
-            glm::vec3 position;
-            glm::vec3 normal;
-            glm::vec2 texCoords;
+            Keep,       // full vertices and indices
+            Discard,    // nothing but index count and bounds
+            Compact,    // positions and indices, enough for picking and collision
         };
 
-        using Indice = unsigned int;
-
     private:
         struct Objects
         {
@@ -41,11 +51,17 @@ namespace Graphics
         /// @param vertices Mesh vertices
         /// @param indices Mesh indices
         /// @return Created objects
-        static Objects CreateMesh(const std::vector<Vertex>& vertices, const std::vector<Indice>& indices);
+        static Objects CreateMesh(std::span<const Vertex> vertices, std::span<const Indice> indices);
 
     private:
         Objects m_objects;
+        GeometryArena* m_arena;
+        GeometryArena::Range m_range;
+        std::vector<GeometryArena::Range> m_lods;
+        glm::vec3 m_minimum;
+        glm::vec3 m_maximum;
         std::vector<Vertex> m_vertices;
+        std::vector<glm::vec3> m_positions;
         std::vector<Indice> m_indices;
         std::vector<Texture::Pointer> m_textures;
 
@@ -53,6 +69,19 @@ namespace Graphics
         /// @brief Free allocated resources
         void free();
 
+        /// @brief Keep CPU copies of uploaded geometry according to residency policy
+        /// @param vertices Uploaded vertices
+        /// @param indices Uploaded indices
+        /// @param residency Residency policy
+        void retain(std::span<const Vertex> vertices, std::span<const Indice> indices, Residency residency);
+
+        /// @brief Get vertex array the mesh is drawn from
+        /// @return Own vertex array or the arena one
+        inline unsigned int vertexArray() const
+        {
+            return m_arena ? m_arena->vertexArray() : m_objects.vertexArray;
+        }
+
     public:
         Mesh();
 
@@ -65,10 +94,37 @@ namespace Graphics
         /// @brief Create mesh
         void create();
 
+        /// @brief Create mesh from external geometry
+        /// @param vertices Mesh vertices
+        /// @param indices Mesh indices
+        /// @param residency What CPU side geometry to keep
+        void create(std::span<const Vertex> vertices, std::span<const Indice> indices, Residency residency = Residency::Discard);
+
+        /// @brief Create mesh inside shared geometry arena
+        /// @param arena The arena to upload to, must outlive the mesh
+        /// @param vertices Mesh vertices
+        /// @param indices Mesh indices
+        /// @param residency What CPU side geometry to keep
+        void create(GeometryArena& arena, std::span<const Vertex> vertices, std::span<const Indice> indices, Residency residency = Residency::Discard);
+
+        /// @brief Add coarser detail level sharing mesh vertices, levels go from finest to coarsest
+        /// @param indices Detail level indices
+        /// @throw std::runtime_error if mesh wasn't created inside geometry arena
+        void addLod(std::span<const Indice> indices);
+
+        /// @brief Bind mesh textures to material samplers
+        /// @param shaderProgram Shader program to draw with
+        void bindTextures(ShaderProgram& shaderProgram) const;
+
         /// @brief Draw mesh to the screen
         /// @param shaderProgram Shader program to draw with
         void draw(ShaderProgram& shaderProgram) const;
 
+        /// @brief Draw mesh instances to the screen, instance attributes must already be attached to its vertex array
+        /// @param shaderProgram Instanced shader program to draw with
+        /// @param count Number of instances
+        void drawInstanced(ShaderProgram& shaderProgram, size_t count) const;
+
         /// @brief Get mesh vertices
         /// @return Mesh vertices
         inline std::vector<Vertex>& vertices()
@@ -76,6 +132,13 @@ namespace Graphics
             return m_vertices;
         }
 
+        /// @brief Get mesh vertex positions, only kept with compact residency
+        /// @return Mesh vertex positions
+        inline const std::vector<glm::vec3>& positions() const
+        {
+            return m_positions;
+        }
+
         /// @brief Get mesh indices
         /// @return Mesh indices
         inline std::vector<Indice>& indices()
@@ -83,12 +146,83 @@ namespace Graphics
             return m_indices;
         }
 
+        /// @brief Get number of uploaded indices
+        /// @return Number of uploaded indices, known whatever the residency is
+        inline size_t indexCount() const
+        {
+            return m_range.indexCount;
+        }
+
+        /// @brief Get mesh bounding box minimum corner
+        /// @return Bounding box minimum corner in mesh space
+        inline const glm::vec3& minimum() const
+        {
+            return m_minimum;
+        }
+
+        /// @brief Get mesh bounding box maximum corner
+        /// @return Bounding box maximum corner in mesh space
+        inline const glm::vec3& maximum() const
+        {
+            return m_maximum;
+        }
+
+        /// @brief Get sphere enclosing mesh bounding box
+        /// @return Bounding sphere in mesh space
+        inline BoundingSphere boundingSphere() const
+        {
+            return BoundingSphere::FromBox(m_minimum, m_maximum);
+        }
+
+        /// @brief Get memory used by CPU side geometry copies
+        /// @return Used bytes
+        inline size_t memory() const
+        {
+            return m_vertices.capacity() * sizeof(Vertex) + m_positions.capacity() * sizeof(glm::vec3) + m_indices.capacity() * sizeof(Indice);
+        }
+
         /// @brief Get mesh textures
         /// @return Mesh textures
         inline std::vector<Texture::Pointer>& textures()
         {
             return m_textures;
         }
+
+        /// @brief Get mesh textures
+        /// @return Mesh textures
+        inline const std::vector<Texture::Pointer>& textures() const
+        {
+            return m_textures;
+        }
+
+        /// @brief Get mesh geometry arena
+        /// @return Geometry arena or nullptr if mesh owns its buffers
+        inline const GeometryArena* arena() const
+        {
+            return m_arena;
+        }
+
+        /// @brief Get mesh range inside its vertex and element buffers
+        /// @return Mesh range
+        inline const GeometryArena::Range& range() const
+        {
+            return m_range;
+        }
+
+        /// @brief Get mesh detail level range
+        /// @param level Detail level, clamped to the coarsest one
+        /// @return Detail level range
+        inline const GeometryArena::Range& range(size_t level) const
+        {
+            return level == 0 || m_lods.empty() ? m_range : m_lods[std::min(level, m_lods.size()) - 1];
+        }
+
+        /// @brief Get number of detail levels
+        /// @return Number of detail levels including the original one
+        inline size_t lodCount() const
+        {
+            return m_lods.size() + 1;
+        }
     };
 }
 
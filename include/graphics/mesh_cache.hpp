@@ -0,0 +1,162 @@
+#pragma once
+
+// STL modules
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <span>
+#include <fstream>
+#include <filesystem>
+#include <stdexcept>
+
+// Library {fmt}
+#include <fmt/format.h>
+
+// Custom modules
+#include "common/mapped_file.hpp"
+#include "graphics/mesh.hpp"
+#include "graphics/texture.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace MeshCacheConst
+    {
+        /// @brief Cache file extension appended to model file path
+        constexpr const char* Extension = ".meshcache";
+
+        /// @brief File magic
+        constexpr char Magic[8] = { 'K', 'C', 'M', 'E', 'S', 'H', '\0', '\0' };
+
+        /// @brief Format version, increment on any layout or import pipeline change
+        constexpr uint32_t Version = 4;
+
+        /// @brief Alignment of every blob in cache file
+        constexpr size_t Alignment = 16;
+    }
+
+    class MeshCache
+    {
+    public:
+        struct TextureReference
+        {
+            Texture::Type type;
+            std::string filename;
+        };
+
+        struct Entry
+        {
+            std::span<const Mesh::Vertex> vertices;
+            std::span<const Mesh::Indice> indices;
+            std::vector<std::span<const Mesh::Indice>> lods;    // coarser detail levels sharing vertices
+            std::vector<TextureReference> textures;
+        };
+
+    private:
+        struct SourceStamp
+        {
+            uint64_t size;
+            int64_t time;
+            uint64_t hash;
+        };
+
+        struct Header
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t meshCount;
+            SourceStamp source;
+            uint32_t textureCount;
+            uint32_t vertexSize;
+            uint32_t lodCount;
+        };
+
+        struct MeshRecord
+        {
+            uint64_t vertexOffset;
+            uint64_t indexOffset;
+            uint32_t vertexCount;
+            uint32_t indexCount;
+            uint32_t firstTexture;
+            uint32_t textureCount;
+            uint32_t firstLod;
+            uint32_t lodCount;
+        };
+
+        struct LodRecord
+        {
+            uint64_t indexOffset;
+            uint32_t indexCount;
+            uint32_t padding;
+        };
+
+        struct TextureRecord
+        {
+            uint64_t filenameOffset;
+            uint32_t filenameLength;
+            uint32_t type;
+        };
+
+    private:
+        /// @brief Hash data with 64-bit FNV-1a
+        /// @param data Data to hash
+        /// @param size Data size
+        /// @return Data hash
+        static uint64_t Hash(const uint8_t* data, size_t size);
+
+        /// @brief Hash file contents
+        /// @param filePath Path to the file
+        /// @throw std::runtime_error if file couldn't be mapped
+        /// @return File contents hash
+        static uint64_t HashFile(const std::string& filePath);
+
+        /// @brief Get source file size and modification time
+        /// @param sourceFilePath Path to source file
+        /// @throw std::runtime_error if source file doesn't exist
+        /// @return Source stamp without hash
+        static SourceStamp Stamp(const std::string& sourceFilePath);
+
+    private:
+        MappedFile m_file;
+        std::vector<Entry> m_entries;
+
+    private:
+        /// @brief Get typed pointer into mapped file
+        /// @param offset Offset in mapped file
+        /// @param count Number of elements
+        /// @throw std::runtime_error if range is out of file bounds
+        /// @return Typed pointer
+        template <typename Type>
+        const Type* at(uint64_t offset, uint64_t count) const
+        {
+            if (offset % alignof(Type) || offset > m_file.size() || count > (m_file.size() - offset) / sizeof(Type))
+                throw std::runtime_error("kc::Graphics::MeshCache::at(): Cache file is truncated");
+            return reinterpret_cast<const Type*>(m_file.data() + offset);
+        }
+
+    public:
+        /// @brief Write mesh cache file
+        /// @param cacheFilePath Path to cache file
+        /// @param sourceFilePath Path to model source file the cache is made of
+        /// @param entries Meshes to write
+        /// @throw std::runtime_error if cache file couldn't be written
+        static void Write(const std::string& cacheFilePath, const std::string& sourceFilePath, const std::vector<Entry>& entries);
+
+        /// @brief Map mesh cache file
+        /// @param cacheFilePath Path to cache file
+        /// @param sourceFilePath Path to model source file the cache must be made of
+        /// @throw std::runtime_error if cache file is missing, corrupt, of other version or stale
+        MeshCache(const std::string& cacheFilePath, const std::string& sourceFilePath);
+
+        /// @brief Get cached meshes
+        /// @return Cached meshes, valid while cache is alive
+        inline const std::vector<Entry>& entries() const
+        {
+            return m_entries;
+        }
+    };
+}
+
+} // namespace kc
@@ -0,0 +1,125 @@
+#pragma once
+
+// STL modules
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cmath>
+#include <vector>
+#include <span>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+#include <unordered_map>
+
+// Graphics libraries
+#include <glm/glm.hpp>
+
+// Custom modules
+#include "graphics/types/vertex.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace MeshOptimizerConst
+    {
+        /// @brief Size of vertex cache modelled when ordering triangles
+        constexpr size_t CacheSize = 32;
+
+        /// @brief Size of FIFO cache simulated when measuring ACMR, close to what GPUs behave like
+        constexpr size_t SimulatedCacheSize = 16;
+
+        namespace Score
+        {
+            /// @brief Score of vertices used by the last emitted triangle
+            constexpr float LastTriangle = 0.75f;
+
+            /// @brief How fast cache position score decays
+            constexpr float CacheDecayPower = 1.5f;
+
+            /// @brief Bonus for vertices with few triangles left, so no lonely triangles are left behind
+            constexpr float ValenceBoostScale = 2.0f;
+
+            /// @brief How fast valence bonus decays
+            constexpr float ValenceBoostPower = 0.5f;
+        }
+
+        namespace Lod
+        {
+            /// @brief Maximum number of detail levels including the original one
+            constexpr size_t Count = 4;
+
+            /// @brief Target triangle count of each level relative to the previous one
+            constexpr float Reduction = 0.5f;
+
+            /// @brief Levels that save less than this are not worth their memory and end generation
+            constexpr float MinimumReduction = 0.8f;
+
+            /// @brief Largest allowed simplification error relative to mesh bounding box diagonal
+            constexpr float MaximumError = 0.05f;
+        }
+    }
+
+    /// @brief Import time mesh optimizations, none of them touch OpenGL
+    namespace MeshOptimizer
+    {
+        struct Statistics
+        {
+            size_t verticesBefore = 0;
+            size_t verticesAfter = 0;
+            float acmrBefore = 0.0f;
+            float acmrAfter = 0.0f;
+        };
+
+        /// @brief Merge bitwise identical vertices
+        /// @param vertices Mesh vertices, unique ones are kept in order of first use
+        /// @param indices Mesh indices, remapped to welded vertices
+        void Weld(std::vector<Vertex>& vertices, std::vector<Indice>& indices);
+
+        /// @brief Reorder triangles for post-transform vertex cache locality (Forsyth)
+        /// @param indices Triangle list indices to reorder
+        /// @param vertexCount Number of mesh vertices
+        void OptimizeVertexCache(std::vector<Indice>& indices, size_t vertexCount);
+
+        /// @brief Reorder cache optimized triangle clusters so outer, outward facing ones are drawn first (Tipsify)
+        /// @param vertices Mesh vertices
+        /// @param indices Cache optimized triangle list indices to reorder
+        void OptimizeOverdraw(std::span<const Vertex> vertices, std::vector<Indice>& indices);
+
+        /// @brief Reorder vertices in order of first use for vertex fetch locality
+        /// @param vertices Mesh vertices, unreferenced ones are dropped
+        /// @param indices Mesh indices, remapped to reordered vertices
+        void OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<Indice>& indices);
+
+        /// @brief Calculate average cache miss ratio of simulated FIFO vertex cache
+        /// @param indices Triangle list indices
+        /// @param vertexCount Number of mesh vertices
+        /// @param cacheSize Simulated cache size
+        /// @return Transformed vertices per triangle, 0.5 is ideal for regular grids, 3 is the worst
+        float Acmr(std::span<const Indice> indices, size_t vertexCount, size_t cacheSize = MeshOptimizerConst::SimulatedCacheSize);
+
+        /// @brief Simplify mesh by quadric error metric edge collapses onto existing vertices
+        /// @param vertices Mesh vertices, shared by simplified indices
+        /// @param indices Triangle list indices
+        /// @param targetIndexCount Number of indices to stop at
+        /// @param targetError Largest allowed error relative to mesh bounding box diagonal
+        /// @note Borders and attribute seams are kept in place
+        /// @return Simplified indices, may have more than target count if error limit is reached first
+        std::vector<Indice> Simplify(std::span<const Vertex> vertices, std::span<const Indice> indices, size_t targetIndexCount, float targetError);
+
+        /// @brief Generate coarser detail levels of mesh
+        /// @param vertices Mesh vertices, shared by every level
+        /// @param indices Triangle list indices of the original level
+        /// @return Cache optimized indices of each coarser level, from finest to coarsest
+        std::vector<std::vector<Indice>> GenerateLods(std::span<const Vertex> vertices, std::span<const Indice> indices);
+
+        /// @brief Run every optimization stage on mesh
+        /// @param vertices Mesh vertices
+        /// @param indices Triangle list indices
+        /// @return Vertex counts and ACMR before and after optimization
+        Statistics Optimize(std::vector<Vertex>& vertices, std::vector<Indice>& indices);
+    }
+}
+
+} // namespace kc
@@ -3,65 +3,255 @@
 // STL modules
 #include <string>
 #include <vector>
+#include <memory>
+#include <limits>
 #include <unordered_map>
+#include <optional>
+#include <algorithm>
+#include <atomic>
+#include <exception>
 #include <stdexcept>
+#include <cmath>
 
 // Library ASSIMP
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
 
+// Graphics libraries
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
 // Custom modules
+#include "common/job_system.hpp"
+#include "common/utility.hpp"
+#include "graphics/types/bounding_box.hpp"
 #include "graphics/types/transform.hpp"
+#include "graphics/camera.hpp"
+#include "graphics/cube.hpp"
+#include "graphics/geometry_arena.hpp"
 #include "graphics/mesh.hpp"
+#include "graphics/mesh_cache.hpp"
+#include "graphics/mesh_optimizer.hpp"
+#include "graphics/render_queue.hpp"
 #include "graphics/shader_program.hpp"
+#include "graphics/texture_cache.hpp"
 
 namespace kc {
 
 namespace Graphics
 {
+    namespace ModelConst
+    {
+        namespace Lod
+        {
+            /// @brief Meshes covering at least this part of screen height are drawn at full detail, every halving drops one level
+            constexpr float FullDetailScreenSize = 0.5f;
+        }
+    }
+
     class Model
     {
-    private:
-        /* Model specific */
-        std::string m_directory;
-        std::vector<Mesh> m_meshes;
-        std::unordered_map<std::string, Texture::Pointer> m_textures;
+    public:
+        using Textures = std::unordered_map<std::string, Texture::Pointer>;
 
-        /* Variables */
-        Transform m_transform;
+        /// @brief CPU side model data, may be read on any thread
+        struct Geometry
+        {
+            std::string directory;
+            std::unique_ptr<MeshCache> cache;
+            std::vector<std::vector<Mesh::Vertex>> vertices;
+            std::vector<std::vector<Mesh::Indice>> indices;
+            std::vector<std::vector<std::vector<Mesh::Indice>>> lods;
+            std::vector<MeshCache::Entry> entries;
+            glm::vec3 minimum;
+            glm::vec3 maximum;
+        };
+
+    private:
+        /// @brief Meshes sharing the same textures, drawn with one call
+        struct MaterialBatch
+        {
+            std::vector<size_t> meshes;
+            unsigned int indexType;
+            unsigned int material;      // render queue id of the texture set
+        };
 
     private:
         /// @brief Process model node
         /// @param scene Model scene
         /// @param node The node to process
-        void processNode(const aiScene* scene, aiNode* node);
+        /// @param geometry Geometry to fill
+        /// @param parent Accumulated transform of parent nodes
+        static void ProcessNode(const aiScene* scene, aiNode* node, Geometry& geometry, const glm::mat4& parent);
 
-        /// @brief Create model mesh
+        /// @brief Read model mesh
         /// @param scene Model scene
-        /// @param mesh The mesh to create
-        void createMesh(const aiScene* scene, aiMesh* mesh);
+        /// @param mesh The mesh to read
+        /// @param geometry Geometry to fill
+        /// @param transform Accumulated transform of mesh node
+        static void ReadMesh(const aiScene* scene, aiMesh* mesh, Geometry& geometry, const glm::mat4& transform);
 
-        /// @brief Load mesh textures
-        /// @param textures Mesh textures
+        /// @brief Collect mesh textures
+        /// @param references Mesh texture references to fill
         /// @param material Mesh material
         /// @param type Textures type
-        void loadTextures(std::vector<Texture::Pointer>& textures, aiMaterial* material, aiTextureType type);
+        static void CollectTextures(std::vector<MeshCache::TextureReference>& references, aiMaterial* material, aiTextureType type);
+
+        /// @brief Read texture images concurrently on job system
+        /// @param imageFilePaths Paths to image files
+        /// @param verticalFlip Whether to flip images vertically or not
+        /// @param jobs Job system to decode images in parallel on, serial if null
+        /// @throw std::runtime_error if any image couldn't be opened
+        /// @return Read images in order of paths
+        static std::vector<Texture::Source> DecodeImages(const std::vector<std::string>& imageFilePaths, bool verticalFlip, JobSystem* jobs = nullptr);
+
+    public:
+        /// @brief Read model geometry from mesh cache if it is up to date, import it with ASSIMP and write mesh cache otherwise
+        /// @param modelFilePath Path to model file
+        /// @param logger Logger to report cache usage to
+        /// @throw std::runtime_error if model couldn't be loaded
+        /// @return Read geometry, doesn't touch OpenGL
+        static Geometry ReadGeometry(const std::string& modelFilePath, spdlog::logger& logger);
+
+        /// @brief Get every texture referenced by geometry once
+        /// @param geometry Model geometry
+        /// @return Unique texture references, the first reference decides texture type
+        static std::vector<MeshCache::TextureReference> UniqueTextures(const Geometry& geometry);
+
+    private:
+        spdlog::logger m_logger;
+
+        /* Model specific */
+        std::string m_directory;
+        GeometryArena m_arena;
+        std::vector<Mesh> m_meshes;
+        std::vector<MaterialBatch> m_batches;
+        glm::vec3 m_minimum;
+        glm::vec3 m_maximum;
+        size_t m_createdMeshes;
+        std::atomic<bool> m_bounded;    // published for other threads reading bounds and readiness
+        std::atomic<bool> m_ready;
+        Mesh::Residency m_residency;
+        VertexFormat m_vertexFormat;
+        Textures m_textures;
+        std::optional<Cube> m_placeholder;
+
+        /* Variables */
+        Transform m_transform;
+
+    private:
+        /// @brief Group created meshes by textures, so each group is drawn with one call
+        void buildBatches();
+
+        /// @brief Log geometry memory used by created meshes
+        void reportMemory();
+
+        /// @brief Pick mesh detail level by its projected size
+        /// @param mesh The mesh to pick level for
+        /// @param modelView Model-view matrix of the mesh
+        /// @param camera Camera to draw for
+        /// @return Detail level
+        static size_t SelectLod(const Mesh& mesh, const glm::mat4& modelView, const Camera& camera);
 
     public:
-        Model() = default;
+        Model();
 
         Model(Model&& other) = delete;
 
         Model(const Model& other) = delete;
 
-        /// @brief Load model
+        /// @brief Load model synchronously
         /// @param modelFilePath Path to model file
-        void load(const std::string& modelFilePath);
+        /// @param jobs Job system to decode texture images in parallel on, serial if null
+        /// @throw std::runtime_error if model couldn't be loaded
+        void load(const std::string& modelFilePath, JobSystem* jobs = nullptr);
+
+        /// @brief Prepare model for meshes to be created one by one into its geometry arena, bounding box is drawn until then
+        /// @param geometry Model geometry
+        void prepare(const Geometry& geometry);
 
-        /// @brief Draw model to the screen
+        /// @brief Create prepared model mesh
+        /// @param index Mesh index
+        /// @param entry Mesh geometry
+        void createMesh(size_t index, const MeshCache::Entry& entry);
+
+        /// @brief Attach textures to prepared meshes
+        /// @param geometry Model geometry
+        /// @param textures Textures by filename, must contain every referenced texture
+        void attachTextures(const Geometry& geometry, Textures&& textures);
+
+        /// @brief Submit draws of visible meshes to render queue, one packet per material
+        /// @param queue Render queue to submit to, model must outlive its execution
         /// @param shaderProgram Shader program to draw with
-        void draw(ShaderProgram& shaderProgram) const;
+        /// @param camera Camera to draw for
+        /// @param parent Parent transform applied after model transform
+        /// @param condition Occlusion query to render on, 0 for none
+        void submit(RenderQueue& queue, ShaderProgram& shaderProgram, const Camera& camera, const glm::mat4& parent = glm::mat4(1.0f), unsigned int condition = 0) const;
+
+        /// @brief Draw model instances to the screen, nothing is drawn until model is ready.
+        /// Instance matrices replace model transform, the same way they do for cubes.
+        /// @param shaderProgram Instanced shader program to draw with
+        /// @param instances Uploaded instances
+        void drawInstanced(ShaderProgram& shaderProgram, const InstanceBuffer& instances) const;
+
+        /// @brief Set what CPU side geometry meshes keep after upload, applies to meshes created afterwards
+        /// @param residency Residency policy
+        inline void setResidency(Mesh::Residency residency)
+        {
+            m_residency = residency;
+        }
+
+        /// @brief Set GPU vertex layout, applies to the next prepare() call
+        /// @param format Vertex format
+        inline void setVertexFormat(VertexFormat format)
+        {
+            m_vertexFormat = format;
+        }
+
+        /// @brief Get GPU vertex layout
+        /// @return Vertex format
+        inline VertexFormat vertexFormat() const
+        {
+            return m_vertexFormat;
+        }
+
+        /// @brief Get mesh residency policy
+        /// @return Residency policy
+        inline Mesh::Residency residency() const
+        {
+            return m_residency;
+        }
+
+        /// @brief Get model meshes
+        /// @return Model meshes
+        inline const std::vector<Mesh>& meshes() const
+        {
+            return m_meshes;
+        }
+
+        /// @brief Get sphere enclosing model bounding box, model transform not applied
+        /// @return Bounding sphere in model space
+        inline BoundingSphere boundingSphere() const
+        {
+            return BoundingSphere::FromBox(m_minimum, m_maximum);
+        }
+
+        /// @brief Get model bounding box, model transform not applied
+        /// @return Bounding box in model space, empty box at the origin until model is prepared
+        inline BoundingBox boundingBox() const
+        {
+            if (!m_bounded.load(std::memory_order_acquire))
+                return { glm::vec3(0.0f), glm::vec3(0.0f) };
+            return { m_minimum, m_maximum };
+        }
+
+        /// @brief Check if every model mesh is created, safe to call from any thread
+        /// @return True if model is ready to be drawn
+        inline bool ready() const
+        {
+            return m_ready.load(std::memory_order_acquire);
+        }
 
         /// @brief Get model transform
         /// @return Model transform
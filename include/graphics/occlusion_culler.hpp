@@ -0,0 +1,115 @@
+#pragma once
+
+// STL modules
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <optional>
+
+// Graphics libraries
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+// Custom modules
+#include "graphics/types/bounding_box.hpp"
+#include "graphics/camera.hpp"
+#include "graphics/cube.hpp"
+#include "graphics/shader_program.hpp"
+#include "graphics/state_cache.hpp"
+#include "graphics/stream_buffer.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace OcclusionCullerConst
+    {
+        /// @brief Boxes are grown by this much before checking if camera is inside, so near plane never clips them
+        constexpr float Margin = CameraConst::Perspective::Near * 2.0f;
+    }
+
+    /// @brief Skips objects whose bounding boxes were hidden last frame, never waiting for query results
+    class OcclusionCuller
+    {
+    public:
+        struct Statistics
+        {
+            size_t tested = 0;      // objects drawn under conditional render
+            size_t occluded = 0;    // of them, hidden by the last known result
+        };
+
+    private:
+        struct Test
+        {
+            uint32_t object;
+            BoundingBox box;
+        };
+
+    private:
+        std::vector<unsigned int> m_queries;
+        std::vector<uint32_t> m_issued;     // frame query was last issued in, 0 if never
+        std::vector<uint8_t> m_pending;     // result hasn't been read yet
+        std::vector<uint8_t> m_visible;     // last read result
+        std::vector<Test> m_tests;
+        std::optional<Cube> m_box;
+        Statistics m_statistics;
+        uint32_t m_frame;
+        bool m_enabled;
+
+    private:
+        /// @brief Free allocated resources
+        void free();
+
+    public:
+        OcclusionCuller();
+
+        OcclusionCuller(OcclusionCuller&& other) noexcept;
+
+        OcclusionCuller(const OcclusionCuller& other) = delete;
+
+        ~OcclusionCuller();
+
+        /// @brief Create occlusion culler
+        void create();
+
+        /// @brief Start frame, reading finished results without waiting for the rest
+        /// @param objects Number of objects that may be drawn
+        void begin(size_t objects);
+
+        /// @brief Get query to draw object on, GPU skips object if its box was hidden last frame
+        /// @param object The object
+        /// @param box Object world space box
+        /// @param camera Camera to draw for
+        /// @return Query for conditional render, 0 if object must be drawn unconditionally
+        unsigned int condition(uint32_t object, const BoundingBox& box, const Camera& camera);
+
+        /// @brief Query visibility of boxes of objects drawn this frame, must be called after every object is drawn
+        /// @param shaderProgram Shader program to draw boxes with, only its positions matter
+        /// @param camera Camera to draw for
+        /// @param stream Stream buffer to write box object blocks to
+        void test(ShaderProgram& shaderProgram, const Camera& camera, StreamBuffer& stream);
+
+        /// @brief Enable or disable occlusion culling
+        inline void toggle()
+        {
+            m_enabled = !m_enabled;
+        }
+
+        /// @brief Check if occlusion culling is enabled
+        /// @return True if enabled
+        inline bool enabled() const
+        {
+            return m_enabled;
+        }
+
+        /// @brief Get counts of the current frame
+        /// @return Occlusion statistics
+        inline const Statistics& statistics() const
+        {
+            return m_statistics;
+        }
+    };
+}
+
+} // namespace kc
@@ -0,0 +1,227 @@
+#pragma once
+
+// STL modules
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+// Library {fmt}
+#include <fmt/format.h>
+
+// Graphics libraries
+#include <GL/glew.h>
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace ProfilerConst
+    {
+        /// @brief Frames GPU timestamps are read back after, queries of a frame are reused only then
+        constexpr size_t Latency = 4;
+
+        /// @brief Samples every scope keeps for percentiles
+        constexpr size_t History = 240;
+
+        /// @brief Trace events a single capture keeps, later events are dropped
+        constexpr size_t MaximumTraceEvents = 1 << 20;
+    }
+
+    /// @brief Frame profiler of named nested scopes, measures CPU time and GPU time of commands issued inside scope.
+    /// Scopes must be opened and closed on the thread that owns OpenGL context.
+    class Profiler
+    {
+    public:
+        /// @brief Opens scope for its lifetime
+        class Scope
+        {
+        private:
+            Profiler& m_profiler;
+
+        public:
+            /// @brief Open scope
+            /// @param profiler Profiler to record to
+            /// @param name Scope name
+            inline Scope(Profiler& profiler, std::string_view name)
+                : m_profiler(profiler)
+            {
+                m_profiler.begin(name);
+            }
+
+            Scope(const Scope& other) = delete;
+
+            inline ~Scope()
+            {
+                m_profiler.end();
+            }
+        };
+
+        struct Percentiles
+        {
+            float p50 = 0.0f;   // microseconds
+            float p95 = 0.0f;
+            float p99 = 0.0f;
+        };
+
+        struct Summary
+        {
+            std::string name;
+            size_t depth;       // nesting level scope was first opened at
+            size_t samples;     // CPU samples in history
+            Percentiles cpu;
+            Percentiles gpu;    // zeros if GPU timing isn't available
+        };
+
+    private:
+        using Clock = std::chrono::steady_clock;
+        using ScopeId = uint32_t;
+
+        struct ScopeData
+        {
+            std::string name;
+            size_t depth;
+            std::vector<float> cpu;
+            std::vector<float> gpu;
+            size_t cpuNext;
+            size_t gpuNext;
+        };
+
+        struct Record
+        {
+            ScopeId scope;
+            int64_t cpuBegin;       // nanoseconds since epoch
+            int64_t cpuEnd;
+            unsigned int query;     // index of begin timestamp query, end one follows it
+        };
+
+        struct Frame
+        {
+            std::vector<Record> records;
+            std::vector<unsigned int> queries;
+            size_t usedQueries = 0;
+            size_t lastQuery = 0;   // issued last, nested scopes end out of index order
+            bool submitted = false;
+        };
+
+        struct TraceEvent
+        {
+            ScopeId scope;
+            bool gpu;
+            int64_t begin;          // nanoseconds since epoch
+            int64_t duration;
+        };
+
+        /// @brief Add sample to history ring
+        /// @param samples History ring
+        /// @param next Slot to write next
+        /// @param sample The sample
+        static void Push(std::vector<float>& samples, size_t& next, float sample);
+
+        /// @brief Calculate percentiles of history
+        /// @param samples History ring, order doesn't matter
+        /// @return Percentiles
+        static Percentiles Calculate(std::vector<float> samples);
+
+    private:
+        Frame m_frames[ProfilerConst::Latency];
+        std::vector<ScopeData> m_scopes;
+        std::map<std::string, ScopeId, std::less<>> m_scopeIds;
+        std::vector<size_t> m_stack;        // records of open scopes
+        std::vector<TraceEvent> m_trace;
+        Clock::time_point m_epoch;
+        int64_t m_gpuOffset;                // GPU timestamp at epoch
+        size_t m_frame;
+        size_t m_droppedFrames;
+        bool m_gpu;
+        bool m_capturing;
+
+    private:
+        /// @brief Free allocated resources
+        void free();
+
+        /// @brief Get nanoseconds since epoch
+        /// @return CPU time
+        int64_t now() const;
+
+        /// @brief Align GPU timestamps with CPU time
+        void calibrate();
+
+        /// @brief Read GPU timestamps of frame, frame is dropped if they're not ready yet
+        /// @param frame The frame
+        void collect(Frame& frame);
+
+        /// @brief Add trace event if capturing
+        /// @param scope Scope of event
+        /// @param gpu Whether event is on GPU timeline
+        /// @param begin Event start in nanoseconds since epoch
+        /// @param duration Event duration in nanoseconds
+        void trace(ScopeId scope, bool gpu, int64_t begin, int64_t duration);
+
+    public:
+        Profiler();
+
+        Profiler(const Profiler& other) = delete;
+
+        ~Profiler();
+
+        /// @brief Enable GPU timing if timer queries are available, CPU time is measured either way
+        void create();
+
+        /// @brief Start frame, GPU timestamps of the frame issued ProfilerConst::Latency frames ago are read back
+        void beginFrame();
+
+        /// @brief Finish frame
+        /// @throw std::runtime_error if some scope is still open
+        void endFrame();
+
+        /// @brief Open scope, scopes opened before closing it are nested in it
+        /// @param name Scope name, scopes with the same name are aggregated together
+        void begin(std::string_view name);
+
+        /// @brief Close scope opened last
+        /// @throw std::runtime_error if no scope is open
+        void end();
+
+        /// @brief Start recording trace events, previous capture is discarded
+        void startCapture();
+
+        /// @brief Stop recording trace events and write them in Chrome trace event format
+        /// @param filePath Path to JSON file to write
+        /// @throw std::runtime_error if file couldn't be written
+        void stopCapture(const std::string& filePath);
+
+        /// @brief Get percentiles of every scope over recent frames
+        /// @return Scope summaries in order scopes were first opened
+        std::vector<Summary> summary() const;
+
+        /// @brief Check whether trace events are being recorded
+        /// @return True if trace events are being recorded
+        inline bool capturing() const
+        {
+            return m_capturing;
+        }
+
+        /// @brief Check whether GPU time is measured
+        /// @return True if GPU time is measured
+        inline bool gpu() const
+        {
+            return m_gpu;
+        }
+
+        /// @brief Get number of frames whose GPU timestamps weren't ready in time and were skipped
+        /// @return Number of dropped frames
+        inline size_t droppedFrames() const
+        {
+            return m_droppedFrames;
+        }
+    };
+}
+
+} // namespace kc
@@ -0,0 +1,149 @@
+#pragma once
+
+// STL modules
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <cstring>
+#include <functional>
+#include <unordered_map>
+#include <algorithm>
+#include <iterator>
+
+// Graphics libraries
+#include <GL/glew.h>
+
+// Custom modules
+#include "graphics/types/uniform_blocks.hpp"
+#include "graphics/camera.hpp"
+#include "graphics/shader_program.hpp"
+#include "graphics/state_cache.hpp"
+#include "graphics/stream_buffer.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace RenderQueueConst
+    {
+        namespace Key
+        {
+            /// @brief Bits of each key field, opaque keys are [layer|program|vertex array|material|depth], transparent keys are [layer|inverted depth|program|vertex array|material]
+            constexpr int LayerBits = 1;
+            constexpr int ProgramBits = 10;
+            constexpr int VertexArrayBits = 10;
+            constexpr int MaterialBits = 16;
+            constexpr int DepthBits = 24;
+        }
+
+        /// @brief Depths are quantized over this distance, farther draws share the last step
+        constexpr float DepthRange = CameraConst::Perspective::Far;
+    }
+
+    /// @brief Collects draw packets for a frame and issues them in state sorted order
+    class RenderQueue
+    {
+    public:
+        enum class Layer
+        {
+            Opaque,         // sorted by state, then front to back
+            Transparent,    // drawn after opaque, back to front
+        };
+
+        /// @brief Sets per-draw uniforms, binds textures and issues the draw, program, vertex array and object block are already bound
+        using Command = std::function<void(ShaderProgram& shaderProgram)>;
+
+        struct Packet
+        {
+            ShaderProgram* program;
+            unsigned int vertexArray;
+            unsigned int material;      // id of texture set chosen by submitter, 0 for none
+            unsigned int condition;     // occlusion query to render on, 0 for none
+            float depth;                // view space distance
+            Layer layer;
+            UniformBlocks::Object object;
+            Command command;
+        };
+
+        struct Statistics
+        {
+            size_t packets = 0;
+            size_t programSwitches = 0;
+            size_t vertexArraySwitches = 0;
+            size_t materialSwitches = 0;
+        };
+
+    private:
+        struct Entry
+        {
+            uint64_t key;
+            uint32_t packet;
+        };
+
+        /// @brief Sort entries by key, least significant byte first
+        /// @param entries Entries to sort
+        /// @param scratch Buffer of the same size to sort through
+        static void RadixSort(std::vector<Entry>& entries, std::vector<Entry>& scratch);
+
+        /// @brief Get small stable id of state object
+        /// @param ids Ids given so far
+        /// @param object The state object, 0 is always id 0
+        /// @param bits Id field width, ids past it wrap around
+        /// @return Object id
+        template <typename Object>
+        static uint64_t Id(std::unordered_map<Object, uint32_t>& ids, Object object, int bits)
+        {
+            if (!object)
+                return 0;
+
+            auto [iterator, inserted] = ids.try_emplace(object, static_cast<uint32_t>(ids.size() + 1));
+            return iterator->second & ((uint64_t(1) << bits) - 1);
+        }
+
+    private:
+        std::vector<Packet> m_packets;
+        std::vector<Entry> m_entries;
+        std::vector<Entry> m_scratch;
+        std::unordered_map<const ShaderProgram*, uint32_t> m_programIds;
+        std::unordered_map<unsigned int, uint32_t> m_vertexArrayIds;
+        std::unordered_map<unsigned int, uint32_t> m_materialIds;
+        Statistics m_statistics;
+
+    private:
+        /// @brief Encode packet into sort key
+        /// @param packet The packet
+        /// @return Sort key
+        uint64_t key(const Packet& packet);
+
+    public:
+        /// @brief Add packet to the frame
+        /// @param packet The packet, everything its command references must outlive execute()
+        /// @return Queued packet, valid until next submit
+        Packet& submit(Packet&& packet);
+
+        /// @brief Move every packet of other queue into this one, e.g. when jobs filled queues of their own
+        /// @param other The queue to take packets from, left empty
+        void append(RenderQueue& other);
+
+        /// @brief Sort and issue queued packets, then clear the queue
+        /// @param stream Stream buffer to write object blocks of the frame to
+        /// @throw std::runtime_error if object blocks don't fit in stream frame region
+        void execute(StreamBuffer& stream);
+
+        /// @brief Get number of queued packets
+        /// @return Number of queued packets
+        inline size_t size() const
+        {
+            return m_packets.size();
+        }
+
+        /// @brief Get counts of the last execute() call
+        /// @return Queue statistics
+        inline const Statistics& statistics() const
+        {
+            return m_statistics;
+        }
+    };
+}
+
+} // namespace kc
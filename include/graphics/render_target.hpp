@@ -0,0 +1,64 @@
+#pragma once
+
+// STL modules
+#include <stdexcept>
+
+// Library {fmt}
+#include <fmt/format.h>
+
+// Graphics libraries
+#include <GL/glew.h>
+
+namespace kc {
+
+namespace Graphics
+{
+    /// @brief Offscreen framebuffer with color and depth renderbuffers, drawn into instead of a window
+    class RenderTarget
+    {
+    private:
+        unsigned int m_frameBuffer;
+        unsigned int m_color;
+        unsigned int m_depth;
+        int m_width;
+        int m_height;
+
+    private:
+        /// @brief Free allocated resources
+        void free();
+
+    public:
+        RenderTarget();
+
+        RenderTarget(RenderTarget&& other) noexcept;
+
+        RenderTarget(const RenderTarget& other) = delete;
+
+        ~RenderTarget();
+
+        /// @brief Create render target
+        /// @param width Target width
+        /// @param height Target height
+        /// @throw std::runtime_error if framebuffer is incomplete
+        void create(int width, int height);
+
+        /// @brief Direct draws and reads to render target
+        void bind() const;
+
+        /// @brief Get target width
+        /// @return Target width
+        inline int width() const
+        {
+            return m_width;
+        }
+
+        /// @brief Get target height
+        /// @return Target height
+        inline int height() const
+        {
+            return m_height;
+        }
+    };
+}
+
+} // namespace kc
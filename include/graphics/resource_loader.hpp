@@ -0,0 +1,116 @@
+#pragma once
+
+// STL modules
+#include <string>
+#include <memory>
+#include <vector>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+
+// Graphics libraries
+#include <GL/glew.h>
+
+// Custom modules
+#include "common/image.hpp"
+#include "common/job_system.hpp"
+#include "common/utility.hpp"
+#include "graphics/model.hpp"
+#include "graphics/shader_program.hpp"
+#include "graphics/texture.hpp"
+#include "graphics/texture_cache.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace ResourceLoaderConst
+    {
+        /// @brief Default time in milliseconds spent on GL uploads per frame
+        constexpr float UploadBudget = 2.0f;
+    }
+
+    class ResourceLoader
+    {
+    public:
+        using Task = std::function<void()>;
+
+    private:
+        spdlog::logger m_logger;
+        JobSystem& m_jobs;
+        JobSystem::Counter m_counter;
+        std::atomic<bool> m_stopping;
+
+        std::deque<Task> m_uploads;
+        std::mutex m_uploadsMutex;
+        std::atomic<size_t> m_pending;
+        float m_uploadBudget;
+
+    private:
+        /// @brief Queue job for job system workers, run right away if there are none
+        /// @param job The job to queue, must not touch OpenGL or throw
+        void enqueue(Task&& job);
+
+        /// @brief Queue task for context thread
+        /// @param task The task to queue, run by drain()
+        void upload(Task&& task);
+
+        /// @brief Mark one queued job or task finished
+        void finish();
+
+    public:
+        /// @brief Create loader
+        /// @param jobs Job system to read and decode resources on, must outlive the loader
+        /// @param uploadBudget Time in milliseconds spent on GL uploads per frame
+        ResourceLoader(JobSystem& jobs, float uploadBudget = ResourceLoaderConst::UploadBudget);
+
+        ResourceLoader(const ResourceLoader& other) = delete;
+
+        /// @brief Wait for running jobs, unfinished requests are dropped
+        ~ResourceLoader();
+
+        /// @brief Request texture through texture cache, must be called on context thread
+        /// @param type Texture type
+        /// @param imageFilePath Path to image file
+        /// @param format Image format (GL_RGB, GL_RGBA, etc)
+        /// @param verticalFlip Whether to flip texture vertically or not
+        /// @return Texture showing placeholder until image is uploaded
+        Texture::Pointer loadTexture(Texture::Type type, const std::string& imageFilePath, int format = GL_RGB, bool verticalFlip = false);
+
+        /// @brief Request shader program, must be called on context thread
+        /// @param vertexShaderFilePath Path to vertex shader source file
+        /// @param fragmentShaderFilePath Path to fragment shader source file
+        /// @return Shader program, not ready until compiled and linked
+        std::shared_ptr<ShaderProgram> loadShaderProgram(const std::string& vertexShaderFilePath, const std::string& fragmentShaderFilePath);
+
+        /// @brief Request model, must be called on context thread
+        /// @param modelFilePath Path to model file
+        /// @param residency What CPU side geometry model meshes keep after upload
+        /// @param format GPU vertex layout of model meshes
+        /// @return Model, drawn as bounding box until every mesh is created
+        std::shared_ptr<Model> loadModel(const std::string& modelFilePath, Mesh::Residency residency = Mesh::Residency::Discard, VertexFormat format = VertexFormat::Full);
+
+        /// @brief Run queued GL uploads until upload budget is spent, at least one is run
+        /// @return Number of uploads run
+        size_t drain();
+
+        /// @brief Set time spent on GL uploads per frame
+        /// @param uploadBudget Time in milliseconds
+        inline void setUploadBudget(float uploadBudget)
+        {
+            m_uploadBudget = uploadBudget;
+        }
+
+        /// @brief Get number of unfinished jobs and uploads
+        /// @return Number of unfinished jobs and uploads
+        inline size_t pending() const
+        {
+            return m_pending;
+        }
+    };
+}
+
+} // namespace kc
@@ -0,0 +1,187 @@
+#pragma once
+
+// STL modules
+#include <cstdint>
+#include <vector>
+#include <memory>
+#include <variant>
+#include <limits>
+#include <functional>
+#include <stdexcept>
+
+// Library {fmt}
+#include <fmt/format.h>
+
+// Graphics libraries
+#include <glm/glm.hpp>
+
+// Custom modules
+#include "common/job_system.hpp"
+#include "graphics/types/bounding_box.hpp"
+#include "graphics/types/bounding_sphere.hpp"
+#include "graphics/types/transform.hpp"
+#include "graphics/bvh.hpp"
+#include "graphics/camera.hpp"
+#include "graphics/cube.hpp"
+#include "graphics/model.hpp"
+#include "graphics/occlusion_culler.hpp"
+#include "graphics/render_queue.hpp"
+#include "graphics/shader_program.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace SceneConst
+    {
+        /// @brief Root node, exists in every scene
+        constexpr uint32_t Root = 0;
+
+        /// @brief Marks missing node
+        constexpr uint32_t None = std::numeric_limits<uint32_t>::max();
+
+        /// @brief Part of objects moved in one update above which the whole hierarchy is refitted
+        constexpr float RefitRatio = 0.25f;
+
+        /// @brief Moved subtrees updated by one job
+        constexpr size_t UpdateGrain = 16;
+
+        /// @brief Visible objects submitted by one job
+        constexpr size_t SubmitGrain = 64;
+    }
+
+    /// @brief Hierarchy of transformed objects with a bounding volume hierarchy over them
+    class Scene
+    {
+    public:
+        using NodeId = uint32_t;
+        using Content = std::variant<std::monostate, std::shared_ptr<Model>, std::shared_ptr<Cube>>;
+        using Visitor = std::function<void(NodeId node)>;
+
+    private:
+        struct Node
+        {
+            NodeId parent;
+            std::vector<NodeId> children;
+            Transform transform;
+            glm::mat4 world;
+            Content content;
+            uint32_t object;    // BvhConst::Invalid for nodes without content
+            bool dirty;         // queued for next update
+        };
+
+    private:
+        std::vector<Node> m_nodes;
+        std::vector<NodeId> m_objects;
+        std::vector<BoundingBox> m_boxes;
+        std::vector<NodeId> m_dirty;
+        std::vector<NodeId> m_pending;
+        std::vector<uint32_t> m_moved;
+        std::vector<NodeId> m_roots;
+        std::vector<std::vector<uint32_t>> m_chunkMoved;
+        mutable std::vector<uint32_t> m_visible;
+        mutable std::vector<unsigned int> m_conditions;
+        mutable std::vector<RenderQueue> m_chunkQueues;
+        Bvh m_bvh;
+        uint64_t m_structure;       // bumped whenever nodes are added
+        bool m_rebuild;
+
+    private:
+        /// @brief Submit one object to render queue
+        /// @param queue Render queue to submit to
+        /// @param object The object
+        /// @param shaderProgram Shader program to draw with
+        /// @param camera Camera to draw for
+        /// @param condition Occlusion query to render on, 0 for none
+        void submitObject(RenderQueue& queue, uint32_t object, ShaderProgram& shaderProgram, const Camera& camera, unsigned int condition) const;
+
+        /// @brief Update world matrices and boxes of subtree
+        /// @param root Subtree root node
+        /// @param stack Traversal scratch
+        /// @param moved Objects whose boxes changed are added to it
+        void updateSubtree(NodeId root, std::vector<NodeId>& stack, std::vector<uint32_t>& moved);
+
+        /// @brief Compute world space box of node content
+        /// @param node The node with content
+        /// @return World space box, empty if content bounds aren't known yet
+        static BoundingBox ContentBox(const Node& node);
+
+        /// @brief Get node, checking its id
+        /// @param node Node id
+        /// @param function Calling function name for error message
+        /// @throw std::runtime_error if node doesn't exist
+        /// @return The node
+        Node& at(NodeId node, const char* function);
+
+    public:
+        /// @brief Create scene with root node only
+        Scene();
+
+        /// @brief Add node to scene, content transform is applied under node transform
+        /// @param parent Parent node
+        /// @param transform Node transform relative to parent
+        /// @param content Node content
+        /// @throw std::runtime_error if parent doesn't exist
+        /// @return Added node
+        NodeId add(NodeId parent, const Transform& transform, Content content = {});
+
+        /// @brief Move node and its subtree, applied on next update
+        /// @param node The node to move
+        /// @param transform Node transform relative to parent
+        /// @throw std::runtime_error if node doesn't exist
+        void setTransform(NodeId node, const Transform& transform);
+
+        /// @brief Propagate moved transforms and bring bounding volume hierarchy up to date
+        /// @param jobs Job system to update moved subtrees in parallel on, serial if null
+        void update(JobSystem* jobs = nullptr);
+
+        /// @brief Copy what submit(), pick() and query() read into another scene, e.g. a frame snapshot.
+        /// If target already holds a snapshot of the same structure only transforms, boxes and hierarchy are copied.
+        /// @param target Scene to copy to, must be up to date before the copy
+        void snapshot(Scene& target) const;
+
+        /// @brief Submit visible objects to render queue
+        /// @param queue Render queue to submit to, scene must outlive its execution
+        /// @param shaderProgram Shader program to draw with
+        /// @param camera Camera to draw for
+        /// @param occlusion Occlusion culler to skip hidden objects with, its boxes must be tested after the queue is executed
+        /// @param jobs Job system to cull meshes, select detail levels and build packets in parallel on, serial if null
+        void submit(RenderQueue& queue, ShaderProgram& shaderProgram, const Camera& camera, OcclusionCuller* occlusion = nullptr, JobSystem* jobs = nullptr) const;
+
+        /// @brief Find the nearest object whose bounds ray hits
+        /// @param origin Ray origin
+        /// @param direction Ray direction
+        /// @return Hit node or SceneConst::None
+        NodeId pick(const glm::vec3& origin, const glm::vec3& direction) const;
+
+        /// @brief Report objects whose bounds overlap sphere, e.g. objects reached by a light
+        /// @param sphere World space sphere
+        /// @param visitor Visitor to report nodes to
+        void query(const BoundingSphere& sphere, const Visitor& visitor) const;
+
+        /// @brief Get node transform
+        /// @param node The node
+        /// @return Node transform relative to parent
+        inline const Transform& transform(NodeId node) const
+        {
+            return m_nodes[node].transform;
+        }
+
+        /// @brief Get node world matrix as of last update
+        /// @param node The node
+        /// @return World matrix
+        inline const glm::mat4& world(NodeId node) const
+        {
+            return m_nodes[node].world;
+        }
+
+        /// @brief Get number of objects in scene
+        /// @return Number of nodes with content
+        inline size_t objects() const
+        {
+            return m_objects.size();
+        }
+    };
+}
+
+} // namespace kc
@@ -4,6 +4,9 @@
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
 
 // Library {fmt}
 #include <fmt/format.h>
@@ -19,7 +22,9 @@
 #include "graphics/types/light_cutoff.hpp"
 #include "graphics/types/light_properties.hpp"
 #include "graphics/types/material.hpp"
+#include "graphics/state_cache.hpp"
 #include "graphics/texture.hpp"
+#include "graphics/uniform_buffer.hpp"
 
 namespace kc {
 
@@ -27,13 +32,34 @@ namespace Graphics
 {
     class ShaderProgram
     {
+    public:
+        /// @brief Pre-resolved uniform location
+        using UniformHandle = int;
+
+        /// @brief Invalid uniform handle, setting it is silently ignored
+        static constexpr UniformHandle InvalidHandle = -1;
+
     private:
+        struct UniformNameHash
+        {
+            using is_transparent = void;
+
+            inline size_t operator()(std::string_view name) const
+            {
+                return std::hash<std::string_view>{}(name);
+            }
+        };
+
+        using Uniforms = std::unordered_map<std::string, UniformHandle, UniformNameHash, std::equal_to<>>;
+
+    public:
         /// @brief Read file
         /// @param filePath Path to the file
         /// @throw std::runtime_error if file couldn't be opened
         /// @return File contents
         static std::string ReadFile(const std::string& filePath);
 
+    private:
         /// @brief Convert shader type to name
         /// @param type Shader type
         /// @return Converted shader name
@@ -53,10 +79,21 @@ namespace Graphics
         /// @return Linked shader program
         static unsigned int LinkShaderProgram(unsigned int vertexShader, unsigned int fragmentShader);
 
+        /// @brief Enumerate active uniforms of linked shader program
+        /// @param program Linked shader program
+        /// @return Uniform locations by name without "u" prefix
+        static Uniforms ReadUniforms(unsigned int program);
+
+        /// @brief Bind known uniform blocks of linked shader program to their fixed binding points
+        /// @param program Linked shader program
+        static void BindUniformBlocks(unsigned int program);
+
     private:
         unsigned int m_vertexShader;
         unsigned int m_fragmentShader;
         unsigned int m_shaderProgram;
+        Uniforms m_uniforms;
+        mutable std::string m_nameBuffer;
 
     private:
         /// @brief Free allocated resources
@@ -74,64 +111,129 @@ namespace Graphics
         /// @throw std::runtime_error if read/compile/link error occurs
         void make(const std::string& vertexShaderFilePath, const std::string& fragmentShaderFilePath);
 
+        /// @brief Compile shaders from already read sources and link shader program
+        /// @param vertexShaderSource Vertex shader source
+        /// @param fragmentShaderSource Fragment shader source
+        /// @throw std::runtime_error if compile/link error occurs
+        void compile(const std::string& vertexShaderSource, const std::string& fragmentShaderSource);
+
+        /// @brief Check if shader program is linked and usable
+        /// @return True if shader program is ready
+        inline bool ready() const
+        {
+            return m_shaderProgram != 0;
+        }
+
         /// @brief Tell OpenGL to use this shader program
         void use() const;
 
+        /// @brief Resolve uniform handle
+        /// @param name Uniform name without "u" prefix
+        /// @return Resolved handle or InvalidHandle if there is no such active uniform
+        UniformHandle uniform(std::string_view name) const;
+
+        /// @brief Resolve uniform struct member handle
+        /// @param name Uniform struct name without "u" prefix
+        /// @param member Struct member name
+        /// @return Resolved handle or InvalidHandle if there is no such active uniform
+        UniformHandle uniform(std::string_view name, std::string_view member) const;
+
+        /// @brief Set uniform boolean
+        /// @param handle Boolean handle
+        /// @param boolean The boolean to set
+        void set(UniformHandle handle, bool boolean);
+
+        /// @brief Set uniform integer
+        /// @param handle Integer handle
+        /// @param integer The integer to set
+        void set(UniformHandle handle, int integer);
+
+        /// @brief Set uniform real
+        /// @param handle Real handle
+        /// @param real The real to set
+        void set(UniformHandle handle, float real);
+
+        /// @brief Set uniform vector
+        /// @param handle Vector handle
+        /// @param vector The vector to set
+        void set(UniformHandle handle, const glm::vec3& vector);
+
+        /// @brief Set uniform matrix
+        /// @param handle Matrix handle
+        /// @param matrix The matrix to set
+        void set(UniformHandle handle, const glm::mat4& matrix);
+
+        /// @brief Set uniform normal matrix
+        /// @param handle Matrix handle
+        /// @param matrix The matrix to set
+        void set(UniformHandle handle, const glm::mat3& matrix);
+
+        /// @brief Set uniform color
+        /// @param handle Color handle
+        /// @param color The color to set
+        void set(UniformHandle handle, Color color);
+
+        /// @brief Set uniform texture
+        /// @param handle Texture handle
+        /// @param texture The texture to set
+        /// @param id Texture ID
+        void set(UniformHandle handle, const Texture& texture, int id);
+
         /// @brief Set uniform boolean
         /// @param name Boolean name
         /// @param boolean The boolean to set
-        void set(const std::string& name, bool boolean);
+        void set(std::string_view name, bool boolean);
 
         /// @brief Set uniform integer
         /// @param name Integer name
         /// @param integer The integer to set
-        void set(const std::string& name, int integer);
+        void set(std::string_view name, int integer);
 
         /// @brief Set uniform real
         /// @param name Real name
         /// @param real The real to set
-        void set(const std::string& name, float real);
+        void set(std::string_view name, float real);
 
         /// @brief Set uniform vector
         /// @param name Vector name
         /// @param vector The vector to set
-        void set(const std::string& name, const glm::vec3& vector);
+        void set(std::string_view name, const glm::vec3& vector);
 
         /// @brief Set uniform matrix
         /// @param name Matrix name
         /// @param matrix The matrix to set
-        void set(const std::string& name, const glm::mat4& matrix);
+        void set(std::string_view name, const glm::mat4& matrix);
 
         /// @brief Set uniform color struct
         /// @param name Color struct name
         /// @param color The color struct to set
-        void set(const std::string& name, Color color);
+        void set(std::string_view name, Color color);
 
         /// @brief Set uniform light attenuation struct
         /// @param name Light attenuation struct name
         /// @param attenuation The light attenuation struct to set
-        void set(const std::string& name, const LightAttenuation& attenuation);
+        void set(std::string_view name, const LightAttenuation& attenuation);
 
         /// @brief Set uniform light cutoff struct
         /// @param name Light cutoff struct name
         /// @param cutoff The light cutoff struct to set
-        void set(const std::string& name, const LightCutoff& cutoff);
+        void set(std::string_view name, const LightCutoff& cutoff);
 
         /// @brief Set uniform light properties struct
         /// @param name Light properties struct name
         /// @param properties The light properties struct to set
-        void set(const std::string& name, const LightProperties& properties);
+        void set(std::string_view name, const LightProperties& properties);
 
         /// @brief Set uniform material struct
         /// @param name Material struct name
         /// @param material The material struct to set
-        void set(const std::string& name, const Material& material);
+        void set(std::string_view name, const Material& material);
 
         /// @brief Set uniform texture
         /// @param name Texture name
         /// @param texture The texture to set
         /// @param id Texture ID
-        void set(const std::string& name, const Texture& texture, int id);
+        void set(std::string_view name, const Texture& texture, int id);
     };
 }
 
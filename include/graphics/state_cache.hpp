@@ -0,0 +1,122 @@
+#pragma once
+
+// STL modules
+#include <cstddef>
+
+// Graphics libraries
+#include <GL/glew.h>
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace StateCacheConst
+    {
+        /// @brief Number of texture units tracked by the cache, binds to higher units are always issued
+        constexpr unsigned int TextureUnits = 32;
+    }
+
+    namespace StateCache
+    {
+        struct Statistics
+        {
+            size_t issued = 0;
+            size_t elided = 0;
+        };
+
+        /// @brief Forget all cached state so that next calls are issued unconditionally
+        /// @note Must be called after context creation or after raw GL calls that change cached state
+        void Invalidate();
+
+        /// @brief Use shader program
+        /// @param program Shader program to use
+        void UseProgram(unsigned int program);
+
+        /// @brief Select active texture unit
+        /// @param unit Texture unit index (0 for GL_TEXTURE0, etc)
+        void ActiveTexture(unsigned int unit);
+
+        /// @brief Bind 2D texture to texture unit
+        /// @param unit Texture unit index (0 for GL_TEXTURE0, etc)
+        /// @param texture The texture to bind
+        void BindTexture(unsigned int unit, unsigned int texture);
+
+        /// @brief Bind 2D texture to currently active texture unit
+        /// @param texture The texture to bind
+        void BindTexture(unsigned int texture);
+
+        /// @brief Bind buffer texture to texture unit
+        /// @param unit Texture unit index (0 for GL_TEXTURE0, etc)
+        /// @param texture The buffer texture to bind
+        void BindTextureBuffer(unsigned int unit, unsigned int texture);
+
+        /// @brief Bind buffer to non-indexed target
+        /// @param target Buffer target (GL_ARRAY_BUFFER, GL_UNIFORM_BUFFER, etc)
+        /// @param buffer The buffer to bind
+        /// @note GL_ELEMENT_ARRAY_BUFFER is vertex array state and is never elided
+        void BindBuffer(unsigned int target, unsigned int buffer);
+
+        /// @brief Bind buffer to indexed target binding point
+        /// @param target Indexed buffer target (GL_UNIFORM_BUFFER, etc)
+        /// @param index Binding point index
+        /// @param buffer The buffer to bind
+        void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer);
+
+        /// @brief Bind buffer range to indexed target binding point
+        /// @param target Indexed buffer target (GL_UNIFORM_BUFFER, etc)
+        /// @param index Binding point index
+        /// @param buffer The buffer to bind
+        /// @param offset Range offset in bytes
+        /// @param size Range size in bytes
+        void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, size_t offset, size_t size);
+
+        /// @brief Bind vertex array
+        /// @param vertexArray The vertex array to bind
+        void BindVertexArray(unsigned int vertexArray);
+
+        /// @brief Set polygon rasterization mode for both faces
+        /// @param mode The mode to set (GL_FILL, GL_LINE, etc)
+        void PolygonMode(int mode);
+
+        /// @brief Enable or disable depth testing
+        /// @param enabled Whether to enable depth testing or not
+        void DepthTest(bool enabled);
+
+        /// @brief Set depth comparison function
+        /// @param function The function to set (GL_LESS, GL_LEQUAL, etc)
+        void DepthFunction(int function);
+
+        /// @brief Enable or disable depth buffer writes
+        /// @param enabled Whether to write depth or not
+        void DepthMask(bool enabled);
+
+        /// @brief Enable or disable writes to every color channel
+        /// @param enabled Whether to write color or not
+        void ColorMask(bool enabled);
+
+        /// @brief Tell cache that shader program was deleted
+        /// @param program Deleted shader program
+        void ForgetProgram(unsigned int program);
+
+        /// @brief Tell cache that texture was deleted
+        /// @param texture Deleted texture
+        void ForgetTexture(unsigned int texture);
+
+        /// @brief Tell cache that buffer was deleted
+        /// @param buffer Deleted buffer
+        void ForgetBuffer(unsigned int buffer);
+
+        /// @brief Tell cache that vertex array was deleted
+        /// @param vertexArray Deleted vertex array
+        void ForgetVertexArray(unsigned int vertexArray);
+
+        /// @brief Get issued and elided call counters
+        /// @return Call counters
+        Statistics GetStatistics();
+
+        /// @brief Reset issued and elided call counters
+        void ResetStatistics();
+    }
+}
+
+} // namespace kc
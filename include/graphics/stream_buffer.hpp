@@ -0,0 +1,150 @@
+#pragma once
+
+// STL modules
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+// Library {fmt}
+#include <fmt/format.h>
+
+// Graphics libraries
+#include <GL/glew.h>
+
+// Custom modules
+#include "graphics/state_cache.hpp"
+#include "graphics/uniform_buffer.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace StreamBufferConst
+    {
+        /// @brief Frame regions in the ring, GPU may still read the previous ones while CPU writes the current one
+        constexpr size_t Frames = 3;
+
+        /// @brief Fence wait timeout in nanoseconds, waits are repeated until the region is free
+        constexpr uint64_t WaitTimeout = 1'000'000'000;
+    }
+
+    /// @brief Ring of per-frame regions that dynamic data is written into linearly and bound by offset.
+    /// Region is reused only after fence of the frame that used it last has signaled.
+    class StreamBuffer
+    {
+    public:
+        struct Mapping
+        {
+            uint8_t* data;  // valid until unmap()
+            size_t offset;  // offset in buffer
+        };
+
+        struct Statistics
+        {
+            size_t written = 0;     // bytes written this frame
+            size_t waits = 0;       // frames that had to wait for GPU, since creation
+        };
+
+    private:
+        unsigned int m_buffer;
+        uint8_t* m_persistent;  // whole buffer mapped for its lifetime, nullptr if ranges are mapped one by one
+        GLsync m_fences[StreamBufferConst::Frames];
+        size_t m_regionSize;
+        size_t m_region;
+        size_t m_head;
+        size_t m_uniformAlignment;
+        bool m_mapped;
+        Statistics m_statistics;
+
+    private:
+        /// @brief Free allocated resources
+        void free();
+
+    public:
+        StreamBuffer();
+
+        StreamBuffer(StreamBuffer&& other) noexcept;
+
+        StreamBuffer(const StreamBuffer& other) = delete;
+
+        ~StreamBuffer();
+
+        /// @brief Create buffer, persistently mapped if ARB_buffer_storage is available
+        /// @param regionSize Bytes a single frame may write
+        /// @throw std::runtime_error if buffer couldn't be mapped
+        void create(size_t regionSize);
+
+        /// @brief Start writing next frame region, waiting only if GPU is a whole ring behind
+        /// @throw std::runtime_error if fence wait fails
+        void begin();
+
+        /// @brief Fence current frame region, everything using it must be issued already
+        void end();
+
+        /// @brief Reserve range of current frame region for writing
+        /// @param size Range size in bytes
+        /// @param alignment Range offset alignment in bytes
+        /// @return Writable range, must be unmapped before anything draws
+        /// @throw std::runtime_error if range doesn't fit in frame region or couldn't be mapped
+        Mapping map(size_t size, size_t alignment);
+
+        /// @brief Finish writing range returned by last map()
+        void unmap();
+
+        /// @brief Write data to current frame region
+        /// @param data Data to write
+        /// @param size Data size in bytes
+        /// @param alignment Data offset alignment in bytes
+        /// @return Offset of written data in buffer
+        /// @throw std::runtime_error if data doesn't fit in frame region or couldn't be mapped
+        size_t write(const void* data, size_t size, size_t alignment);
+
+        /// @brief Bind range of buffer to uniform block binding point
+        /// @param binding Binding point to bind to
+        /// @param offset Range offset, must be a multiple of uniformAlignment()
+        /// @param size Range size in bytes
+        void bind(UniformBuffer::Binding binding, size_t offset, size_t size) const;
+
+        /// @brief Write uniform block and bind it
+        /// @param binding Binding point to bind to
+        /// @param block The block to write
+        /// @throw std::runtime_error if block doesn't fit in frame region or couldn't be mapped
+        template <typename Block>
+        inline void upload(UniformBuffer::Binding binding, const Block& block)
+        {
+            bind(binding, write(&block, sizeof(Block), m_uniformAlignment), sizeof(Block));
+        }
+
+        /// @brief Get buffer
+        /// @return OpenGL buffer
+        inline unsigned int id() const
+        {
+            return m_buffer;
+        }
+
+        /// @brief Check whether buffer is persistently mapped
+        /// @return True if buffer is persistently mapped
+        inline bool persistent() const
+        {
+            return m_persistent != nullptr;
+        }
+
+        /// @brief Get offset alignment uniform block ranges need
+        /// @return Alignment in bytes
+        inline size_t uniformAlignment() const
+        {
+            return m_uniformAlignment;
+        }
+
+        /// @brief Get stream counters
+        /// @return Stream statistics
+        inline const Statistics& statistics() const
+        {
+            return m_statistics;
+        }
+    };
+}
+
+} // namespace kc
@@ -1,20 +1,42 @@
 #pragma once
 
 // STL modules
+#include <cstdint>
+#include <algorithm>
+#include <iterator>
 #include <string>
 #include <memory>
+#include <variant>
+#include <filesystem>
 #include <stdexcept>
 
 // Graphics libraries
 #include <GL/glew.h>
 
 // Custom modules
+#include "common/compressed_image.hpp"
 #include "common/image.hpp"
+#include "graphics/state_cache.hpp"
 
 namespace kc {
 
 namespace Graphics
 {
+    namespace TextureConst
+    {
+        namespace Placeholder
+        {
+            /// @brief Placeholder checker texture side in texels
+            constexpr int Size = 8;
+
+            /// @brief Placeholder checker colors (RGBA)
+            constexpr uint8_t Colors[2][4] = {
+                { 255, 0, 255, 255 },
+                { 32, 32, 32, 255 },
+            };
+        }
+    }
+
     class Texture
     {
     public:
@@ -27,23 +49,48 @@ namespace Graphics
             Specular,
         };
 
+        /// @brief Decoded image or precompressed image with mipmap chain
+        using Source = std::variant<Image, CompressedImage>;
+
+    public:
+        /// @brief Check if compressed format can be uploaded to current context
+        /// @param format GL compressed internal format
+        /// @return True if format is supported
+        static bool Supported(unsigned int format);
+
+        /// @brief Read texture image, safe to call from multiple threads
+        /// @param imageFilePath Path to image file (.png, .jpg, .dds, .ktx, etc)
+        /// @param verticalFlip Whether to flip image vertically or not, compressed images have it baked in
+        /// @throw std::runtime_error if image couldn't be read
+        /// @return Compressed sibling (image.dds or image.flip.dds) if it is up to date and supported, decoded image otherwise
+        static Source ReadSource(const std::string& imageFilePath, bool verticalFlip);
+
     private:
-        /// @brief Load texture from image file
-        /// @param imageFilePath Path to image file
+        /// @brief Estimate GPU memory used by texture with full mipmap chain
+        /// @param width Texture width
+        /// @param height Texture height
         /// @param format Image format (GL_RGB, GL_RGBA, etc)
-        /// @param verticalFlip Whether to flip texture vertically or not
-        /// @throw std::runtime_error if texture couldn't be loaded
-        static unsigned int LoadTexture(const std::string& imageFilePath, int format, bool verticalFlip);
+        /// @return Estimated size in bytes
+        static size_t Memory(int width, int height, int format);
+
+        /// @brief Create checker texture shown until real image is uploaded
+        /// @return Created texture
+        static unsigned int LoadPlaceholder();
 
     private:
         unsigned int m_texture;
         Type m_type;
+        size_t m_memory;
 
     private:
         /// @brief Free allocated resources
         void free();
 
     public:
+        /// @brief Create placeholder texture to be uploaded later
+        /// @param type Texture type
+        Texture(Type type);
+
         /// @brief Load texture from image file
         /// @param type Texture type
         /// @param imageFilePath Path to image file
@@ -52,6 +99,12 @@ namespace Graphics
         /// @throw std::runtime_error if texture couldn't be loaded
         Texture(Type type, const std::string& imageFilePath, int format = GL_RGB, bool verticalFlip = false);
 
+        /// @brief Create texture from already read image
+        /// @param type Texture type
+        /// @param source Read image
+        /// @param format Image format (GL_RGB, GL_RGBA, etc), ignored for compressed images
+        Texture(Type type, const Source& source, int format = GL_RGB);
+
         Texture(Texture&& other) noexcept;
 
         Texture(const Texture& other) = delete;
@@ -61,6 +114,11 @@ namespace Graphics
         /// @brief Bind this texture
         void bind() const;
 
+        /// @brief Replace texture image, keeping texture ID
+        /// @param source Read image
+        /// @param format Image format (GL_RGB, GL_RGBA, etc), ignored for compressed images
+        void upload(const Source& source, int format);
+
         /// @brief Set texture filtering mode for direction
         /// @param direction Filtering direction (GL_TEXTURE_MIN_FILTER, GL_TEXTURE_MAG_FILTER, etc)
         /// @param mode The filtering mode to set (GL_NEAREST, GL_LINEAR, etc)
@@ -92,6 +150,13 @@ namespace Graphics
         {
             return m_type;
         }
+
+        /// @brief Get estimated GPU memory used by texture
+        /// @return Estimated size in bytes
+        inline size_t memory() const
+        {
+            return m_memory;
+        }
     };
 }
 
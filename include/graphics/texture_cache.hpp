@@ -0,0 +1,82 @@
+#pragma once
+
+// STL modules
+#include <cstddef>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <filesystem>
+#include <functional>
+
+// Graphics libraries
+#include <GL/glew.h>
+
+// Custom modules
+#include "graphics/texture.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    namespace TextureCacheConst
+    {
+        /// @brief Default GPU memory budget for textures nobody but the cache holds
+        constexpr size_t MemoryBudget = 256 * 1024 * 1024;
+    }
+
+    /// @brief Process-wide registry sharing textures between models and window, context thread only
+    namespace TextureCache
+    {
+        struct Statistics
+        {
+            size_t entries = 0;
+            size_t retained = 0;
+            size_t memory = 0;
+            size_t hits = 0;
+            size_t misses = 0;
+            size_t evictions = 0;
+        };
+
+        /// @brief Find cached texture
+        /// @param type Texture type
+        /// @param imageFilePath Path to image file
+        /// @param format Image format (GL_RGB, GL_RGBA, etc)
+        /// @param verticalFlip Whether texture is flipped vertically or not
+        /// @return Cached texture or nullptr if there is no such alive texture
+        Texture::Pointer Find(Texture::Type type, const std::string& imageFilePath, int format = GL_RGB, bool verticalFlip = false);
+
+        /// @brief Register texture, replacing previous entry with the same key
+        /// @param type Texture type
+        /// @param imageFilePath Path to image file
+        /// @param format Image format (GL_RGB, GL_RGBA, etc)
+        /// @param verticalFlip Whether texture is flipped vertically or not
+        /// @param texture The texture to register
+        void Insert(Texture::Type type, const std::string& imageFilePath, int format, bool verticalFlip, const Texture::Pointer& texture);
+
+        /// @brief Find cached texture or load it synchronously
+        /// @param type Texture type
+        /// @param imageFilePath Path to image file
+        /// @param format Image format (GL_RGB, GL_RGBA, etc)
+        /// @param verticalFlip Whether to flip texture vertically or not
+        /// @throw std::runtime_error if texture couldn't be loaded
+        /// @return Shared texture
+        Texture::Pointer Load(Texture::Type type, const std::string& imageFilePath, int format = GL_RGB, bool verticalFlip = false);
+
+        /// @brief Release least recently used textures until memory fits budget
+        /// @note Released textures still in use elsewhere stay alive and findable until their last user drops them
+        void Trim();
+
+        /// @brief Set GPU memory budget and trim cache
+        /// @param budget Budget in bytes
+        void SetBudget(size_t budget);
+
+        /// @brief Drop every cache entry
+        void Clear();
+
+        /// @brief Get cache statistics
+        /// @return Cache statistics
+        Statistics GetStatistics();
+    }
+}
+
+} // namespace kc
@@ -0,0 +1,111 @@
+#pragma once
+
+// STL modules
+#include <limits>
+#include <algorithm>
+
+// Graphics libraries
+#include <glm/glm.hpp>
+
+namespace kc {
+
+namespace Graphics
+{
+    /// @brief Axis-aligned bounding box
+    struct BoundingBox
+    {
+        glm::vec3 minimum = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 maximum = glm::vec3(std::numeric_limits<float>::lowest());
+
+        /// @brief Grow box to contain point
+        /// @param point The point to contain
+        inline void merge(const glm::vec3& point)
+        {
+            minimum = glm::min(minimum, point);
+            maximum = glm::max(maximum, point);
+        }
+
+        /// @brief Grow box to contain other box
+        /// @param other The box to contain
+        inline void merge(const BoundingBox& other)
+        {
+            minimum = glm::min(minimum, other.minimum);
+            maximum = glm::max(maximum, other.maximum);
+        }
+
+        /// @brief Get box center
+        /// @return Box center
+        inline glm::vec3 center() const
+        {
+            return (minimum + maximum) * 0.5f;
+        }
+
+        /// @brief Get half of box surface area, used as hierarchy build cost
+        /// @return Half surface area, 0 for empty boxes
+        inline float halfArea() const
+        {
+            glm::vec3 extent = glm::max(maximum - minimum, glm::vec3(0.0f));
+            return extent.x * extent.y + extent.y * extent.z + extent.z * extent.x;
+        }
+
+        /// @brief Check if point is inside box
+        /// @param point The point to check
+        /// @return True if point is inside or on box surface
+        inline bool contains(const glm::vec3& point) const
+        {
+            return point.x >= minimum.x && point.x <= maximum.x
+                && point.y >= minimum.y && point.y <= maximum.y
+                && point.z >= minimum.z && point.z <= maximum.z;
+        }
+
+        /// @brief Check if boxes overlap
+        /// @param other The box to check
+        /// @return True if boxes overlap or touch
+        inline bool intersects(const BoundingBox& other) const
+        {
+            return minimum.x <= other.maximum.x && maximum.x >= other.minimum.x
+                && minimum.y <= other.maximum.y && maximum.y >= other.minimum.y
+                && minimum.z <= other.maximum.z && maximum.z >= other.minimum.z;
+        }
+
+        /// @brief Intersect box with ray
+        /// @param origin Ray origin
+        /// @param inverseDirection Reciprocal of ray direction components
+        /// @param maximumDistance Farthest distance to accept
+        /// @return Distance to the box, negative if ray misses it
+        inline float intersect(const glm::vec3& origin, const glm::vec3& inverseDirection, float maximumDistance) const
+        {
+            // Slab test
+            float enter = 0.0f, leave = maximumDistance;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                float first = (minimum[axis] - origin[axis]) * inverseDirection[axis];
+                float second = (maximum[axis] - origin[axis]) * inverseDirection[axis];
+                enter = std::max(enter, std::min(first, second));
+                leave = std::min(leave, std::max(first, second));
+            }
+            return enter <= leave ? enter : -1.0f;
+        }
+
+        /// @brief Transform box, the result encloses transformed corners
+        /// @param matrix Transformation matrix
+        /// @return Transformed box
+        inline BoundingBox transformed(const glm::mat4& matrix) const
+        {
+            // Arvo: every matrix element either adds to the minimum or to the maximum
+            BoundingBox result;
+            result.minimum = result.maximum = glm::vec3(matrix[3]);
+            for (int column = 0; column < 3; ++column)
+            {
+                glm::vec3 axis = glm::vec3(matrix[column]);
+                glm::vec3 first = axis * minimum[column];
+                glm::vec3 second = axis * maximum[column];
+                result.minimum += glm::min(first, second);
+                result.maximum += glm::max(first, second);
+            }
+            return result;
+        }
+    };
+}
+
+} // namespace kc
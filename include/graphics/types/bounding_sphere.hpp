@@ -0,0 +1,38 @@
+#pragma once
+
+// STL modules
+#include <algorithm>
+
+// Graphics libraries
+#include <glm/glm.hpp>
+
+namespace kc {
+
+namespace Graphics
+{
+    struct BoundingSphere
+    {
+        glm::vec3 center;
+        float radius;
+
+        /// @brief Make sphere enclosing axis-aligned box
+        /// @param minimum Box minimum corner
+        /// @param maximum Box maximum corner
+        /// @return Enclosing sphere
+        static inline BoundingSphere FromBox(const glm::vec3& minimum, const glm::vec3& maximum)
+        {
+            return { (minimum + maximum) * 0.5f, glm::length(maximum - minimum) * 0.5f };
+        }
+
+        /// @brief Transform sphere, non-uniform scale grows it to the largest axis scale
+        /// @param matrix Transformation matrix
+        /// @return Transformed sphere
+        inline BoundingSphere transformed(const glm::mat4& matrix) const
+        {
+            float scale = std::max({ glm::length(glm::vec3(matrix[0])), glm::length(glm::vec3(matrix[1])), glm::length(glm::vec3(matrix[2])) });
+            return { glm::vec3(matrix * glm::vec4(center, 1.0f)), radius * scale };
+        }
+    };
+}
+
+} // namespace kc
@@ -0,0 +1,18 @@
+#pragma once
+
+// Graphics libraries
+#include <glm/glm.hpp>
+
+namespace kc {
+
+namespace Graphics
+{
+    /// @brief Per-instance vertex attributes streamed to instanced draws
+    struct InstanceRecord
+    {
+        glm::mat4 model;    // attributes 3-6, one column each
+        glm::vec4 color;    // attribute 7
+    };
+}
+
+} // namespace kc
@@ -0,0 +1,29 @@
+#pragma once
+
+// Graphics libraries
+#include <glm/glm.hpp>
+
+namespace kc {
+
+namespace Graphics
+{
+    /// @brief Light as stored in light data texture buffer, one RGBA32F texel per member
+    struct LightRecord
+    {
+        enum class Type
+        {
+            Point = 0,
+            Spot = 1,
+        };
+
+        glm::vec4 position;     // xyz: view space position, w: influence radius
+        glm::vec4 color;        // rgb: color, w: light type
+        glm::vec4 attenuation;  // xyz: constant, linear, quadratic, w: outer cutoff cosine
+        glm::vec4 properties;   // xyz: ambient, diffuse, specular, w: inner cutoff cosine
+        glm::vec4 direction;    // xyz: view space direction
+    };
+
+    static_assert(sizeof(LightRecord) == sizeof(glm::vec4) * 5, "LightRecord must be tightly packed");
+}
+
+} // namespace kc
@@ -2,6 +2,7 @@
 
 // Graphics libraries
 #include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 
 namespace kc {
 
@@ -12,6 +13,20 @@ namespace Graphics
         glm::vec3 position = glm::vec3(0.0f);
         glm::vec3 rotation = glm::vec3(0.0f);
         glm::vec3 scale = glm::vec3(1.0f);
+
+        /// @brief Calculate model matrix
+        /// @return Model matrix
+        inline glm::mat4 matrix() const
+        {
+            // TODO: Rotate model around a single axis rather than three
+            glm::mat4 model(1.0f);
+            model = glm::translate(model, position);
+            model = glm::rotate(model, glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+            model = glm::rotate(model, glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+            model = glm::rotate(model, glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+            model = glm::scale(model, scale);
+            return model;
+        }
     };
 }
 
@@ -0,0 +1,100 @@
+#pragma once
+
+// STL modules
+#include <cstdint>
+
+// Graphics libraries
+#include <glm/glm.hpp>
+
+// Custom modules
+#include "graphics/types/color.hpp"
+#include "graphics/types/light_attenuation.hpp"
+#include "graphics/types/light_cutoff.hpp"
+#include "graphics/types/light_properties.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    /// @brief std140 mirrors of shader uniform blocks.
+    /// Every vec3 and every nested struct occupies a whole 16 byte slot, so all members are vec4.
+    namespace UniformBlocks
+    {
+        struct Frame
+        {
+            glm::mat4 view;
+            glm::mat4 projection;
+            glm::vec4 cameraPosition;
+        };
+
+        struct DirectionalLight
+        {
+            glm::vec4 color;
+            glm::vec4 properties;
+            glm::vec4 direction;
+        };
+
+        struct Lights
+        {
+            DirectionalLight directionalLight;
+            uint32_t directionalLightEnabled;
+            uint32_t padding[3];
+            glm::vec4 clusterScale;     // xy: tile size in pixels, z: depth slice scale, w: depth slice bias
+            glm::uvec4 clusterCount;    // xyz: cluster grid size, w: clustered light count
+        };
+
+        struct Object
+        {
+            glm::mat4 modelView;
+            glm::vec4 normalMatrix[3];  // mat3 columns
+        };
+
+        static_assert(sizeof(Frame) == 144, "Frame block doesn't match std140 layout");
+        static_assert(sizeof(Lights) == 96, "Lights block doesn't match std140 layout");
+        static_assert(sizeof(Object) == 112, "Object block doesn't match std140 layout");
+
+        /// @brief Make per-draw transforms block
+        /// @param modelView Model-view matrix
+        /// @param dequantization Transform from stored to original positions, normals are left untouched
+        /// @return Object block
+        inline Object MakeObject(const glm::mat4& modelView, const glm::mat4& dequantization = glm::mat4(1.0f))
+        {
+            glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(modelView)));
+            return { modelView * dequantization, { glm::vec4(normalMatrix[0], 0.0f), glm::vec4(normalMatrix[1], 0.0f), glm::vec4(normalMatrix[2], 0.0f) } };
+        }
+
+        /// @brief Pack color to std140 slot
+        /// @param color The color to pack
+        /// @return Packed color
+        inline glm::vec4 Pack(Color color)
+        {
+            return { color.red / 255.0f, color.green / 255.0f, color.blue / 255.0f, 0.0f };
+        }
+
+        /// @brief Pack light attenuation struct to std140 slot
+        /// @param attenuation The light attenuation struct to pack
+        /// @return Packed light attenuation struct
+        inline glm::vec4 Pack(const LightAttenuation& attenuation)
+        {
+            return { attenuation.constant, attenuation.linear, attenuation.quadratic, 0.0f };
+        }
+
+        /// @brief Pack light cutoff struct to std140 slot
+        /// @param cutoff The light cutoff struct to pack
+        /// @return Packed light cutoff struct
+        inline glm::vec4 Pack(const LightCutoff& cutoff)
+        {
+            return { glm::cos(glm::radians(cutoff.inner)), glm::cos(glm::radians(cutoff.outer)), 0.0f, 0.0f };
+        }
+
+        /// @brief Pack light properties struct to std140 slot
+        /// @param properties The light properties struct to pack
+        /// @return Packed light properties struct
+        inline glm::vec4 Pack(const LightProperties& properties)
+        {
+            return { properties.ambient, properties.diffuse, properties.specular, 0.0f };
+        }
+    }
+}
+
+} // namespace kc
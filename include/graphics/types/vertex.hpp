@@ -0,0 +1,29 @@
+#pragma once
+
+// Graphics libraries
+#include <glm/glm.hpp>
+
+namespace kc {
+
+namespace Graphics
+{
+    /// @brief Mesh vertex, attributes 0-2
+    struct Vertex
+    {
+        glm::vec3 position;
+        glm::vec3 normal;
+        glm::vec2 texCoords;
+    };
+
+    using Indice = unsigned int;
+
+    /// @brief Layout of vertices in GPU buffers
+    enum class VertexFormat
+    {
+        Full,       // 32 bytes: float position, normal and texture coordinates
+        Compact,    // 20 bytes: float position, 2_10_10_10 normal, half float texture coordinates
+        Quantized,  // 16 bytes: like compact, but with 16-bit positions inside known bounds
+    };
+}
+
+} // namespace kc
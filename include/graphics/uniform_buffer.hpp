@@ -0,0 +1,78 @@
+#pragma once
+
+// STL modules
+#include <optional>
+#include <string_view>
+
+// Graphics libraries
+#include <GL/glew.h>
+
+// Custom modules
+#include "graphics/state_cache.hpp"
+
+namespace kc {
+
+namespace Graphics
+{
+    class UniformBuffer
+    {
+    public:
+        /// @brief Fixed binding points shared by all shader programs
+        enum class Binding : unsigned int
+        {
+            Frame = 0,
+            Lights = 1,
+            Object = 2,
+        };
+
+        /// @brief Get binding point of uniform block
+        /// @param blockName Uniform block name as declared in shader
+        /// @return Binding point or std::nullopt if block is unknown
+        static std::optional<Binding> BlockBinding(std::string_view blockName);
+
+    private:
+        unsigned int m_buffer;
+        size_t m_size;
+
+    private:
+        /// @brief Free allocated resources
+        void free();
+
+    public:
+        UniformBuffer();
+
+        UniformBuffer(UniformBuffer&& other) noexcept;
+
+        UniformBuffer(const UniformBuffer& other) = delete;
+
+        ~UniformBuffer();
+
+        /// @brief Create buffer and bind it to binding point
+        /// @param binding Binding point to bind to
+        /// @param size Buffer size in bytes
+        void create(Binding binding, size_t size);
+
+        /// @brief Upload buffer contents
+        /// @param data Data to upload
+        /// @param size Data size in bytes
+        /// @param offset Offset in buffer to upload to
+        void update(const void* data, size_t size, size_t offset = 0);
+
+        /// @brief Upload whole block
+        /// @param block The block to upload
+        template <typename Block>
+        inline void update(const Block& block)
+        {
+            update(&block, sizeof(Block));
+        }
+
+        /// @brief Get buffer size
+        /// @return Buffer size in bytes
+        inline size_t size() const
+        {
+            return m_size;
+        }
+    };
+}
+
+} // namespace kc
@@ -5,6 +5,11 @@
 #include <cmath>
 #include <string>
 #include <stdexcept>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <chrono>
 
 // Library {fmt}
 #include <fmt/format.h>
@@ -16,25 +21,81 @@
 #include <glm/gtc/matrix_transform.hpp>
 
 // Custom common modules
+#include "common/job_system.hpp"
 #include "common/stopwatch.hpp"
 #include "common/utility.hpp"
 
 // Custom graphics modules
 #include "graphics/lighting/directional_light.hpp"
+#include "graphics/lighting/light_clusters.hpp"
 #include "graphics/lighting/point_light.hpp"
 #include "graphics/lighting/spot_light.hpp"
 #include "graphics/camera.hpp"
 #include "graphics/cube.hpp"
+#include "graphics/frame_pipeline.hpp"
+#include "graphics/instance_batch.hpp"
 #include "graphics/model.hpp"
+#include "graphics/occlusion_culler.hpp"
+#include "graphics/profiler.hpp"
+#include "graphics/render_queue.hpp"
+#include "graphics/render_target.hpp"
+#include "graphics/resource_loader.hpp"
+#include "graphics/scene.hpp"
 #include "graphics/shader_program.hpp"
+#include "graphics/state_cache.hpp"
+#include "graphics/stream_buffer.hpp"
 #include "graphics/texture.hpp"
+#include "graphics/texture_cache.hpp"
 
 namespace kc {
 
 namespace Graphics
 {
+    namespace WindowConst
+    {
+        /// @brief Frames simulation runs ahead of rendering by default
+        constexpr size_t Latency = 1;
+
+        /// @brief Bytes of dynamic data a single frame may stream
+        constexpr size_t StreamSize = 4 * 1024 * 1024;
+
+        /// @brief File profiler captures are written to
+        constexpr const char* TraceFilePath = "trace.json";
+
+        /// @brief Camera path of scripted runs, an orbit around the scene origin
+        namespace Script
+        {
+            constexpr float Radius = 5.0f;
+            constexpr float Height = 1.5f;
+            constexpr float Period = 12.0f;         // seconds per orbit
+            constexpr float Step = 1.0f / 60.0f;    // simulated seconds per frame, independent of real frame time
+        }
+
+        namespace LightField
+        {
+            constexpr size_t Size = 256;
+            constexpr float InnerRadius = 1.5f;
+            constexpr float OuterRadius = 8.0f;
+        }
+
+        /// @brief Grid of backpack copies behind the scene, drawn as one instanced batch
+        namespace Crowd
+        {
+            constexpr size_t Columns = 16;
+            constexpr size_t Rows = 16;
+            constexpr float Spacing = 4.0f;
+        }
+    }
+
     class Window
     {
+    public:
+        enum class Backend
+        {
+            Windowed,   // visible window, native context
+            Egl,        // no window system, EGL context rendering into offscreen target
+        };
+
     private:
         /// @brief GLFW framebuffer resize event callback
         /// @param window The window that received the event
@@ -62,20 +123,70 @@ namespace Graphics
         /// @param yOffset Y coordinate scroll offset
         static void ScrollCallback(GLFWwindow* window, double xOffset, double yOffset);
 
+    private:
+        /// @brief Input gathered on the main thread for simulation
+        struct Input
+        {
+            float xOffset = 0.0f;
+            float yOffset = 0.0f;
+            float scroll = 0.0f;
+            bool resetZoom = false;
+            bool resetPosition = false;
+            Camera::MovementMode movementMode = Camera::MovementMode::Normal;
+            std::vector<Camera::Key> keys;  // movement keys held down
+            bool spotLightAttached = true;
+            int width = 0;
+            int height = 0;
+        };
+
+        /// @brief Everything rendering needs from one simulated frame
+        struct Frame
+        {
+            Camera camera;
+            Scene scene;
+            Lighting::DirectionalLight directionalLight;
+            Lighting::PointLight pointLight;
+            Lighting::SpotLight spotLight;
+            int width = 0;
+            int height = 0;
+        };
+
     private:
         /* Window specific */
         spdlog::logger m_logger;
         GLFWwindow* m_window;
         int m_width;
         int m_height;
+        size_t m_latency;
+        Backend m_backend;
+        RenderTarget m_target;
+
+        /* Simulation, owned by simulation thread while pipeline runs */
+        std::mutex m_inputMutex;
+        Input m_input;
         Camera m_camera;
+        float m_lastSimulationTime;
+        bool m_scripted;
+        size_t m_scriptFrame;
 
         /* Resources */
-        ShaderProgram m_shaderProgram;
-        ShaderProgram m_lightShaderProgram;
+        JobSystem m_jobs;
+        ResourceLoader m_loader;
+        std::shared_ptr<ShaderProgram> m_shaderProgram;
+        std::shared_ptr<ShaderProgram> m_lightShaderProgram;
+        std::shared_ptr<ShaderProgram> m_instancedLightShaderProgram;
+        std::shared_ptr<ShaderProgram> m_instancedShaderProgram;
+        StreamBuffer m_stream;
+        Lighting::LightClusters m_lightClusters;
+        InstanceBatch<Cube> m_lightFieldBatch;
+        InstanceBatch<Model> m_crowdBatch;
+        OcclusionCuller m_occlusionCuller;
+        RenderQueue m_renderQueue;
+        Profiler m_profiler;
         Texture::Pointer m_containerTexture;
         Texture::Pointer m_containerSpecularTexture;
-        Model m_backpack;
+        std::shared_ptr<Model> m_backpack;
+        Scene m_scene;
 
         /* Variables */
         float m_currentFrameTime;
@@ -84,33 +195,53 @@ namespace Graphics
         bool m_directionalLightEnabled;
         bool m_pointLightEnabled;
         bool m_spotLightEnabled;
-        bool m_spotLightAttached;
+        bool m_lightFieldEnabled;
+        bool m_crowdEnabled;
 
     private:
-        /// @brief Process keyboard input for current frame
+        /// @brief Record held keys for next simulated frame
         void processInput();
 
+        /// @brief Apply input gathered since last call and simulate next frame
+        /// @param frame Frame snapshot to fill
+        /// @param directionalLight Simulated directional light
+        /// @param pointLight Simulated point light
+        /// @param spotLight Simulated spot light
+        void simulate(Frame& frame, Lighting::DirectionalLight& directionalLight, Lighting::PointLight& pointLight, Lighting::SpotLight& spotLight);
+
         /// @brief Toggle wireframe rendering mode
         void toggleWireframe();
 
         /// @brief Toggle VSync frame limiter
         void toggleVSync();
 
+        /// @brief Stop profiler capture and write it to WindowConst::TraceFilePath, errors are logged
+        void stopCapture();
+
+        /// @brief Log per-scope percentiles of profiler
+        void showProfile();
+
         /// @brief Show rendering FPS to console
-        void showFps() const;
+        /// @param camera Camera of rendered frame
+        void showFps(const Camera& camera) const;
 
     public:
         /// @brief Create window and prepare for rendering
         /// @param width Window width
         /// @param height Window height
         /// @param resourcesPath Path to resources directory
+        /// @param latency Frames simulation runs ahead of rendering, 0 simulates in lockstep
+        /// @param backend Where to render, headless backends render into offscreen target of window size
         /// @throw std::runtime_error if internal error occurs
-        Window(unsigned int width, unsigned int height, const std::string& resourcesPath);
+        Window(unsigned int width, unsigned int height, const std::string& resourcesPath, size_t latency = WindowConst::Latency, Backend backend = Backend::Windowed);
 
         ~Window();
 
         /// @brief Run loop
-        void run();
+        /// @param frames Frames to render along scripted camera path once resources are loaded, 0 to run interactively until window is closed
+        /// @param capture Whether to write profiler capture of the whole run
+        /// @throw std::runtime_error if internal error occurs
+        void run(size_t frames = 0, bool capture = false);
     };
 }
 
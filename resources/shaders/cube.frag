@@ -56,9 +56,20 @@ out vec4 FragColor;
 in vec3 FragPos;
 in vec3 Normal;
 in vec2 TexCoords;
-in DirectionalLight ioDirectionalLight;
-in PointLight ioPointLight;
-in SpotLight ioSpotLight;
+
+// Lights are in view space, transformed once per frame on CPU
+layout (std140) uniform Lights
+{
+    DirectionalLight uDirectionalLight;
+    bool uDirectionalLightEnabled;
+    vec4 uClusterScale;     // xy: tile size in pixels, z: depth slice scale, w: depth slice bias
+    uvec4 uClusterCount;    // xyz: cluster grid size, w: clustered light count
+};
+
+// Clustered point and spot lights
+uniform samplerBuffer uLightData;       // 5 texels per light, see LightRecord
+uniform usamplerBuffer uClusterGrid;    // offset and count of cluster lights in uLightIndices
+uniform usamplerBuffer uLightIndices;
 
 uniform vec3 uObjectColor;
 uniform Material uMaterial;
@@ -144,10 +155,42 @@ vec3 CalcSpotLight(SpotLight light)
     return result * attenuation;
 }
 
+uint CalcCluster()
+{
+    uvec3 cluster;
+    cluster.xy = uvec2(gl_FragCoord.xy / uClusterScale.xy);
+    cluster.z = uint(max(log(-FragPos.z) * uClusterScale.z - uClusterScale.w, 0.0f));
+    cluster = min(cluster, uClusterCount.xyz - 1u);
+    return cluster.x + cluster.y * uClusterCount.x + cluster.z * uClusterCount.x * uClusterCount.y;
+}
+
 void main()
 {
-    vec3 directionalLight = CalcDirectionalLight(ioDirectionalLight);
-    vec3 pointLight = CalcPointLight(ioPointLight);
-    vec3 spotLight = CalcSpotLight(ioSpotLight);
-    FragColor = vec4(directionalLight + pointLight + spotLight, 1.0f);
+    vec3 result = vec3(0.0f);
+    if (uDirectionalLightEnabled)
+        result += CalcDirectionalLight(uDirectionalLight);
+
+    uvec2 cluster = texelFetch(uClusterGrid, int(CalcCluster())).rg;
+    for (uint index = cluster.x; index < cluster.x + cluster.y; ++index)
+    {
+        int base = int(texelFetch(uLightIndices, int(index)).r) * 5;
+        vec4 position = texelFetch(uLightData, base);
+        vec4 color = texelFetch(uLightData, base + 1);
+        vec4 attenuation = texelFetch(uLightData, base + 2);
+        vec4 properties = texelFetch(uLightData, base + 3);
+        vec4 direction = texelFetch(uLightData, base + 4);
+
+        LightAttenuation lightAttenuation = LightAttenuation(attenuation.x, attenuation.y, attenuation.z);
+        LightProperties lightProperties = LightProperties(properties.x, properties.y, properties.z);
+        if (color.w == 0.0f)
+        {
+            result += CalcPointLight(PointLight(color.rgb, lightAttenuation, lightProperties, position.xyz));
+        }
+        else
+        {
+            LightCutoff cutoff = LightCutoff(properties.w, attenuation.w);
+            result += CalcSpotLight(SpotLight(color.rgb, lightAttenuation, cutoff, lightProperties, position.xyz, direction.xyz));
+        }
+    }
+    FragColor = vec4(result, 1.0f);
 }
@@ -0,0 +1,32 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in mat4 aModel;   // per instance, see InstanceRecord
+
+out vec3 FragPos;
+out vec3 Normal;
+out vec2 TexCoords;
+
+layout (std140) uniform Frame
+{
+    mat4 uView;
+    mat4 uProjection;
+    vec3 uCameraPosition;
+};
+
+// Transform from stored to original positions, set for quantized geometry only
+uniform mat4 uDequantization = mat4(1.0f);
+
+void main()
+{
+    mat4 modelView = uView * aModel;
+    vec4 viewPosition = modelView * uDequantization * vec4(aPos, 1.0f);
+    gl_Position = uProjection * viewPosition;
+    FragPos = vec3(viewPosition);
+    // Cofactor matrix is the normal matrix scaled by determinant, fragment shader normalizes anyway
+    mat3 linear = mat3(modelView);
+    mat3 normalMatrix = mat3(cross(linear[1], linear[2]), cross(linear[2], linear[0]), cross(linear[0], linear[1]));
+    Normal = normalMatrix * aNormal;
+    TexCoords = aTexCoords;
+}
@@ -1,11 +1,20 @@
 #version 330 core
 layout (location = 0) in vec3 aPos;
 
-uniform mat4 uModel;
-uniform mat4 uView;
-uniform mat4 uProjection;
+layout (std140) uniform Frame
+{
+    mat4 uView;
+    mat4 uProjection;
+    vec3 uCameraPosition;
+};
+
+layout (std140) uniform Object
+{
+    mat4 uModelView;
+    mat3 uNormalMatrix;
+};
 
 void main()
 {
-    gl_Position = uProjection * uView * uModel * vec4(aPos, 1.0);
+    gl_Position = uProjection * uModelView * vec4(aPos, 1.0);
 }
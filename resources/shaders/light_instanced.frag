@@ -0,0 +1,9 @@
+#version 330 core
+out vec4 FragmentColor;
+
+in vec3 LightColor;
+
+void main()
+{
+    FragmentColor = vec4(LightColor, 1.0f);
+}
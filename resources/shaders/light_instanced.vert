@@ -0,0 +1,19 @@
+#version 330 core
+layout (location = 0) in vec3 aPos;
+layout (location = 3) in mat4 aModel;   // per instance, see InstanceRecord
+layout (location = 7) in vec4 aColor;   // per instance
+
+out vec3 LightColor;
+
+layout (std140) uniform Frame
+{
+    mat4 uView;
+    mat4 uProjection;
+    vec3 uCameraPosition;
+};
+
+void main()
+{
+    gl_Position = uProjection * uView * aModel * vec4(aPos, 1.0);
+    LightColor = aColor.rgb;
+}
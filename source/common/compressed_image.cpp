@@ -0,0 +1,351 @@
+#include "common/compressed_image.hpp"
+
+namespace kc {
+
+namespace CompressedData
+{
+    /// @brief Make little-endian four character code
+    /// @param code Four characters
+    /// @return Four character code
+    constexpr uint32_t FourCC(const char (&code)[5])
+    {
+        return static_cast<uint32_t>(code[0]) | static_cast<uint32_t>(code[1]) << 8 | static_cast<uint32_t>(code[2]) << 16 | static_cast<uint32_t>(code[3]) << 24;
+    }
+
+    namespace Dds
+    {
+        constexpr uint32_t Magic = FourCC("DDS ");
+
+        namespace Flags
+        {
+            constexpr uint32_t Caps = 0x1;
+            constexpr uint32_t Height = 0x2;
+            constexpr uint32_t Width = 0x4;
+            constexpr uint32_t PixelFormat = 0x1000;
+            constexpr uint32_t MipMapCount = 0x20000;
+            constexpr uint32_t LinearSize = 0x80000;
+            constexpr uint32_t FourCC = 0x4;
+        }
+
+        namespace Caps
+        {
+            constexpr uint32_t Complex = 0x8;
+            constexpr uint32_t Texture = 0x1000;
+            constexpr uint32_t MipMap = 0x400000;
+        }
+
+        struct PixelFormat
+        {
+            uint32_t size;
+            uint32_t flags;
+            uint32_t fourCC;
+            uint32_t bitCount;
+            uint32_t masks[4];
+        };
+
+        struct Header
+        {
+            uint32_t size;
+            uint32_t flags;
+            uint32_t height;
+            uint32_t width;
+            uint32_t linearSize;
+            uint32_t depth;
+            uint32_t mipMapCount;
+            uint32_t reserved[11];
+            PixelFormat pixelFormat;
+            uint32_t caps[4];
+            uint32_t reserved2;
+        };
+
+        struct Header10
+        {
+            uint32_t dxgiFormat;
+            uint32_t dimension;
+            uint32_t miscFlags;
+            uint32_t arraySize;
+            uint32_t miscFlags2;
+        };
+
+        static_assert(sizeof(Header) == 124, "DDS header must be 124 bytes");
+
+        struct Format
+        {
+            uint32_t fourCC;
+            uint32_t dxgiFormat;
+            unsigned int format;
+        };
+
+        /// @brief Supported formats, fourCC 0 means DX10 header only
+        constexpr Format Formats[] = {
+            { FourCC("DXT1"), 71, GL_COMPRESSED_RGBA_S3TC_DXT1_EXT },
+            { 0, 72, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT },
+            { FourCC("DXT3"), 74, GL_COMPRESSED_RGBA_S3TC_DXT3_EXT },
+            { 0, 75, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT },
+            { FourCC("DXT5"), 77, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT },
+            { 0, 78, GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT },
+            { FourCC("ATI1"), 80, GL_COMPRESSED_RED_RGTC1 },
+            { FourCC("BC4U"), 80, GL_COMPRESSED_RED_RGTC1 },
+            { FourCC("ATI2"), 83, GL_COMPRESSED_RG_RGTC2 },
+            { FourCC("BC5U"), 83, GL_COMPRESSED_RG_RGTC2 },
+            { 0, 98, GL_COMPRESSED_RGBA_BPTC_UNORM },
+            { 0, 99, GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM },
+        };
+    }
+
+    namespace Ktx
+    {
+        constexpr uint8_t Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+        constexpr uint32_t Endianness = 0x04030201;
+
+        struct Header
+        {
+            uint8_t identifier[12];
+            uint32_t endianness;
+            uint32_t glType;
+            uint32_t glTypeSize;
+            uint32_t glFormat;
+            uint32_t glInternalFormat;
+            uint32_t glBaseInternalFormat;
+            uint32_t pixelWidth;
+            uint32_t pixelHeight;
+            uint32_t pixelDepth;
+            uint32_t numberOfArrayElements;
+            uint32_t numberOfFaces;
+            uint32_t numberOfMipmapLevels;
+            uint32_t bytesOfKeyValueData;
+        };
+    }
+
+    /// @brief Read trivially copyable value from file contents
+    /// @param file File contents
+    /// @param offset Value offset
+    /// @param value Read value
+    /// @return True if value is within file bounds
+    template <typename Type>
+    bool Read(const std::vector<uint8_t>& file, size_t offset, Type& value)
+    {
+        if (offset > file.size() || sizeof(Type) > file.size() - offset)
+            return false;
+        std::memcpy(&value, file.data() + offset, sizeof(Type));
+        return true;
+    }
+
+    /// @brief Get file extension in lower case
+    /// @param filePath Path to the file
+    /// @return Lower case extension with dot
+    std::string Extension(const std::string& filePath)
+    {
+        size_t dot = filePath.find_last_of('.');
+        if (dot == std::string::npos || filePath.find_first_of("/\\", dot) != std::string::npos)
+            return {};
+
+        std::string extension = filePath.substr(dot);
+        for (char& character : extension)
+            character = static_cast<char>(std::tolower(static_cast<unsigned char>(character)));
+        return extension;
+    }
+}
+
+size_t CompressedImage::BlockSize(unsigned int format)
+{
+    switch (format)
+    {
+        case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_SIGNED_RED_RGTC1:
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:
+        case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+        case GL_COMPRESSED_R11_EAC:
+            return 8;
+        case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+        case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_SIGNED_RG_RGTC2:
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+        case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC:
+        case GL_COMPRESSED_RG11_EAC:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+size_t CompressedImage::LevelSize(unsigned int format, int width, int height)
+{
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * BlockSize(format);
+}
+
+bool CompressedImage::IsContainer(const std::string& filePath)
+{
+    std::string extension = CompressedData::Extension(filePath);
+    return extension == ".dds" || extension == ".ktx";
+}
+
+void CompressedImage::parseDds(const std::string& filePath, std::vector<uint8_t>& file)
+{
+    using namespace CompressedData::Dds;
+
+    Header header;
+    size_t offset = sizeof(Magic);
+    if (!CompressedData::Read(file, offset, header) || header.size != sizeof(Header))
+        throw std::runtime_error(fmt::format("kc::CompressedImage::parseDds(): File \"{}\" is corrupt", filePath));
+    offset += sizeof(Header);
+
+    if (!(header.pixelFormat.flags & Flags::FourCC))
+        throw std::runtime_error(fmt::format("kc::CompressedImage::parseDds(): File \"{}\" is not block compressed", filePath));
+
+    Header10 header10 = {};
+    bool extended = header.pixelFormat.fourCC == CompressedData::FourCC("DX10");
+    if (extended)
+    {
+        if (!CompressedData::Read(file, offset, header10) || header10.arraySize > 1)
+            throw std::runtime_error(fmt::format("kc::CompressedImage::parseDds(): File \"{}\" is corrupt or a texture array", filePath));
+        offset += sizeof(Header10);
+    }
+
+    m_format = 0;
+    for (const Format& format : Formats)
+    {
+        if (extended ? format.dxgiFormat == header10.dxgiFormat : format.fourCC == header.pixelFormat.fourCC)
+        {
+            m_format = format.format;
+            break;
+        }
+    }
+    if (!m_format)
+        throw std::runtime_error(fmt::format("kc::CompressedImage::parseDds(): File \"{}\" has unsupported format", filePath));
+
+    int width = static_cast<int>(header.width);
+    int height = static_cast<int>(header.height);
+    uint32_t levelCount = (header.flags & Flags::MipMapCount) ? std::max(header.mipMapCount, 1u) : 1;
+    for (uint32_t level = 0; level < levelCount && width && height; ++level)
+    {
+        size_t size = LevelSize(m_format, width, height);
+        if (offset > file.size() || size > file.size() - offset)
+            throw std::runtime_error(fmt::format("kc::CompressedImage::parseDds(): File \"{}\" is truncated", filePath));
+
+        m_levels.push_back({ width, height, offset, size });
+        offset += size;
+        width = std::max(width / 2, 1);
+        height = std::max(height / 2, 1);
+    }
+    m_data = std::move(file);
+}
+
+void CompressedImage::parseKtx(const std::string& filePath, std::vector<uint8_t>& file)
+{
+    using namespace CompressedData::Ktx;
+
+    Header header;
+    if (!CompressedData::Read(file, 0, header) || std::memcmp(header.identifier, Identifier, sizeof(Identifier)) || header.endianness != Endianness)
+        throw std::runtime_error(fmt::format("kc::CompressedImage::parseKtx(): File \"{}\" is corrupt or big-endian", filePath));
+
+    if (header.glType != 0 || header.pixelDepth > 1 || header.numberOfArrayElements > 0 || header.numberOfFaces != 1 || !BlockSize(header.glInternalFormat))
+        throw std::runtime_error(fmt::format("kc::CompressedImage::parseKtx(): File \"{}\" is not a supported compressed 2D texture", filePath));
+    m_format = header.glInternalFormat;
+
+    size_t offset = sizeof(Header) + header.bytesOfKeyValueData;
+    int width = static_cast<int>(header.pixelWidth);
+    int height = static_cast<int>(header.pixelHeight);
+    for (uint32_t level = 0; level < std::max(header.numberOfMipmapLevels, 1u) && width && height; ++level)
+    {
+        uint32_t size = 0;
+        if (!CompressedData::Read(file, offset, size) || size != LevelSize(m_format, width, height) || size > file.size() - offset - sizeof(size))
+            throw std::runtime_error(fmt::format("kc::CompressedImage::parseKtx(): File \"{}\" is truncated", filePath));
+        offset += sizeof(size);
+
+        m_levels.push_back({ width, height, offset, size });
+        offset += (size + 3) / 4 * 4;
+        width = std::max(width / 2, 1);
+        height = std::max(height / 2, 1);
+    }
+    m_data = std::move(file);
+}
+
+CompressedImage::CompressedImage(const std::string& filePath)
+    : m_format(0)
+{
+    std::ifstream stream(filePath, std::ios::binary);
+    if (!stream)
+        throw std::runtime_error(fmt::format("kc::CompressedImage::CompressedImage(): Couldn't open image file \"{}\"", filePath));
+    std::vector<uint8_t> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+    uint32_t magic = 0;
+    CompressedData::Read(file, 0, magic);
+    if (magic == CompressedData::Dds::Magic)
+        parseDds(filePath, file);
+    else
+        parseKtx(filePath, file);
+}
+
+CompressedImage::CompressedImage(unsigned int format)
+    : m_format(format)
+{
+    if (!BlockSize(format))
+        throw std::runtime_error(fmt::format("kc::CompressedImage::CompressedImage(): Unsupported format {:#x}", format));
+}
+
+void CompressedImage::append(int width, int height, const std::vector<uint8_t>& data)
+{
+    if (data.size() != LevelSize(m_format, width, height))
+        throw std::runtime_error(fmt::format("kc::CompressedImage::append(): Level {}x{} must be {} bytes", width, height, LevelSize(m_format, width, height)));
+
+    m_levels.push_back({ width, height, m_data.size(), data.size() });
+    m_data.insert(m_data.end(), data.begin(), data.end());
+}
+
+void CompressedImage::save(const std::string& filePath) const
+{
+    using namespace CompressedData::Dds;
+
+    const Format* format = nullptr;
+    for (const Format& entry : Formats)
+    {
+        if (entry.format == m_format)
+        {
+            format = &entry;
+            break;
+        }
+    }
+    if (!format || m_levels.empty())
+        throw std::runtime_error(fmt::format("kc::CompressedImage::save(): Format {:#x} or empty image can't be saved as DDS", m_format));
+
+    Header header = {};
+    header.size = sizeof(Header);
+    header.flags = Flags::Caps | Flags::Height | Flags::Width | Flags::PixelFormat | Flags::MipMapCount | Flags::LinearSize;
+    header.height = static_cast<uint32_t>(height());
+    header.width = static_cast<uint32_t>(width());
+    header.linearSize = static_cast<uint32_t>(m_levels.front().size);
+    header.mipMapCount = static_cast<uint32_t>(m_levels.size());
+    header.pixelFormat.size = sizeof(PixelFormat);
+    header.pixelFormat.flags = Flags::FourCC;
+    header.pixelFormat.fourCC = format->fourCC ? format->fourCC : CompressedData::FourCC("DX10");
+    header.caps[0] = Caps::Texture | (m_levels.size() > 1 ? Caps::Complex | Caps::MipMap : 0);
+
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file)
+        throw std::runtime_error(fmt::format("kc::CompressedImage::save(): Couldn't open file \"{}\"", filePath));
+
+    file.write(reinterpret_cast<const char*>(&Magic), sizeof(Magic));
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!format->fourCC)
+    {
+        Header10 header10 = { format->dxgiFormat, 3, 0, 1, 0 }; // 3 is D3D10_RESOURCE_DIMENSION_TEXTURE2D
+        file.write(reinterpret_cast<const char*>(&header10), sizeof(header10));
+    }
+    file.write(reinterpret_cast<const char*>(m_data.data()), m_data.size());
+
+    if (!file)
+        throw std::runtime_error(fmt::format("kc::CompressedImage::save(): Couldn't write file \"{}\"", filePath));
+}
+
+} // namespace kc
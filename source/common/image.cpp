@@ -8,12 +8,25 @@ Image::Image::Image(const std::string& imageFilePath, bool verticalFlip)
     , m_height(0)
     , m_channels(0)
 {
-    stbi_set_flip_vertically_on_load(verticalFlip);
+    // Flip flag is per thread, images may be decoded concurrently
+    stbi_set_flip_vertically_on_load_thread(verticalFlip);
     m_data = stbi_load(imageFilePath.c_str(), &m_width, &m_height, &m_channels, 0);
     if (!m_data)
         throw std::runtime_error(fmt::format("kc::Image::Image(): Couldn't open image file \"{}\"", imageFilePath));
 }
 
+Image::Image::Image(Image&& other) noexcept
+    : m_data(other.m_data)
+    , m_width(other.m_width)
+    , m_height(other.m_height)
+    , m_channels(other.m_channels)
+{
+    other.m_data = nullptr;
+    other.m_width = 0;
+    other.m_height = 0;
+    other.m_channels = 0;
+}
+
 Image::Image::~Image()
 {
     stbi_image_free(m_data);
@@ -0,0 +1,148 @@
+#include "common/job_system.hpp"
+using namespace kc::JobSystemConst;
+
+namespace kc {
+
+namespace JobSystemData
+{
+    struct Worker
+    {
+        const JobSystem* system = nullptr;
+        size_t queue = External;
+    };
+
+    /// @brief Pool and queue of calling thread, if it is a worker
+    thread_local Worker Current;
+}
+
+size_t JobSystem::queue() const
+{
+    return JobSystemData::Current.system == this ? JobSystemData::Current.queue : External;
+}
+
+bool JobSystem::take(size_t queue, const Counter* counter, Task& task)
+{
+    auto matches = [counter](const Task& candidate) { return !counter || candidate.counter == counter; };
+    {
+        Queue& own = *m_queues[queue];
+        std::lock_guard lock(own.mutex);
+        auto found = std::find_if(own.tasks.rbegin(), own.tasks.rend(), matches);
+        if (found != own.tasks.rend())
+        {
+            task = std::move(*found);
+            own.tasks.erase(std::next(found).base());
+            return true;
+        }
+    }
+
+    for (size_t offset = 1, size = m_queues.size(); offset < size; ++offset)
+    {
+        Queue& victim = *m_queues[(queue + offset) % size];
+        std::lock_guard lock(victim.mutex);
+        auto found = std::find_if(victim.tasks.begin(), victim.tasks.end(), matches);
+        if (found != victim.tasks.end())
+        {
+            task = std::move(*found);
+            victim.tasks.erase(found);
+            return true;
+        }
+    }
+    return false;
+}
+
+bool JobSystem::runOne(size_t queue, const Counter* counter)
+{
+    Task task;
+    if (!take(queue, counter, task))
+        return false;
+
+    --m_queued;
+    task.job();
+    task.counter->m_pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::work(size_t queue)
+{
+    JobSystemData::Current = { this, queue };
+    while (true)
+    {
+        if (runOne(queue))
+            continue;
+
+        std::unique_lock lock(m_sleepMutex);
+        m_sleepCondition.wait(lock, [this]() { return m_stopping || m_queued > 0; });
+        if (m_stopping)
+            return;
+    }
+}
+
+JobSystem::JobSystem(size_t workerCount)
+    : m_queued(0)
+    , m_stopping(false)
+{
+    for (size_t queue = 0; queue <= workerCount; ++queue)
+        m_queues.push_back(std::make_unique<Queue>());
+
+    m_workers.reserve(workerCount);
+    for (size_t worker = 0; worker < workerCount; ++worker)
+        m_workers.emplace_back(&JobSystem::work, this, worker + 1);
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard lock(m_sleepMutex);
+        m_stopping = true;
+    }
+    m_sleepCondition.notify_all();
+    for (std::thread& worker : m_workers)
+        worker.join();
+}
+
+void JobSystem::run(Counter& counter, Job&& job)
+{
+    counter.m_pending.fetch_add(1, std::memory_order_relaxed);
+    {
+        Queue& own = *m_queues[queue()];
+        std::lock_guard lock(own.mutex);
+        own.tasks.push_back({ std::move(job), &counter });
+    }
+
+    // Sleeping workers check the count under this mutex, so the wakeup can't slip between check and wait
+    ++m_queued;
+    {
+        std::lock_guard lock(m_sleepMutex);
+    }
+    m_sleepCondition.notify_one();
+}
+
+void JobSystem::wait(Counter& counter)
+{
+    // Waiting thread helps instead of blocking, so nested forks can't deadlock the pool.
+    // Every job of the fork is either still queued and run here, or already running on a thread that finishes it.
+    size_t own = queue();
+    while (!counter.done())
+    {
+        if (!runOne(own, &counter))
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::parallelFor(size_t count, size_t grain, const Range& body)
+{
+    grain = std::max<size_t>(grain, 1);
+    if (count <= grain || m_workers.empty())
+    {
+        for (size_t begin = 0; begin < count; begin += grain)
+            body(begin, std::min(begin + grain, count));
+        return;
+    }
+
+    Counter counter;
+    for (size_t begin = 0; begin < count; begin += grain)
+        run(counter, [&body, begin, end = std::min(begin + grain, count)]() { body(begin, end); });
+    wait(counter);
+}
+
+} // namespace kc
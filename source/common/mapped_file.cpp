@@ -0,0 +1,99 @@
+#include "common/mapped_file.hpp"
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace kc {
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& filePath)
+    : m_data(nullptr)
+    , m_size(0)
+    , m_file(INVALID_HANDLE_VALUE)
+    , m_mapping(nullptr)
+{
+    m_file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (m_file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error(fmt::format("kc::MappedFile::MappedFile(): Couldn't open file \"{}\"", filePath));
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_file, &size))
+    {
+        CloseHandle(m_file);
+        throw std::runtime_error(fmt::format("kc::MappedFile::MappedFile(): Couldn't get size of file \"{}\"", filePath));
+    }
+    m_size = static_cast<size_t>(size.QuadPart);
+    if (m_size == 0)
+        return;
+
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (m_mapping)
+        m_data = static_cast<const uint8_t*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_data)
+    {
+        if (m_mapping)
+            CloseHandle(m_mapping);
+        CloseHandle(m_file);
+        throw std::runtime_error(fmt::format("kc::MappedFile::MappedFile(): Couldn't map file \"{}\"", filePath));
+    }
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data)
+        UnmapViewOfFile(m_data);
+    if (m_mapping)
+        CloseHandle(m_mapping);
+    if (m_file != INVALID_HANDLE_VALUE)
+        CloseHandle(m_file);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& filePath)
+    : m_data(nullptr)
+    , m_size(0)
+{
+    int file = open(filePath.c_str(), O_RDONLY);
+    if (file == -1)
+        throw std::runtime_error(fmt::format("kc::MappedFile::MappedFile(): Couldn't open file \"{}\"", filePath));
+
+    struct stat status;
+    if (fstat(file, &status) == -1)
+    {
+        close(file);
+        throw std::runtime_error(fmt::format("kc::MappedFile::MappedFile(): Couldn't get size of file \"{}\"", filePath));
+    }
+    m_size = static_cast<size_t>(status.st_size);
+    if (m_size == 0)
+    {
+        close(file);
+        return;
+    }
+
+    // Mapping stays valid after the descriptor is closed
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED)
+        throw std::runtime_error(fmt::format("kc::MappedFile::MappedFile(): Couldn't map file \"{}\"", filePath));
+    m_data = static_cast<const uint8_t*>(data);
+}
+
+MappedFile::~MappedFile()
+{
+    if (m_data)
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+}
+
+#endif
+
+} // namespace kc
@@ -0,0 +1,245 @@
+#include "graphics/bvh.hpp"
+using namespace kc::Graphics::BvhConst;
+
+namespace kc {
+
+uint32_t Graphics::Bvh::buildNode(std::span<uint32_t> objects, std::span<const BoundingBox> boxes, uint32_t parent)
+{
+    uint32_t index = static_cast<uint32_t>(m_nodes.size());
+    m_nodes.push_back({ BoundingBox(), parent, Invalid, Invalid, Invalid });
+    if (objects.size() == 1)
+    {
+        m_nodes[index].box = boxes[objects[0]];
+        m_nodes[index].object = objects[0];
+        m_leaves[objects[0]] = index;
+        return index;
+    }
+
+    BoundingBox centers;
+    for (uint32_t object : objects)
+        centers.merge(boxes[object].center());
+    glm::vec3 extent = centers.maximum - centers.minimum;
+    int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+
+    size_t split = objects.size() / 2;
+    if (extent[axis] > 0.0f)
+    {
+        // Bin centers along the longest axis and take the cheapest split between bins
+        struct Bin
+        {
+            BoundingBox box;
+            size_t count = 0;
+        };
+        Bin bins[Bins];
+        float scale = Bins / extent[axis];
+        auto binOf = [&](uint32_t object)
+        {
+            return std::min(static_cast<size_t>((boxes[object].center()[axis] - centers.minimum[axis]) * scale), Bins - 1);
+        };
+        for (uint32_t object : objects)
+        {
+            Bin& bin = bins[binOf(object)];
+            bin.box.merge(boxes[object]);
+            ++bin.count;
+        }
+
+        float rightCosts[Bins] = {};
+        BoundingBox rightBox;
+        size_t rightCount = 0;
+        for (size_t bin = Bins - 1; bin > 0; --bin)
+        {
+            rightBox.merge(bins[bin].box);
+            rightCount += bins[bin].count;
+            rightCosts[bin] = rightCount ? rightBox.halfArea() * rightCount : 0.0f;
+        }
+
+        BoundingBox leftBox;
+        size_t leftCount = 0, bestBin = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        for (size_t bin = 1; bin < Bins; ++bin)
+        {
+            leftBox.merge(bins[bin - 1].box);
+            leftCount += bins[bin - 1].count;
+            float cost = (leftCount ? leftBox.halfArea() * leftCount : 0.0f) + rightCosts[bin];
+            if (leftCount && leftCount < objects.size() && cost < bestCost)
+            {
+                bestCost = cost;
+                bestBin = bin;
+            }
+        }
+
+        if (bestBin)
+            split = std::partition(objects.begin(), objects.end(), [&](uint32_t object) { return binOf(object) < bestBin; }) - objects.begin();
+    }
+    else
+    {
+        // Every center is the same, any even split is as good as another
+        std::nth_element(objects.begin(), objects.begin() + split, objects.end());
+    }
+
+    uint32_t left = buildNode(objects.first(split), boxes, index);
+    uint32_t right = buildNode(objects.subspan(split), boxes, index);
+    m_nodes[index].left = left;
+    m_nodes[index].right = right;
+    m_nodes[index].box = m_nodes[left].box;
+    m_nodes[index].box.merge(m_nodes[right].box);
+    return index;
+}
+
+void Graphics::Bvh::collect(uint32_t node, const Visitor& visitor) const
+{
+    size_t base = m_stack.size();
+    m_stack.push_back(node);
+    while (m_stack.size() > base)
+    {
+        const Node& current = m_nodes[m_stack.back()];
+        m_stack.pop_back();
+        if (current.object != Invalid)
+        {
+            visitor(current.object);
+            continue;
+        }
+
+        m_stack.push_back(current.right);
+        m_stack.push_back(current.left);
+    }
+}
+
+void Graphics::Bvh::build(std::span<const BoundingBox> boxes)
+{
+    m_nodes.clear();
+    m_leaves.assign(boxes.size(), Invalid);
+    if (boxes.empty())
+        return;
+
+    m_nodes.reserve(boxes.size() * 2 - 1);
+    std::vector<uint32_t> objects(boxes.size());
+    std::iota(objects.begin(), objects.end(), 0);
+    buildNode(objects, boxes, Invalid);
+}
+
+void Graphics::Bvh::update(uint32_t object, const BoundingBox& box)
+{
+    uint32_t node = m_leaves[object];
+    m_nodes[node].box = box;
+    for (node = m_nodes[node].parent; node != Invalid; node = m_nodes[node].parent)
+    {
+        BoundingBox refitted = m_nodes[m_nodes[node].left].box;
+        refitted.merge(m_nodes[m_nodes[node].right].box);
+        m_nodes[node].box = refitted;
+    }
+}
+
+void Graphics::Bvh::refit(std::span<const BoundingBox> boxes)
+{
+    // Children are always created after their parents, so reverse order visits them first
+    for (size_t index = m_nodes.size(); index-- > 0;)
+    {
+        Node& node = m_nodes[index];
+        if (node.object != Invalid)
+        {
+            node.box = boxes[node.object];
+            continue;
+        }
+
+        node.box = m_nodes[node.left].box;
+        node.box.merge(m_nodes[node.right].box);
+    }
+}
+
+size_t Graphics::Bvh::cull(const Frustum& frustum, const Visitor& visitor) const
+{
+    if (m_nodes.empty())
+        return 0;
+
+    size_t count = 0;
+    auto counted = [&](uint32_t object)
+    {
+        ++count;
+        visitor(object);
+    };
+
+    m_stack.clear();
+    m_stack.push_back(0);
+    while (!m_stack.empty())
+    {
+        uint32_t index = m_stack.back();
+        m_stack.pop_back();
+
+        bool inside = false;
+        const Node& node = m_nodes[index];
+        if (!frustum.intersects(node.box, inside))
+            continue;
+
+        // Nothing below a node that is completely inside needs testing
+        if (inside || node.object != Invalid)
+        {
+            collect(index, counted);
+            continue;
+        }
+
+        m_stack.push_back(node.right);
+        m_stack.push_back(node.left);
+    }
+    return count;
+}
+
+void Graphics::Bvh::query(const BoundingBox& box, const Visitor& visitor) const
+{
+    if (m_nodes.empty())
+        return;
+
+    m_stack.clear();
+    m_stack.push_back(0);
+    while (!m_stack.empty())
+    {
+        const Node& node = m_nodes[m_stack.back()];
+        m_stack.pop_back();
+        if (!node.box.intersects(box))
+            continue;
+
+        if (node.object != Invalid)
+        {
+            visitor(node.object);
+            continue;
+        }
+
+        m_stack.push_back(node.right);
+        m_stack.push_back(node.left);
+    }
+}
+
+uint32_t Graphics::Bvh::raycast(const glm::vec3& origin, const glm::vec3& direction, float& distance) const
+{
+    uint32_t result = Invalid;
+    distance = std::numeric_limits<float>::max();
+    if (m_nodes.empty())
+        return result;
+
+    glm::vec3 inverseDirection(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+    m_stack.clear();
+    m_stack.push_back(0);
+    while (!m_stack.empty())
+    {
+        const Node& node = m_nodes[m_stack.back()];
+        m_stack.pop_back();
+
+        // Boxes farther than the nearest hit so far can't hold a nearer one
+        float hit = node.box.intersect(origin, inverseDirection, distance);
+        if (hit < 0.0f)
+            continue;
+
+        if (node.object != Invalid)
+        {
+            distance = hit;
+            result = node.object;
+            continue;
+        }
+
+        m_stack.push_back(node.right);
+        m_stack.push_back(node.left);
+    }
+    return result;
+}
+
+} // namespace kc
@@ -18,6 +18,8 @@ float Graphics::Camera::MovementModeToSpeed(MovementMode mode)
 }
 
 Graphics::Camera::Camera()
+    : m_view(1.0f)
+    , m_projection(1.0f)
 {
     resetPosition();
 }
@@ -37,6 +39,15 @@ void Graphics::Camera::resetZoom()
     m_zoom = 1.0f;
 }
 
+void Graphics::Camera::lookAt(const glm::vec3& position, const glm::vec3& target)
+{
+    // Front is derived from angles on next update
+    glm::vec3 direction = glm::normalize(target - position);
+    m_position = position;
+    m_yaw = glm::degrees(std::atan2(direction.z, direction.x));
+    m_pitch = Utility::Limit(glm::degrees(std::asin(direction.y)), Pitch::Min, Pitch::Max);
+}
+
 void Graphics::Camera::keyPressed(Key key, MovementMode movementMode, float deltaTime)
 {
     switch (key)
@@ -73,7 +84,13 @@ void Graphics::Camera::mouseScrolled(int offset)
     m_zoom = Utility::Limit(m_zoom += offset * Sensivity::Scroll * m_zoom, Zoom::Min, Zoom::Max);
 }
 
-void Graphics::Camera::capture(const std::vector<std::reference_wrapper<ShaderProgram>>& shaderPrograms, unsigned int width, unsigned int height)
+void Graphics::Camera::capture(StreamBuffer& stream, unsigned int width, unsigned int height)
+{
+    update(width, height);
+    upload(stream);
+}
+
+void Graphics::Camera::update(unsigned int width, unsigned int height)
 {
     glm::vec3 direction(
         std::cos(glm::radians(m_yaw)) * std::cos(glm::radians(m_pitch)),
@@ -82,15 +99,18 @@ void Graphics::Camera::capture(const std::vector<std::reference_wrapper<ShaderPr
     );
     m_front = glm::normalize(direction);
 
-    glm::mat4 view(1.0f), projection(1.0f);
-    view = glm::lookAt(m_position, m_position + m_front, m_up);
-    projection = glm::perspective(glm::radians(45.0f / m_zoom), static_cast<float>(width) / height, Perspective::Near, Perspective::Far);
-    for (ShaderProgram& shaderProgram : shaderPrograms)
-    {
-        shaderProgram.use();
-        shaderProgram.set("View", view);
-        shaderProgram.set("Projection", projection);
-    }
+    m_view = glm::lookAt(m_position, m_position + m_front, m_up);
+    m_projection = glm::perspective(glm::radians(45.0f / m_zoom), static_cast<float>(width) / height, Perspective::Near, Perspective::Far);
+    m_frustum = Frustum(m_projection * m_view);
+}
+
+void Graphics::Camera::upload(StreamBuffer& stream) const
+{
+    UniformBlocks::Frame frame;
+    frame.view = m_view;
+    frame.projection = m_projection;
+    frame.cameraPosition = glm::vec4(m_position, 1.0f);
+    stream.upload(UniformBuffer::Binding::Frame, frame);
 }
 
 } // namespace kc
@@ -75,23 +75,18 @@ namespace Data
     };
 }
 
-Graphics::Cube::Cube()
-    : Cube({}, {}, {})
-{}
-
-Graphics::Cube::Cube(const Transform& transform, Color color, const Material& material)
-    : m_vertexArrayObject(0)
-    , m_vertexBufferObject(0)
-    , m_elementBufferObject(0)
-    , m_transform(transform)
-    , m_color(color)
-    , m_material(material)
+std::shared_ptr<const Graphics::Cube::Objects> Graphics::Cube::SharedObjects()
 {
-    glGenVertexArrays(1, &m_vertexArrayObject);
-    glBindVertexArray(m_vertexArrayObject);
+    static std::weak_ptr<const Objects> sharedObjects;
+    if (std::shared_ptr<const Objects> objects = sharedObjects.lock())
+        return objects;
 
-    glGenBuffers(1, &m_vertexBufferObject);
-    glBindBuffer(GL_ARRAY_BUFFER, m_vertexBufferObject);
+    Objects* objects = new Objects;
+    glGenVertexArrays(1, &objects->vertexArray);
+    StateCache::BindVertexArray(objects->vertexArray);
+
+    glGenBuffers(1, &objects->vertexBuffer);
+    StateCache::BindBuffer(GL_ARRAY_BUFFER, objects->vertexBuffer);
     glBufferData(GL_ARRAY_BUFFER, sizeof(Data::Vertices), Data::Vertices, GL_STATIC_DRAW);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, reinterpret_cast<void*>(0));
     glEnableVertexAttribArray(0);
@@ -100,37 +95,87 @@ Graphics::Cube::Cube(const Transform& transform, Color color, const Material& ma
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 8, reinterpret_cast<void*>(sizeof(float) * 6));
     glEnableVertexAttribArray(2);
 
-    glGenBuffers(1, &m_elementBufferObject);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementBufferObject);
+    glGenBuffers(1, &objects->elementBuffer);
+    StateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, objects->elementBuffer);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Data::Indices), Data::Indices, GL_STATIC_DRAW);
+
+    std::shared_ptr<const Objects> result(objects, [](const Objects* objects)
+    {
+        StateCache::ForgetBuffer(objects->elementBuffer);
+        glDeleteBuffers(1, &objects->elementBuffer);
+        StateCache::ForgetBuffer(objects->vertexBuffer);
+        glDeleteBuffers(1, &objects->vertexBuffer);
+        StateCache::ForgetVertexArray(objects->vertexArray);
+        glDeleteVertexArrays(1, &objects->vertexArray);
+        delete objects;
+    });
+    sharedObjects = result;
+    return result;
 }
 
-Graphics::Cube::~Cube()
+Graphics::Cube::Cube()
+    : Cube({}, {}, {})
+{}
+
+Graphics::Cube::Cube(const Transform& transform, Color color, const Material& material)
+    : m_objects(SharedObjects())
+    , m_transform(transform)
+    , m_color(color)
+    , m_material(material)
+{}
+
+void Graphics::Cube::draw(ShaderProgram& shaderProgram, const Camera& camera, StreamBuffer& stream) const
 {
-    glDeleteBuffers(1, &m_elementBufferObject);
-    glDeleteBuffers(1, &m_vertexBufferObject);
-    glDeleteVertexArrays(1, &m_vertexArrayObject);
+    draw(shaderProgram, camera, stream, glm::mat4(1.0f));
 }
 
-void Graphics::Cube::draw(ShaderProgram& shaderProgram) const
+void Graphics::Cube::draw(ShaderProgram& shaderProgram, const Camera& camera, StreamBuffer& stream, const glm::mat4& parent) const
 {
     // Transform
-    // TODO: Rotate model around a single axis rather than three
-    glm::mat4 model(1.0f);
-    model = glm::translate(model, m_transform.position);
-    model = glm::rotate(model, glm::radians(m_transform.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    model = glm::rotate(model, glm::radians(m_transform.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    model = glm::rotate(model, glm::radians(m_transform.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-    model = glm::scale(model, m_transform.scale);
-    shaderProgram.set("Model", model);
+    glm::mat4 model = parent * m_transform.matrix();
+    if (!camera.frustum().visible(boundingSphere().transformed(model)))
+        return;
+    stream.upload(UniformBuffer::Binding::Object, UniformBlocks::MakeObject(camera.view() * model));
 
     // Set color and material
     shaderProgram.set("ObjectColor", m_color);
     shaderProgram.set("Material", m_material);
 
     // Draw
-    glBindVertexArray(m_vertexArrayObject);
-    glDrawElements(GL_TRIANGLES, sizeof(Data::Indices), GL_UNSIGNED_INT, 0);
+    StateCache::BindVertexArray(m_objects->vertexArray);
+    glDrawElements(GL_TRIANGLES, std::size(Data::Indices), GL_UNSIGNED_INT, 0);
+}
+
+Graphics::RenderQueue::Packet* Graphics::Cube::submit(RenderQueue& queue, ShaderProgram& shaderProgram, const Camera& camera, const glm::mat4& parent, unsigned int condition) const
+{
+    glm::mat4 model = parent * m_transform.matrix();
+    if (!camera.frustum().visible(boundingSphere().transformed(model)))
+        return nullptr;
+
+    glm::mat4 modelView = camera.view() * model;
+    return &queue.submit({ &shaderProgram, m_objects->vertexArray, 0, condition, -modelView[3].z, RenderQueue::Layer::Opaque, UniformBlocks::MakeObject(modelView),
+        [this](ShaderProgram& shaderProgram)
+        {
+            shaderProgram.set("ObjectColor", m_color);
+            shaderProgram.set("Material", m_material);
+            glDrawElements(GL_TRIANGLES, std::size(Data::Indices), GL_UNSIGNED_INT, 0);
+        }
+    });
+}
+
+void Graphics::Cube::drawGeometry(ShaderProgram& shaderProgram, const glm::mat4& modelView, StreamBuffer& stream) const
+{
+    stream.upload(UniformBuffer::Binding::Object, UniformBlocks::MakeObject(modelView));
+    StateCache::BindVertexArray(m_objects->vertexArray);
+    glDrawElements(GL_TRIANGLES, std::size(Data::Indices), GL_UNSIGNED_INT, 0);
+}
+
+void Graphics::Cube::drawInstanced(ShaderProgram& shaderProgram, const InstanceBuffer& instances) const
+{
+    shaderProgram.set("Material", m_material);
+    instances.attach(m_objects->vertexArray);
+    glDrawElementsInstanced(GL_TRIANGLES, std::size(Data::Indices), GL_UNSIGNED_INT, 0, static_cast<int>(instances.count()));
+    instances.detach(m_objects->vertexArray);
 }
 
 } // namespace kc
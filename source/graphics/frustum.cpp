@@ -0,0 +1,102 @@
+#include "graphics/frustum.hpp"
+using namespace kc::Graphics::FrustumConst;
+
+namespace kc {
+
+Graphics::Frustum::Frustum()
+    : m_x{}
+    , m_y{}
+    , m_z{}
+    , m_w{}
+{}
+
+Graphics::Frustum::Frustum(const glm::mat4& viewProjection)
+{
+    // Gribb-Hartmann: planes are sums and differences of the last row with the others
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        for (int side = 0; side < 2; ++side)
+        {
+            float sign = side == 0 ? 1.0f : -1.0f;
+            glm::vec4 plane(
+                viewProjection[0][3] + sign * viewProjection[0][axis],
+                viewProjection[1][3] + sign * viewProjection[1][axis],
+                viewProjection[2][3] + sign * viewProjection[2][axis],
+                viewProjection[3][3] + sign * viewProjection[3][axis]
+            );
+
+            // Normalized planes give true distances, so sphere radius can be compared directly
+            float length = glm::length(glm::vec3(plane));
+            size_t index = axis * 2 + side;
+            m_x[index] = plane.x / length;
+            m_y[index] = plane.y / length;
+            m_z[index] = plane.z / length;
+            m_w[index] = plane.w / length;
+        }
+    }
+}
+
+bool Graphics::Frustum::visible(const BoundingSphere& sphere) const
+{
+    uint8_t result = 0;
+    cull({ &sphere, 1 }, { &result, 1 });
+    return result;
+}
+
+bool Graphics::Frustum::intersects(const BoundingBox& box, bool& inside) const
+{
+    // Corner farthest along plane normal decides if box is outside, the nearest one if it is inside
+    inside = true;
+    for (size_t plane = 0; plane < 6; ++plane)
+    {
+        glm::vec3 farthest(m_x[plane] >= 0.0f ? box.maximum.x : box.minimum.x, m_y[plane] >= 0.0f ? box.maximum.y : box.minimum.y, m_z[plane] >= 0.0f ? box.maximum.z : box.minimum.z);
+        if (m_x[plane] * farthest.x + m_y[plane] * farthest.y + m_z[plane] * farthest.z + m_w[plane] < 0.0f)
+            return false;
+
+        glm::vec3 nearest(m_x[plane] >= 0.0f ? box.minimum.x : box.maximum.x, m_y[plane] >= 0.0f ? box.minimum.y : box.maximum.y, m_z[plane] >= 0.0f ? box.minimum.z : box.maximum.z);
+        if (m_x[plane] * nearest.x + m_y[plane] * nearest.y + m_z[plane] * nearest.z + m_w[plane] < 0.0f)
+            inside = false;
+    }
+    return true;
+}
+
+size_t Graphics::Frustum::cull(std::span<const BoundingSphere> spheres, std::span<uint8_t> visible) const
+{
+    // Spheres are transposed into component arrays block by block, so the lane loop over a fixed
+    // block vectorizes even with the cheap cost model of -O2. Padding lanes repeat the last sphere.
+    size_t count = 0;
+    for (size_t first = 0, size = spheres.size(); first < size; first += Lanes)
+    {
+        size_t lanes = std::min(Lanes, size - first);
+        float x[Lanes], y[Lanes], z[Lanes], radius[Lanes];
+        for (size_t lane = 0; lane < Lanes; ++lane)
+        {
+            const BoundingSphere& sphere = spheres[first + std::min(lane, lanes - 1)];
+            x[lane] = sphere.center.x;
+            y[lane] = sphere.center.y;
+            z[lane] = sphere.center.z;
+            radius[lane] = -sphere.radius;
+        }
+
+        int inside[Lanes];
+        for (size_t lane = 0; lane < Lanes; ++lane)
+            inside[lane] = 1;
+        for (size_t plane = 0; plane < 6; ++plane)
+        {
+            float planeX = m_x[plane], planeY = m_y[plane], planeZ = m_z[plane], planeW = m_w[plane];
+            for (size_t lane = 0; lane < Lanes; ++lane)
+                inside[lane] &= planeX * x[lane] + planeY * y[lane] + planeZ * z[lane] + planeW >= radius[lane];
+        }
+
+        for (size_t lane = 0; lane < lanes; ++lane)
+        {
+            visible[first + lane] = static_cast<uint8_t>(inside[lane]);
+            count += inside[lane];
+        }
+    }
+
+    this->count(count, spheres.size() - count);
+    return count;
+}
+
+} // namespace kc
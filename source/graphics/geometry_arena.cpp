@@ -0,0 +1,340 @@
+#include "graphics/geometry_arena.hpp"
+
+namespace kc {
+
+namespace GeometryArenaData
+{
+    struct CompactVertex
+    {
+        glm::vec3 position;
+        uint32_t normal;            // GL_INT_2_10_10_10_REV
+        uint16_t texCoords[2];      // GL_HALF_FLOAT
+    };
+    static_assert(sizeof(CompactVertex) == 20, "Compact vertex must be tightly packed");
+
+    struct QuantizedVertex
+    {
+        uint16_t position[4];       // normalized inside arena bounds, last one is padding
+        uint32_t normal;            // GL_INT_2_10_10_10_REV
+        uint16_t texCoords[2];      // GL_HALF_FLOAT
+    };
+    static_assert(sizeof(QuantizedVertex) == 16, "Quantized vertex must be tightly packed");
+
+    /// @brief Smallest quantization bounds extent, keeps flat meshes invertible
+    constexpr float MinimumExtent = 1e-6f;
+
+    /// @brief Index buffer offsets are kept aligned for 32-bit indices
+    constexpr size_t IndexAlignment = sizeof(Graphics::Indice);
+}
+
+void Graphics::GeometryArena::Batch::add(const Range& range)
+{
+    counts.push_back(static_cast<GLsizei>(range.indexCount));
+    offsets.push_back(reinterpret_cast<void*>(range.indexOffset));
+    baseVertices.push_back(range.baseVertex);
+}
+
+void Graphics::GeometryArena::Batch::clear()
+{
+    counts.clear();
+    offsets.clear();
+    baseVertices.clear();
+}
+
+size_t Graphics::GeometryArena::Stride(VertexFormat format)
+{
+    switch (format)
+    {
+        case VertexFormat::Compact:
+            return sizeof(GeometryArenaData::CompactVertex);
+        case VertexFormat::Quantized:
+            return sizeof(GeometryArenaData::QuantizedVertex);
+        default:
+            return sizeof(Vertex);
+    }
+}
+
+void Graphics::GeometryArena::free()
+{
+    if (m_elementBuffer)
+    {
+        StateCache::ForgetBuffer(m_elementBuffer);
+        glDeleteBuffers(1, &m_elementBuffer);
+        m_elementBuffer = 0;
+    }
+
+    if (m_vertexBuffer)
+    {
+        StateCache::ForgetBuffer(m_vertexBuffer);
+        glDeleteBuffers(1, &m_vertexBuffer);
+        m_vertexBuffer = 0;
+    }
+
+    if (m_vertexArray)
+    {
+        StateCache::ForgetVertexArray(m_vertexArray);
+        glDeleteVertexArrays(1, &m_vertexArray);
+        m_vertexArray = 0;
+    }
+
+    m_vertexCapacity = 0;
+    m_indexCapacity = 0;
+    m_vertexCount = 0;
+    m_indexSize = 0;
+}
+
+void Graphics::GeometryArena::Grow(unsigned int& buffer, size_t usedBytes, size_t capacityBytes)
+{
+    // Copy targets don't touch vertex array state
+    unsigned int grown = 0;
+    glGenBuffers(1, &grown);
+    StateCache::BindBuffer(GL_COPY_WRITE_BUFFER, grown);
+    glBufferData(GL_COPY_WRITE_BUFFER, capacityBytes, nullptr, GL_STATIC_DRAW);
+    if (usedBytes)
+    {
+        StateCache::BindBuffer(GL_COPY_READ_BUFFER, buffer);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedBytes);
+    }
+
+    StateCache::ForgetBuffer(buffer);
+    glDeleteBuffers(1, &buffer);
+    buffer = grown;
+}
+
+void Graphics::GeometryArena::attach()
+{
+    StateCache::BindVertexArray(m_vertexArray);
+    StateCache::BindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    switch (m_format)
+    {
+        case VertexFormat::Compact:
+        {
+            using GeometryArenaData::CompactVertex;
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(CompactVertex), reinterpret_cast<void*>(offsetof(CompactVertex, position)));
+            glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(CompactVertex), reinterpret_cast<void*>(offsetof(CompactVertex, normal)));
+            glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(CompactVertex), reinterpret_cast<void*>(offsetof(CompactVertex, texCoords)));
+            break;
+        }
+        case VertexFormat::Quantized:
+        {
+            using GeometryArenaData::QuantizedVertex;
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(QuantizedVertex), reinterpret_cast<void*>(offsetof(QuantizedVertex, position)));
+            glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(QuantizedVertex), reinterpret_cast<void*>(offsetof(QuantizedVertex, normal)));
+            glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(QuantizedVertex), reinterpret_cast<void*>(offsetof(QuantizedVertex, texCoords)));
+            break;
+        }
+        default:
+        {
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, position)));
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, normal)));
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, texCoords)));
+            break;
+        }
+    }
+
+    glEnableVertexAttribArray(0);
+    glEnableVertexAttribArray(1);
+    glEnableVertexAttribArray(2);
+    StateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementBuffer);
+}
+
+void Graphics::GeometryArena::reserve(size_t vertexCount, size_t indexSize)
+{
+    size_t stride = Stride(m_format);
+    bool grown = false;
+    if (m_vertexCount + vertexCount > m_vertexCapacity)
+    {
+        size_t capacity = std::max(m_vertexCount + vertexCount, m_vertexCapacity * 2);
+        Grow(m_vertexBuffer, m_vertexCount * stride, capacity * stride);
+        m_vertexCapacity = capacity;
+        grown = true;
+    }
+
+    if (m_indexSize + indexSize > m_indexCapacity)
+    {
+        size_t capacity = std::max(m_indexSize + indexSize, m_indexCapacity * 2);
+        Grow(m_elementBuffer, m_indexSize, capacity);
+        m_indexCapacity = capacity;
+        grown = true;
+    }
+
+    // Vertex array keeps its name, so meshes never notice the arena has moved
+    if (grown)
+        attach();
+}
+
+std::vector<std::byte> Graphics::GeometryArena::pack(std::span<const Vertex> vertices) const
+{
+    std::vector<std::byte> packed(vertices.size() * Stride(m_format));
+    switch (m_format)
+    {
+        case VertexFormat::Compact:
+        {
+            auto output = reinterpret_cast<GeometryArenaData::CompactVertex*>(packed.data());
+            for (size_t index = 0, size = vertices.size(); index < size; ++index)
+            {
+                output[index].position = vertices[index].position;
+                output[index].normal = glm::packSnorm3x10_1x2(glm::vec4(vertices[index].normal, 0.0f));
+                output[index].texCoords[0] = glm::packHalf1x16(vertices[index].texCoords.x);
+                output[index].texCoords[1] = glm::packHalf1x16(vertices[index].texCoords.y);
+            }
+            break;
+        }
+        case VertexFormat::Quantized:
+        {
+            auto output = reinterpret_cast<GeometryArenaData::QuantizedVertex*>(packed.data());
+            for (size_t index = 0, size = vertices.size(); index < size; ++index)
+            {
+                glm::vec3 position = glm::clamp((vertices[index].position - m_minimum) / m_extent, 0.0f, 1.0f);
+                uint64_t quantized = glm::packUnorm4x16(glm::vec4(position, 0.0f));
+                std::memcpy(output[index].position, &quantized, sizeof(output[index].position));
+                output[index].normal = glm::packSnorm3x10_1x2(glm::vec4(vertices[index].normal, 0.0f));
+                output[index].texCoords[0] = glm::packHalf1x16(vertices[index].texCoords.x);
+                output[index].texCoords[1] = glm::packHalf1x16(vertices[index].texCoords.y);
+            }
+            break;
+        }
+        default:
+            std::memcpy(packed.data(), vertices.data(), vertices.size_bytes());
+            break;
+    }
+    return packed;
+}
+
+Graphics::GeometryArena::GeometryArena()
+    : m_vertexArray(0)
+    , m_vertexBuffer(0)
+    , m_elementBuffer(0)
+    , m_format(VertexFormat::Full)
+    , m_minimum(0.0f)
+    , m_extent(1.0f)
+    , m_vertexCapacity(0)
+    , m_indexCapacity(0)
+    , m_vertexCount(0)
+    , m_indexSize(0)
+{}
+
+Graphics::GeometryArena::GeometryArena(GeometryArena&& other) noexcept
+    : m_vertexArray(other.m_vertexArray)
+    , m_vertexBuffer(other.m_vertexBuffer)
+    , m_elementBuffer(other.m_elementBuffer)
+    , m_format(other.m_format)
+    , m_minimum(other.m_minimum)
+    , m_extent(other.m_extent)
+    , m_vertexCapacity(other.m_vertexCapacity)
+    , m_indexCapacity(other.m_indexCapacity)
+    , m_vertexCount(other.m_vertexCount)
+    , m_indexSize(other.m_indexSize)
+{
+    other.m_vertexArray = 0;
+    other.m_vertexBuffer = 0;
+    other.m_elementBuffer = 0;
+    other.m_vertexCapacity = 0;
+    other.m_indexCapacity = 0;
+    other.m_vertexCount = 0;
+    other.m_indexSize = 0;
+}
+
+Graphics::GeometryArena::~GeometryArena()
+{
+    free();
+}
+
+void Graphics::GeometryArena::create(size_t vertexCapacity, size_t indexCapacity, VertexFormat format, const glm::vec3& minimum, const glm::vec3& maximum)
+{
+    free(); // avoid memory leaks if create() was called already
+    m_format = format;
+    m_minimum = minimum;
+    m_extent = glm::max(maximum - minimum, glm::vec3(GeometryArenaData::MinimumExtent));
+
+    glGenVertexArrays(1, &m_vertexArray);
+    glGenBuffers(1, &m_vertexBuffer);
+    glGenBuffers(1, &m_elementBuffer);
+
+    StateCache::BindBuffer(GL_COPY_WRITE_BUFFER, m_vertexBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, vertexCapacity * Stride(m_format), nullptr, GL_STATIC_DRAW);
+    StateCache::BindBuffer(GL_COPY_WRITE_BUFFER, m_elementBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, indexCapacity * sizeof(Indice), nullptr, GL_STATIC_DRAW);
+    m_vertexCapacity = vertexCapacity;
+    m_indexCapacity = indexCapacity * sizeof(Indice);
+    attach();
+}
+
+size_t Graphics::GeometryArena::appendIndices(std::span<const Indice> indices, unsigned int indexType, size_t vertexCount)
+{
+    std::vector<uint16_t> shortIndexData;
+    const void* indexData = indices.data();
+    size_t indexSize = indices.size_bytes();
+    if (indexType == GL_UNSIGNED_SHORT)
+    {
+        shortIndexData.assign(indices.begin(), indices.end());
+        indexData = shortIndexData.data();
+        indexSize = shortIndexData.size() * sizeof(uint16_t);
+    }
+
+    size_t alignment = GeometryArenaData::IndexAlignment;
+    size_t indexOffset = (m_indexSize + alignment - 1) / alignment * alignment;
+    reserve(vertexCount, indexOffset - m_indexSize + indexSize);
+
+    StateCache::BindBuffer(GL_COPY_WRITE_BUFFER, m_elementBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, indexOffset, indexSize, indexData);
+    m_indexSize = indexOffset + indexSize;
+    return indexOffset;
+}
+
+Graphics::GeometryArena::Range Graphics::GeometryArena::allocate(std::span<const Vertex> vertices, std::span<const Indice> indices)
+{
+    if (!m_vertexArray)
+        throw std::runtime_error("kc::Graphics::GeometryArena::allocate(): Arena is not created");
+
+    // Indices are relative to the mesh, so a small mesh fits 16 bits wherever it lands in the arena
+    unsigned int indexType = vertices.size() <= std::numeric_limits<uint16_t>::max() + size_t(1) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+    size_t indexOffset = appendIndices(indices, indexType, vertices.size());
+    Range range = { static_cast<int>(m_vertexCount), indexOffset, indices.size(), indexType };
+
+    std::vector<std::byte> packed = pack(vertices);
+    StateCache::BindBuffer(GL_COPY_WRITE_BUFFER, m_vertexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, m_vertexCount * Stride(m_format), packed.size(), packed.data());
+    m_vertexCount += vertices.size();
+    return range;
+}
+
+Graphics::GeometryArena::Range Graphics::GeometryArena::allocateIndices(const Range& base, std::span<const Indice> indices)
+{
+    if (!m_vertexArray)
+        throw std::runtime_error("kc::Graphics::GeometryArena::allocateIndices(): Arena is not created");
+
+    size_t indexOffset = appendIndices(indices, base.indexType, 0);
+    return { base.baseVertex, indexOffset, indices.size(), base.indexType };
+}
+
+void Graphics::GeometryArena::bind() const
+{
+    StateCache::BindVertexArray(m_vertexArray);
+}
+
+void Graphics::GeometryArena::draw(const Range& range) const
+{
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(range.indexCount), range.indexType,
+        reinterpret_cast<void*>(range.indexOffset), range.baseVertex);
+}
+
+void Graphics::GeometryArena::draw(const Batch& batch) const
+{
+    if (batch.counts.empty())
+        return;
+
+    // Older GLEW headers declare non-const pointers here
+    glMultiDrawElementsBaseVertex(GL_TRIANGLES, batch.counts.data(), batch.indexType,
+        const_cast<void**>(batch.offsets.data()), static_cast<GLsizei>(batch.counts.size()), const_cast<GLint*>(batch.baseVertices.data()));
+}
+
+glm::mat4 Graphics::GeometryArena::dequantization() const
+{
+    if (m_format != VertexFormat::Quantized)
+        return glm::mat4(1.0f);
+
+    return glm::scale(glm::translate(glm::mat4(1.0f), m_minimum), m_extent);
+}
+
+} // namespace kc
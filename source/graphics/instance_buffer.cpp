@@ -0,0 +1,48 @@
+#include "graphics/instance_buffer.hpp"
+using namespace kc::Graphics::InstanceBufferConst;
+
+namespace kc {
+
+Graphics::InstanceBuffer::InstanceBuffer()
+    : m_buffer(0)
+    , m_offset(0)
+    , m_count(0)
+{}
+
+void Graphics::InstanceBuffer::upload(StreamBuffer& stream, std::span<const InstanceRecord> records)
+{
+    // Written once per frame into the ring, the draws still reading older frames never stall us
+    m_buffer = stream.id();
+    m_offset = records.empty() ? 0 : stream.write(records.data(), records.size_bytes(), alignof(InstanceRecord));
+    m_count = records.size();
+}
+
+void Graphics::InstanceBuffer::attach(unsigned int vertexArray) const
+{
+    // Attribute pointers are vertex array state, the same mesh may be drawn from several buffers
+    StateCache::BindVertexArray(vertexArray);
+    StateCache::BindBuffer(GL_ARRAY_BUFFER, m_buffer);
+    for (unsigned int column = 0; column < 4; ++column)
+    {
+        size_t offset = m_offset + offsetof(InstanceRecord, model) + sizeof(glm::vec4) * column;
+        glVertexAttribPointer(Attributes::Model + column, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceRecord), reinterpret_cast<void*>(offset));
+        glEnableVertexAttribArray(Attributes::Model + column);
+        glVertexAttribDivisor(Attributes::Model + column, 1);
+    }
+
+    glVertexAttribPointer(Attributes::Color, 4, GL_FLOAT, GL_FALSE, sizeof(InstanceRecord), reinterpret_cast<void*>(m_offset + offsetof(InstanceRecord, color)));
+    glEnableVertexAttribArray(Attributes::Color);
+    glVertexAttribDivisor(Attributes::Color, 1);
+}
+
+void Graphics::InstanceBuffer::detach(unsigned int vertexArray) const
+{
+    StateCache::BindVertexArray(vertexArray);
+    for (unsigned int attribute = Attributes::Model; attribute <= Attributes::Color; ++attribute)
+    {
+        glDisableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 0);
+    }
+}
+
+} // namespace kc
@@ -7,17 +7,25 @@ Graphics::Lighting::DirectionalLight::DirectionalLight(const glm::vec3 direction
     , m_direction(direction)
 {}
 
-void Graphics::Lighting::DirectionalLight::draw(ShaderProgram& shaderProgram, ShaderProgram& lightShaderProgram)
+void Graphics::Lighting::DirectionalLight::illuminate(UniformBlocks::Lights& lights, const Camera& camera) const
 {
-    // Illuminate to shader program
-    shaderProgram.set("DirectionalLight.color", m_color);
-    shaderProgram.set("DirectionalLight.properties", m_properties);
-    shaderProgram.set("DirectionalLight.direction", m_direction);
+    lights.directionalLight.color = UniformBlocks::Pack(m_color);
+    lights.directionalLight.properties = UniformBlocks::Pack(m_properties);
+    lights.directionalLight.direction = camera.view() * glm::vec4(m_direction, 0.0f);
+    lights.directionalLightEnabled = 1;
+}
 
-    // Render to light shader program
+void Graphics::Lighting::DirectionalLight::draw(ShaderProgram& lightShaderProgram, const Camera& camera, StreamBuffer& stream)
+{
     lightShaderProgram.set("LightColor", m_color);
     m_body.transform().position = m_direction * -50.0f;
-    m_body.draw(lightShaderProgram);
+    m_body.draw(lightShaderProgram, camera, stream);
+}
+
+void Graphics::Lighting::DirectionalLight::submit(RenderQueue& queue, ShaderProgram& lightShaderProgram, const Camera& camera)
+{
+    m_body.transform().position = m_direction * -50.0f;
+    submitBody(queue, m_body, lightShaderProgram, camera);
 }
 
 } // namespace kc
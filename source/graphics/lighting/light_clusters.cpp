@@ -0,0 +1,330 @@
+#include "graphics/lighting/light_clusters.hpp"
+using namespace kc::Graphics::Lighting::LightClustersConst;
+
+namespace kc {
+
+namespace ClusterData
+{
+    constexpr float Near = Graphics::CameraConst::Perspective::Near;
+    constexpr float Far = Graphics::CameraConst::Perspective::Far;
+
+    /// @brief Get view depth at which depth slice starts
+    /// @param slice Depth slice index
+    /// @return View depth
+    float SliceDepth(unsigned int slice)
+    {
+        return Near * std::pow(Far / Near, static_cast<float>(slice) / Grid::Z);
+    }
+
+    /// @brief Get depth slice containing view depth
+    /// @param depth View depth
+    /// @param scale Depth slice scale and bias
+    /// @return Depth slice index
+    unsigned int DepthSlice(float depth, const glm::vec4& scale)
+    {
+        float slice = std::log(depth) * scale.z - scale.w;
+        return static_cast<unsigned int>(Utility::Limit(slice, 0.0, Grid::Z - 1));
+    }
+
+    /// @brief Get tile containing normalized device coordinate
+    /// @param ndc Normalized device coordinate
+    /// @param count Number of tiles along the axis
+    /// @return Tile index
+    unsigned int Tile(float ndc, unsigned int count)
+    {
+        return static_cast<unsigned int>(Utility::Limit(std::floor((ndc * 0.5f + 0.5f) * count), 0.0, count - 1));
+    }
+}
+
+float Graphics::Lighting::LightClusters::InfluenceRadius(const LightRecord& record)
+{
+    float intensity = std::max({ record.color.x, record.color.y, record.color.z })
+        * std::max({ record.properties.x, record.properties.y, record.properties.z });
+    float constant = record.attenuation.x - intensity / InfluenceThreshold;
+    float linear = record.attenuation.y;
+    float quadratic = record.attenuation.z;
+    if (constant >= 0.0f)
+        return 0.0f;
+
+    // Solve quadratic * d^2 + linear * d + constant = 0 for the positive root
+    if (quadratic > 0.0f)
+        return (-linear + std::sqrt(linear * linear - 4.0f * quadratic * constant)) / (2.0f * quadratic);
+    if (linear > 0.0f)
+        return -constant / linear;
+    return ClusterData::Far;
+}
+
+Graphics::Lighting::LightClusters::Buffer Graphics::Lighting::LightClusters::CreateBuffer(int format)
+{
+    Buffer buffer;
+    glGenBuffers(1, &buffer.buffer);
+    StateCache::BindBuffer(GL_TEXTURE_BUFFER, buffer.buffer);
+    glBufferData(GL_TEXTURE_BUFFER, sizeof(glm::vec4), nullptr, GL_STREAM_DRAW);
+
+    glGenTextures(1, &buffer.texture);
+    StateCache::BindTextureBuffer(0, buffer.texture);
+    glTexBuffer(GL_TEXTURE_BUFFER, format, buffer.buffer);
+    return buffer;
+}
+
+void Graphics::Lighting::LightClusters::UploadBuffer(const Buffer& buffer, const void* data, size_t size)
+{
+    // Zero sized buffer textures are not allowed, keep at least one texel
+    StateCache::BindBuffer(GL_TEXTURE_BUFFER, buffer.buffer);
+    glBufferData(GL_TEXTURE_BUFFER, std::max(size, sizeof(glm::vec4)), nullptr, GL_STREAM_DRAW);
+    if (size)
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, size, data);
+}
+
+void Graphics::Lighting::LightClusters::free()
+{
+    for (Buffer* buffer : { &m_lightData, &m_clusterGrid, &m_lightIndices })
+    {
+        if (buffer->texture)
+        {
+            StateCache::ForgetTexture(buffer->texture);
+            glDeleteTextures(1, &buffer->texture);
+            buffer->texture = 0;
+        }
+
+        if (buffer->buffer)
+        {
+            StateCache::ForgetBuffer(buffer->buffer);
+            glDeleteBuffers(1, &buffer->buffer);
+            buffer->buffer = 0;
+        }
+    }
+}
+
+void Graphics::Lighting::LightClusters::updateBounds(const Camera& camera, unsigned int width, unsigned int height)
+{
+    const glm::mat4& projection = camera.projection();
+    if (!m_clusterBounds.empty() && projection == m_boundsProjection && width == m_boundsWidth && height == m_boundsHeight)
+        return;
+
+    m_boundsProjection = projection;
+    m_boundsWidth = width;
+    m_boundsHeight = height;
+
+    float logRatio = std::log(ClusterData::Far / ClusterData::Near);
+    m_scale = glm::vec4(
+        static_cast<float>(width) / Grid::X,
+        static_cast<float>(height) / Grid::Y,
+        Grid::Z / logRatio,
+        Grid::Z * std::log(ClusterData::Near) / logRatio
+    );
+
+    // Symmetric perspective projection: view x = ndc x * depth / P[0][0]
+    m_clusterBounds.resize(Grid::Size);
+    for (unsigned int z = 0; z < Grid::Z; ++z)
+    {
+        float depths[2] = { ClusterData::SliceDepth(z), ClusterData::SliceDepth(z + 1) };
+        for (unsigned int y = 0; y < Grid::Y; ++y)
+        {
+            float ndcY[2] = { -1.0f + 2.0f * y / Grid::Y, -1.0f + 2.0f * (y + 1) / Grid::Y };
+            for (unsigned int x = 0; x < Grid::X; ++x)
+            {
+                float ndcX[2] = { -1.0f + 2.0f * x / Grid::X, -1.0f + 2.0f * (x + 1) / Grid::X };
+                Bounds& bounds = m_clusterBounds[x + y * Grid::X + z * Grid::X * Grid::Y];
+                bounds.min = glm::vec3(std::numeric_limits<float>::max());
+                bounds.max = glm::vec3(std::numeric_limits<float>::lowest());
+                for (float depth : depths)
+                {
+                    for (float cornerX : ndcX)
+                    {
+                        for (float cornerY : ndcY)
+                        {
+                            glm::vec3 corner(cornerX * depth / projection[0][0], cornerY * depth / projection[1][1], -depth);
+                            bounds.min = glm::min(bounds.min, corner);
+                            bounds.max = glm::max(bounds.max, corner);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+bool Graphics::Lighting::LightClusters::lightRange(const LightRecord& record, const Camera& camera, Range& range) const
+{
+    glm::vec3 center(record.position);
+    float radius = record.position.w;
+    float minDepth = -center.z - radius, maxDepth = -center.z + radius;
+    if (radius <= 0.0f || maxDepth < ClusterData::Near || minDepth > ClusterData::Far)
+        return false;
+    minDepth = std::max(minDepth, ClusterData::Near);
+    maxDepth = std::min(maxDepth, ClusterData::Far);
+
+    range.z[0] = ClusterData::DepthSlice(minDepth, m_scale);
+    range.z[1] = ClusterData::DepthSlice(maxDepth, m_scale);
+
+    // Screen extents of sphere bounding box lie at its corners
+    const glm::mat4& projection = camera.projection();
+    float ndcMin[2] = { std::numeric_limits<float>::max(), std::numeric_limits<float>::max() };
+    float ndcMax[2] = { std::numeric_limits<float>::lowest(), std::numeric_limits<float>::lowest() };
+    for (float depth : { minDepth, maxDepth })
+    {
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            for (float coordinate : { center[axis] - radius, center[axis] + radius })
+            {
+                float ndc = projection[axis][axis] * coordinate / depth;
+                ndcMin[axis] = std::min(ndcMin[axis], ndc);
+                ndcMax[axis] = std::max(ndcMax[axis], ndc);
+            }
+        }
+    }
+
+    if (ndcMax[0] < -1.0f || ndcMin[0] > 1.0f || ndcMax[1] < -1.0f || ndcMin[1] > 1.0f)
+        return false;
+    range.x[0] = ClusterData::Tile(ndcMin[0], Grid::X);
+    range.x[1] = ClusterData::Tile(ndcMax[0], Grid::X);
+    range.y[0] = ClusterData::Tile(ndcMin[1], Grid::Y);
+    range.y[1] = ClusterData::Tile(ndcMax[1], Grid::Y);
+    return true;
+}
+
+void Graphics::Lighting::LightClusters::assign(const std::vector<Range>& ranges, unsigned int firstSlice, unsigned int lastSlice, std::vector<uint32_t>& indices)
+{
+    std::vector<uint32_t> sliceLights;
+    sliceLights.reserve(m_lights.size());
+    for (unsigned int z = firstSlice; z < lastSlice; ++z)
+    {
+        sliceLights.clear();
+        for (uint32_t light = 0, size = static_cast<uint32_t>(m_lights.size()); light < size; ++light)
+        {
+            if (ranges[light].z[0] <= z && z <= ranges[light].z[1])
+                sliceLights.push_back(light);
+        }
+
+        for (unsigned int y = 0; y < Grid::Y; ++y)
+        {
+            for (unsigned int x = 0; x < Grid::X; ++x)
+            {
+                size_t cluster = x + y * Grid::X + z * Grid::X * Grid::Y;
+                const Bounds& bounds = m_clusterBounds[cluster];
+                uint32_t offset = static_cast<uint32_t>(indices.size());
+                for (uint32_t light : sliceLights)
+                {
+                    const Range& range = ranges[light];
+                    if (x < range.x[0] || x > range.x[1] || y < range.y[0] || y > range.y[1])
+                        continue;
+
+                    // Sphere to box test
+                    glm::vec3 center(m_lights[light].position);
+                    glm::vec3 closest = glm::clamp(center, bounds.min, bounds.max);
+                    glm::vec3 offsetToCenter = center - closest;
+                    float radius = m_lights[light].position.w;
+                    if (glm::dot(offsetToCenter, offsetToCenter) <= radius * radius)
+                        indices.push_back(light);
+                }
+                m_grid[cluster] = glm::uvec2(offset, static_cast<uint32_t>(indices.size()) - offset);
+            }
+        }
+    }
+}
+
+Graphics::Lighting::LightClusters::LightClusters()
+    : m_lightData({ 0, 0 })
+    , m_clusterGrid({ 0, 0 })
+    , m_lightIndices({ 0, 0 })
+    , m_boundsProjection(1.0f)
+    , m_boundsWidth(0)
+    , m_boundsHeight(0)
+    , m_scale(0.0f)
+{}
+
+Graphics::Lighting::LightClusters::~LightClusters()
+{
+    free();
+}
+
+void Graphics::Lighting::LightClusters::create()
+{
+    free(); // avoid memory leaks if create() was called already
+    m_lightData = CreateBuffer(GL_RGBA32F);
+    m_clusterGrid = CreateBuffer(GL_RG32UI);
+    m_lightIndices = CreateBuffer(GL_R32UI);
+    m_grid.resize(Grid::Size);
+}
+
+void Graphics::Lighting::LightClusters::clear()
+{
+    m_lights.clear();
+}
+
+void Graphics::Lighting::LightClusters::add(const PointLight& light, const Camera& camera)
+{
+    LightRecord& record = m_lights.emplace_back();
+    light.illuminate(record, camera);
+    record.position.w = InfluenceRadius(record);
+}
+
+void Graphics::Lighting::LightClusters::add(const SpotLight& light, const Camera& camera)
+{
+    LightRecord& record = m_lights.emplace_back();
+    light.illuminate(record, camera);
+    record.position.w = InfluenceRadius(record);
+}
+
+void Graphics::Lighting::LightClusters::build(const Camera& camera, unsigned int width, unsigned int height, JobSystem* jobs)
+{
+    updateBounds(camera, width, height);
+
+    // Lights that touch no clusters get an empty range
+    std::vector<Range> ranges(m_lights.size());
+    for (size_t light = 0, size = m_lights.size(); light < size; ++light)
+    {
+        if (!lightRange(m_lights[light], camera, ranges[light]))
+            ranges[light] = { { 1, 0 }, { 1, 0 }, { 1, 0 } };
+    }
+
+    m_indices.clear();
+    if (!jobs || !jobs->workers() || m_lights.size() < ParallelThreshold)
+    {
+        assign(ranges, 0, Grid::Z, m_indices);
+    }
+    else
+    {
+        // Every job fills its own depth slice, offsets are made global afterwards
+        m_sliceIndices.resize(Grid::Z);
+        jobs->parallelFor(Grid::Z, 1, [this, &ranges](size_t begin, size_t end)
+        {
+            for (size_t slice = begin; slice < end; ++slice)
+            {
+                m_sliceIndices[slice].clear();
+                assign(ranges, static_cast<unsigned int>(slice), static_cast<unsigned int>(slice + 1), m_sliceIndices[slice]);
+            }
+        });
+
+        for (unsigned int slice = 0; slice < Grid::Z; ++slice)
+        {
+            uint32_t base = static_cast<uint32_t>(m_indices.size());
+            for (size_t cluster = slice * Grid::X * Grid::Y; cluster < (slice + 1) * Grid::X * Grid::Y; ++cluster)
+                m_grid[cluster].x += base;
+            m_indices.insert(m_indices.end(), m_sliceIndices[slice].begin(), m_sliceIndices[slice].end());
+        }
+    }
+
+    UploadBuffer(m_lightData, m_lights.data(), m_lights.size() * sizeof(LightRecord));
+    UploadBuffer(m_clusterGrid, m_grid.data(), m_grid.size() * sizeof(glm::uvec2));
+    UploadBuffer(m_lightIndices, m_indices.data(), m_indices.size() * sizeof(uint32_t));
+}
+
+void Graphics::Lighting::LightClusters::illuminate(UniformBlocks::Lights& lights) const
+{
+    lights.clusterScale = m_scale;
+    lights.clusterCount = glm::uvec4(Grid::X, Grid::Y, Grid::Z, static_cast<unsigned int>(m_lights.size()));
+}
+
+void Graphics::Lighting::LightClusters::bind(ShaderProgram& shaderProgram) const
+{
+    StateCache::BindTextureBuffer(Units::LightData, m_lightData.texture);
+    StateCache::BindTextureBuffer(Units::ClusterGrid, m_clusterGrid.texture);
+    StateCache::BindTextureBuffer(Units::LightIndices, m_lightIndices.texture);
+    shaderProgram.set("LightData", static_cast<int>(Units::LightData));
+    shaderProgram.set("ClusterGrid", static_cast<int>(Units::ClusterGrid));
+    shaderProgram.set("LightIndices", static_cast<int>(Units::LightIndices));
+}
+
+} // namespace kc
@@ -7,17 +7,25 @@ Graphics::Lighting::PointLight::PointLight(const Transform& transform, Color col
     , m_body(transform, color, {})
 {}
 
-void Graphics::Lighting::PointLight::draw(ShaderProgram& shaderProgram, ShaderProgram& lightShaderProgram)
+void Graphics::Lighting::PointLight::illuminate(LightRecord& record, const Camera& camera) const
 {
-    // Illuminate to shader program
-    shaderProgram.set("PointLight.color", m_color);
-    shaderProgram.set("PointLight.attenuation", m_attenuation);
-    shaderProgram.set("PointLight.properties", m_properties);
-    shaderProgram.set("PointLight.position", m_body.transform().position);
+    record.position = camera.view() * glm::vec4(m_body.transform().position, 1.0f);
+    record.color = UniformBlocks::Pack(m_color);
+    record.color.w = static_cast<float>(LightRecord::Type::Point);
+    record.attenuation = UniformBlocks::Pack(m_attenuation);
+    record.properties = UniformBlocks::Pack(m_properties);
+    record.direction = glm::vec4(0.0f);
+}
 
-    // Render to light shader program
+void Graphics::Lighting::PointLight::draw(ShaderProgram& lightShaderProgram, const Camera& camera, StreamBuffer& stream)
+{
     lightShaderProgram.set("LightColor", m_color);
-    m_body.draw(lightShaderProgram);
+    m_body.draw(lightShaderProgram, camera, stream);
+}
+
+void Graphics::Lighting::PointLight::submit(RenderQueue& queue, ShaderProgram& lightShaderProgram, const Camera& camera)
+{
+    submitBody(queue, m_body, lightShaderProgram, camera);
 }
 
 } // namespace kc
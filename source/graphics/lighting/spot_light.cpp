@@ -9,19 +9,28 @@ Graphics::Lighting::SpotLight::SpotLight(const Transform& transform, const glm::
     , m_body(transform, color, {})
 {}
 
-void Graphics::Lighting::SpotLight::draw(ShaderProgram& shaderProgram, ShaderProgram& lightShaderProgram) const
+void Graphics::Lighting::SpotLight::illuminate(LightRecord& record, const Camera& camera) const
 {
-    // Illuminate to shader program
-    shaderProgram.set("SpotLight.color", m_color);
-    shaderProgram.set("SpotLight.attenuation", m_attenuation);
-    shaderProgram.set("SpotLight.cutoff", m_cutoff);
-    shaderProgram.set("SpotLight.properties", m_properties);
-    shaderProgram.set("SpotLight.position", m_body.transform().position);
-    shaderProgram.set("SpotLight.direction", m_direction);
+    glm::vec4 cutoff = UniformBlocks::Pack(m_cutoff);
+    record.position = camera.view() * glm::vec4(m_body.transform().position, 1.0f);
+    record.color = UniformBlocks::Pack(m_color);
+    record.color.w = static_cast<float>(LightRecord::Type::Spot);
+    record.attenuation = UniformBlocks::Pack(m_attenuation);
+    record.attenuation.w = cutoff.y;
+    record.properties = UniformBlocks::Pack(m_properties);
+    record.properties.w = cutoff.x;
+    record.direction = camera.view() * glm::vec4(m_direction, 0.0f);
+}
 
-    // Render to light shader program
+void Graphics::Lighting::SpotLight::draw(ShaderProgram& lightShaderProgram, const Camera& camera, StreamBuffer& stream) const
+{
     lightShaderProgram.set("LightColor", m_color);
-    m_body.draw(lightShaderProgram);
+    m_body.draw(lightShaderProgram, camera, stream);
+}
+
+void Graphics::Lighting::SpotLight::submit(RenderQueue& queue, ShaderProgram& lightShaderProgram, const Camera& camera) const
+{
+    submitBody(queue, m_body, lightShaderProgram, camera);
 }
 
 } // namespace kc
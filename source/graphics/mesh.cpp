@@ -2,15 +2,15 @@
 
 namespace kc {
 
-Graphics::Mesh::Objects Graphics::Mesh::CreateMesh(const std::vector<Vertex>& vertices, const std::vector<Indice>& indices)
+Graphics::Mesh::Objects Graphics::Mesh::CreateMesh(std::span<const Vertex> vertices, std::span<const Indice> indices)
 {
     Objects objects;
     glGenVertexArrays(1, &objects.vertexArray);
-    glBindVertexArray(objects.vertexArray);
+    StateCache::BindVertexArray(objects.vertexArray);
 
     glGenBuffers(1, &objects.vertexBuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, objects.vertexBuffer);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+    StateCache::BindBuffer(GL_ARRAY_BUFFER, objects.vertexBuffer);
+    glBufferData(GL_ARRAY_BUFFER, vertices.size_bytes(), vertices.data(), GL_STATIC_DRAW);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(0));
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, normal)));
@@ -19,8 +19,8 @@ Graphics::Mesh::Objects Graphics::Mesh::CreateMesh(const std::vector<Vertex>& ve
     glEnableVertexAttribArray(2);
 
     glGenBuffers(1, &objects.elementBuffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, objects.elementBuffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(Indice) * indices.size(), indices.data(), GL_STATIC_DRAW);
+    StateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, objects.elementBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size_bytes(), indices.data(), GL_STATIC_DRAW);
     return objects;
 }
 
@@ -28,35 +28,56 @@ void Graphics::Mesh::free()
 {
     if (m_objects.elementBuffer)
     {
+        StateCache::ForgetBuffer(m_objects.elementBuffer);
         glDeleteBuffers(1, &m_objects.elementBuffer);
         m_objects.elementBuffer = 0;
     }
 
     if (m_objects.vertexBuffer)
     {
+        StateCache::ForgetBuffer(m_objects.vertexBuffer);
         glDeleteBuffers(1, &m_objects.vertexBuffer);
         m_objects.vertexBuffer = 0;
     }
 
     if (m_objects.vertexArray)
     {
+        StateCache::ForgetVertexArray(m_objects.vertexArray);
         glDeleteVertexArrays(1, &m_objects.vertexArray);
         m_objects.vertexArray = 0;
     }
+
+    m_arena = nullptr;
+    m_range = { 0, 0, 0, GL_UNSIGNED_INT };
+    m_lods.clear();
 }
 
 Graphics::Mesh::Mesh()
     : m_objects({ 0, 0, 0 })
+    , m_arena(nullptr)
+    , m_range({ 0, 0, 0, GL_UNSIGNED_INT })
+    , m_minimum(0.0f)
+    , m_maximum(0.0f)
 {}
 
 Graphics::Mesh::Mesh(Mesh&& other) noexcept
     : m_objects(other.m_objects)
-    , m_vertices(other.m_vertices)
-    , m_indices(other.m_indices)
-    , m_textures(other.m_textures)
+    , m_arena(other.m_arena)
+    , m_range(other.m_range)
+    , m_lods(std::move(other.m_lods))
+    , m_minimum(other.m_minimum)
+    , m_maximum(other.m_maximum)
+    , m_vertices(std::move(other.m_vertices))
+    , m_positions(std::move(other.m_positions))
+    , m_indices(std::move(other.m_indices))
+    , m_textures(std::move(other.m_textures))
 {
     other.m_objects = { 0, 0, 0 };
+    other.m_arena = nullptr;
+    other.m_range = { 0, 0, 0, GL_UNSIGNED_INT };
+    other.m_lods.clear();
     other.m_vertices.clear();
+    other.m_positions.clear();
     other.m_indices.clear();
     other.m_textures.clear();
 }
@@ -66,38 +87,114 @@ Graphics::Mesh::~Mesh()
     free();
 }
 
+void Graphics::Mesh::retain(std::span<const Vertex> vertices, std::span<const Indice> indices, Residency residency)
+{
+    // Bounds survive every policy, culling and placement don't need anything else
+    m_minimum = glm::vec3(std::numeric_limits<float>::max());
+    m_maximum = glm::vec3(std::numeric_limits<float>::lowest());
+    for (const Vertex& vertex : vertices)
+    {
+        m_minimum = glm::min(m_minimum, vertex.position);
+        m_maximum = glm::max(m_maximum, vertex.position);
+    }
+    if (vertices.empty())
+        m_minimum = m_maximum = glm::vec3(0.0f);
+
+    // Spans may point into own vectors, so build copies before replacing them
+    std::vector<Vertex> keptVertices;
+    std::vector<glm::vec3> keptPositions;
+    std::vector<Indice> keptIndices;
+    switch (residency)
+    {
+        case Residency::Keep:
+            keptVertices.assign(vertices.begin(), vertices.end());
+            keptIndices.assign(indices.begin(), indices.end());
+            break;
+        case Residency::Compact:
+            keptPositions.reserve(vertices.size());
+            for (const Vertex& vertex : vertices)
+                keptPositions.push_back(vertex.position);
+            keptIndices.assign(indices.begin(), indices.end());
+            break;
+        case Residency::Discard:
+            break;
+    }
+
+    m_vertices = std::move(keptVertices);
+    m_positions = std::move(keptPositions);
+    m_indices = std::move(keptIndices);
+}
+
 void Graphics::Mesh::create()
 {
     free(); // avoid memory leaks if load() was called already
     m_objects = CreateMesh(m_vertices, m_indices);
+    m_range = { 0, 0, m_indices.size(), GL_UNSIGNED_INT };
+    retain(m_vertices, m_indices, Residency::Keep);
 }
 
-void Graphics::Mesh::draw(ShaderProgram& shaderProgram) const
+void Graphics::Mesh::create(std::span<const Vertex> vertices, std::span<const Indice> indices, Residency residency)
+{
+    free(); // avoid memory leaks if load() was called already
+    m_objects = CreateMesh(vertices, indices);
+    m_range = { 0, 0, indices.size(), GL_UNSIGNED_INT };
+    retain(vertices, indices, residency);
+}
+
+void Graphics::Mesh::create(GeometryArena& arena, std::span<const Vertex> vertices, std::span<const Indice> indices, Residency residency)
 {
+    free(); // avoid memory leaks if load() was called already
+    m_arena = &arena;
+    m_range = arena.allocate(vertices, indices);
+    retain(vertices, indices, residency);
+}
+
+void Graphics::Mesh::addLod(std::span<const Indice> indices)
+{
+    if (!m_arena)
+        throw std::runtime_error("kc::Graphics::Mesh::addLod(): Detail levels need mesh created inside geometry arena");
+
+    m_lods.push_back(m_arena->allocateIndices(m_range, indices));
+}
+
+void Graphics::Mesh::bindTextures(ShaderProgram& shaderProgram) const
+{
+    ShaderProgram::UniformHandle diffuseHandle = shaderProgram.uniform("Material.diffuse");
+    ShaderProgram::UniformHandle specularHandle = shaderProgram.uniform("Material.specular");
     for (size_t index = 0, size = m_textures.size(); index < size; ++index)
     {
-        std::string uniformName;
+        ShaderProgram::UniformHandle handle = ShaderProgram::InvalidHandle;
         switch (m_textures[index]->type())
         {
             case Texture::Type::Diffuse:
-                uniformName = "Material.diffuse";
+                handle = diffuseHandle;
                 break;
             case Texture::Type::Specular:
-                uniformName = "Material.specular";
+                handle = specularHandle;
                 break;
             default:
                 // Unknown texture! Can't set anything...
                 continue;
         }
 
-        glActiveTexture(GL_TEXTURE0 + index);
-        shaderProgram.set(uniformName, static_cast<int>(index));
-        glBindTexture(GL_TEXTURE_2D, m_textures[index]->id());
+        StateCache::BindTexture(index, m_textures[index]->id());
+        shaderProgram.set(handle, static_cast<int>(index));
     }
+}
 
-    glBindVertexArray(m_objects.vertexArray);
-    glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, 0);
-    glBindVertexArray(0);
+void Graphics::Mesh::draw(ShaderProgram& shaderProgram) const
+{
+    bindTextures(shaderProgram);
+    StateCache::BindVertexArray(vertexArray());
+    glDrawElementsBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(m_range.indexCount), m_range.indexType,
+        reinterpret_cast<void*>(m_range.indexOffset), m_range.baseVertex);
+}
+
+void Graphics::Mesh::drawInstanced(ShaderProgram& shaderProgram, size_t count) const
+{
+    bindTextures(shaderProgram);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, static_cast<GLsizei>(m_range.indexCount), m_range.indexType,
+        reinterpret_cast<void*>(m_range.indexOffset), static_cast<GLsizei>(count), m_range.baseVertex);
 }
 
 } // namespace kc
@@ -0,0 +1,202 @@
+#include "graphics/mesh_cache.hpp"
+using namespace kc::Graphics::MeshCacheConst;
+
+namespace kc {
+
+namespace CacheData
+{
+    /// @brief Round offset up to blob alignment
+    /// @param offset The offset to align
+    /// @return Aligned offset
+    uint64_t Align(uint64_t offset)
+    {
+        return (offset + Alignment - 1) / Alignment * Alignment;
+    }
+
+    /// @brief Write padding up to blob alignment
+    /// @param file The file to write to
+    void Pad(std::ofstream& file)
+    {
+        static constexpr char Zeros[Alignment] = {};
+        uint64_t position = static_cast<uint64_t>(file.tellp());
+        file.write(Zeros, Align(position) - position);
+    }
+}
+
+uint64_t Graphics::MeshCache::Hash(const uint8_t* data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t index = 0; index < size; ++index)
+    {
+        hash ^= data[index];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+uint64_t Graphics::MeshCache::HashFile(const std::string& filePath)
+{
+    MappedFile file(filePath);
+    return Hash(file.data(), file.size());
+}
+
+Graphics::MeshCache::SourceStamp Graphics::MeshCache::Stamp(const std::string& sourceFilePath)
+{
+    std::error_code error;
+    SourceStamp stamp = {};
+    stamp.size = std::filesystem::file_size(sourceFilePath, error);
+    if (error)
+        throw std::runtime_error(fmt::format("kc::Graphics::MeshCache::Stamp(): Couldn't stat source file \"{}\"", sourceFilePath));
+    stamp.time = std::filesystem::last_write_time(sourceFilePath, error).time_since_epoch().count();
+    return stamp;
+}
+
+void Graphics::MeshCache::Write(const std::string& cacheFilePath, const std::string& sourceFilePath, const std::vector<Entry>& entries)
+{
+    Header header = {};
+    std::memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    header.meshCount = static_cast<uint32_t>(entries.size());
+    header.source = Stamp(sourceFilePath);
+    header.source.hash = HashFile(sourceFilePath);
+    header.vertexSize = sizeof(Mesh::Vertex);
+
+    // Lay out tables first, then filenames, then vertex and index blobs
+    std::vector<MeshRecord> meshes(entries.size());
+    std::vector<TextureRecord> textures;
+    std::vector<LodRecord> lods;
+    uint64_t offset = CacheData::Align(sizeof(Header));
+    offset = CacheData::Align(offset + sizeof(MeshRecord) * meshes.size());
+    for (const Entry& entry : entries)
+    {
+        header.textureCount += static_cast<uint32_t>(entry.textures.size());
+        header.lodCount += static_cast<uint32_t>(entry.lods.size());
+    }
+    textures.reserve(header.textureCount);
+    lods.reserve(header.lodCount);
+    offset = CacheData::Align(offset + sizeof(TextureRecord) * header.textureCount);
+    offset = CacheData::Align(offset + sizeof(LodRecord) * header.lodCount);
+
+    for (size_t index = 0; index < entries.size(); ++index)
+    {
+        meshes[index].firstTexture = static_cast<uint32_t>(textures.size());
+        meshes[index].textureCount = static_cast<uint32_t>(entries[index].textures.size());
+        for (const TextureReference& texture : entries[index].textures)
+        {
+            textures.push_back({ offset, static_cast<uint32_t>(texture.filename.size()), static_cast<uint32_t>(texture.type) });
+            offset += texture.filename.size();
+        }
+    }
+    offset = CacheData::Align(offset);
+
+    for (size_t index = 0; index < entries.size(); ++index)
+    {
+        meshes[index].vertexOffset = offset;
+        meshes[index].vertexCount = static_cast<uint32_t>(entries[index].vertices.size());
+        offset = CacheData::Align(offset + entries[index].vertices.size_bytes());
+        meshes[index].indexOffset = offset;
+        meshes[index].indexCount = static_cast<uint32_t>(entries[index].indices.size());
+        offset = CacheData::Align(offset + entries[index].indices.size_bytes());
+
+        meshes[index].firstLod = static_cast<uint32_t>(lods.size());
+        meshes[index].lodCount = static_cast<uint32_t>(entries[index].lods.size());
+        for (std::span<const Mesh::Indice> lod : entries[index].lods)
+        {
+            lods.push_back({ offset, static_cast<uint32_t>(lod.size()), 0 });
+            offset = CacheData::Align(offset + lod.size_bytes());
+        }
+    }
+
+    // Write to temporary file so that a failed write never leaves a valid-looking cache
+    std::string temporaryFilePath = cacheFilePath + ".tmp";
+    {
+        std::ofstream file(temporaryFilePath, std::ios::binary | std::ios::trunc);
+        if (!file)
+            throw std::runtime_error(fmt::format("kc::Graphics::MeshCache::Write(): Couldn't open file \"{}\"", temporaryFilePath));
+
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        CacheData::Pad(file);
+        file.write(reinterpret_cast<const char*>(meshes.data()), sizeof(MeshRecord) * meshes.size());
+        CacheData::Pad(file);
+        file.write(reinterpret_cast<const char*>(textures.data()), sizeof(TextureRecord) * textures.size());
+        CacheData::Pad(file);
+        file.write(reinterpret_cast<const char*>(lods.data()), sizeof(LodRecord) * lods.size());
+        CacheData::Pad(file);
+        for (const Entry& entry : entries)
+        {
+            for (const TextureReference& texture : entry.textures)
+                file.write(texture.filename.data(), texture.filename.size());
+        }
+        CacheData::Pad(file);
+        for (const Entry& entry : entries)
+        {
+            file.write(reinterpret_cast<const char*>(entry.vertices.data()), entry.vertices.size_bytes());
+            CacheData::Pad(file);
+            file.write(reinterpret_cast<const char*>(entry.indices.data()), entry.indices.size_bytes());
+            CacheData::Pad(file);
+            for (std::span<const Mesh::Indice> lod : entry.lods)
+            {
+                file.write(reinterpret_cast<const char*>(lod.data()), lod.size_bytes());
+                CacheData::Pad(file);
+            }
+        }
+
+        if (!file)
+            throw std::runtime_error(fmt::format("kc::Graphics::MeshCache::Write(): Couldn't write file \"{}\"", temporaryFilePath));
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporaryFilePath, cacheFilePath, error);
+    if (error)
+    {
+        std::filesystem::remove(temporaryFilePath, error);
+        throw std::runtime_error(fmt::format("kc::Graphics::MeshCache::Write(): Couldn't replace file \"{}\"", cacheFilePath));
+    }
+}
+
+Graphics::MeshCache::MeshCache(const std::string& cacheFilePath, const std::string& sourceFilePath)
+    : m_file(cacheFilePath)
+{
+    const Header& header = *at<Header>(0, 1);
+    if (std::memcmp(header.magic, Magic, sizeof(Magic)) || header.version != Version || header.vertexSize != sizeof(Mesh::Vertex))
+        throw std::runtime_error(fmt::format("kc::Graphics::MeshCache::MeshCache(): File \"{}\" is not a mesh cache of current version", cacheFilePath));
+
+    // Modification time changes on checkout or copy, fall back to hashing the source then
+    SourceStamp source = Stamp(sourceFilePath);
+    if (source.size != header.source.size || (source.time != header.source.time && HashFile(sourceFilePath) != header.source.hash))
+        throw std::runtime_error(fmt::format("kc::Graphics::MeshCache::MeshCache(): Cache \"{}\" is stale", cacheFilePath));
+
+    uint64_t offset = CacheData::Align(sizeof(Header));
+    const MeshRecord* meshes = at<MeshRecord>(offset, header.meshCount);
+    offset = CacheData::Align(offset + sizeof(MeshRecord) * header.meshCount);
+    const TextureRecord* textures = at<TextureRecord>(offset, header.textureCount);
+    offset = CacheData::Align(offset + sizeof(TextureRecord) * header.textureCount);
+    const LodRecord* lods = at<LodRecord>(offset, header.lodCount);
+
+    m_entries.resize(header.meshCount);
+    for (uint32_t index = 0; index < header.meshCount; ++index)
+    {
+        const MeshRecord& mesh = meshes[index];
+        Entry& entry = m_entries[index];
+        entry.vertices = { at<Mesh::Vertex>(mesh.vertexOffset, mesh.vertexCount), mesh.vertexCount };
+        entry.indices = { at<Mesh::Indice>(mesh.indexOffset, mesh.indexCount), mesh.indexCount };
+
+        if (mesh.firstLod > header.lodCount || mesh.lodCount > header.lodCount - mesh.firstLod)
+            throw std::runtime_error(fmt::format("kc::Graphics::MeshCache::MeshCache(): File \"{}\" is corrupt", cacheFilePath));
+        entry.lods.reserve(mesh.lodCount);
+        for (uint32_t lodIndex = mesh.firstLod; lodIndex < mesh.firstLod + mesh.lodCount; ++lodIndex)
+            entry.lods.emplace_back(at<Mesh::Indice>(lods[lodIndex].indexOffset, lods[lodIndex].indexCount), lods[lodIndex].indexCount);
+
+        if (mesh.firstTexture > header.textureCount || mesh.textureCount > header.textureCount - mesh.firstTexture)
+            throw std::runtime_error(fmt::format("kc::Graphics::MeshCache::MeshCache(): File \"{}\" is corrupt", cacheFilePath));
+        entry.textures.reserve(mesh.textureCount);
+        for (uint32_t textureIndex = mesh.firstTexture; textureIndex < mesh.firstTexture + mesh.textureCount; ++textureIndex)
+        {
+            const TextureRecord& texture = textures[textureIndex];
+            const char* filename = at<char>(texture.filenameOffset, texture.filenameLength);
+            entry.textures.push_back({ static_cast<Texture::Type>(texture.type), std::string(filename, texture.filenameLength) });
+        }
+    }
+}
+
+} // namespace kc
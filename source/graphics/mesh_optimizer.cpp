@@ -0,0 +1,584 @@
+#include "graphics/mesh_optimizer.hpp"
+using namespace kc::Graphics::MeshOptimizerConst;
+
+namespace kc {
+
+namespace MeshOptimizerData
+{
+    struct VertexHash
+    {
+        inline size_t operator()(const Graphics::Vertex& vertex) const
+        {
+            // FNV-1a over raw bytes, welding is bitwise anyway
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&vertex);
+            size_t hash = 14695981039346656037ull;
+            for (size_t index = 0; index < sizeof(Graphics::Vertex); ++index)
+                hash = (hash ^ bytes[index]) * 1099511628211ull;
+            return hash;
+        }
+    };
+
+    struct VertexEqual
+    {
+        inline bool operator()(const Graphics::Vertex& left, const Graphics::Vertex& right) const
+        {
+            return std::memcmp(&left, &right, sizeof(Graphics::Vertex)) == 0;
+        }
+    };
+
+    constexpr Graphics::Indice Unused = std::numeric_limits<Graphics::Indice>::max();
+
+    struct PositionHash
+    {
+        inline size_t operator()(const glm::vec3& position) const
+        {
+            const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&position);
+            size_t hash = 14695981039346656037ull;
+            for (size_t index = 0; index < sizeof(glm::vec3); ++index)
+                hash = (hash ^ bytes[index]) * 1099511628211ull;
+            return hash;
+        }
+    };
+
+    struct PositionEqual
+    {
+        inline bool operator()(const glm::vec3& left, const glm::vec3& right) const
+        {
+            return std::memcmp(&left, &right, sizeof(glm::vec3)) == 0;
+        }
+    };
+
+    /// @brief Symmetric 4x4 matrix summing squared distances to planes: xx xy xz xw yy yz yw zz zw ww
+    struct Quadric
+    {
+        double values[10] = {};
+
+        inline Quadric& operator+=(const Quadric& other)
+        {
+            for (size_t index = 0; index < 10; ++index)
+                values[index] += other.values[index];
+            return *this;
+        }
+
+        /// @brief Get squared distance sum of point to quadric planes
+        /// @param point The point to evaluate
+        /// @return Quadric error
+        inline double evaluate(const glm::vec3& point) const
+        {
+            double x = point.x, y = point.y, z = point.z;
+            const double* q = values;
+            return q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x
+                + q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y
+                + q[7] * z * z + 2.0 * q[8] * z + q[9];
+        }
+    };
+
+    /// @brief Make quadric of triangle plane
+    /// @param a First triangle corner
+    /// @param b Second triangle corner
+    /// @param c Third triangle corner
+    /// @return Plane quadric, empty for degenerate triangles
+    Quadric PlaneQuadric(const glm::vec3& a, const glm::vec3& b, const glm::vec3& c)
+    {
+        Quadric quadric;
+        glm::vec3 normal = glm::cross(b - a, c - a);
+        float length = glm::length(normal);
+        if (length == 0.0f)
+            return quadric;
+
+        double nx = normal.x / length, ny = normal.y / length, nz = normal.z / length;
+        double d = -(nx * a.x + ny * a.y + nz * a.z);
+        double plane[4] = { nx, ny, nz, d };
+        for (size_t row = 0, index = 0; row < 4; ++row)
+        {
+            for (size_t column = row; column < 4; ++column)
+                quadric.values[index++] = plane[row] * plane[column];
+        }
+        return quadric;
+    }
+
+    /// @brief Score vertex by its cache position and number of triangles still using it
+    /// @param cachePosition Position in modelled cache or -1 if vertex isn't cached
+    /// @param remainingTriangles Number of triangles not emitted yet
+    /// @return Vertex score, higher is emitted sooner
+    float VertexScore(int cachePosition, size_t remainingTriangles)
+    {
+        if (remainingTriangles == 0)
+            return -1.0f;
+
+        float score = 0.0f;
+        if (cachePosition >= 0)
+        {
+            if (cachePosition < 3)
+                score = Score::LastTriangle;
+            else
+                score = std::pow(1.0f - static_cast<float>(cachePosition - 3) / (CacheSize - 3), Score::CacheDecayPower);
+        }
+
+        return score + Score::ValenceBoostScale * std::pow(static_cast<float>(remainingTriangles), -Score::ValenceBoostPower);
+    }
+}
+
+void Graphics::MeshOptimizer::Weld(std::vector<Vertex>& vertices, std::vector<Indice>& indices)
+{
+    std::unordered_map<Vertex, Indice, MeshOptimizerData::VertexHash, MeshOptimizerData::VertexEqual> unique;
+    unique.reserve(vertices.size());
+
+    std::vector<Vertex> welded;
+    welded.reserve(vertices.size());
+    std::vector<Indice> remap(vertices.size(), MeshOptimizerData::Unused);
+    for (Indice& indice : indices)
+    {
+        if (remap[indice] == MeshOptimizerData::Unused)
+        {
+            auto [found, inserted] = unique.try_emplace(vertices[indice], static_cast<Indice>(welded.size()));
+            if (inserted)
+                welded.push_back(vertices[indice]);
+            remap[indice] = found->second;
+        }
+        indice = remap[indice];
+    }
+
+    vertices = std::move(welded);
+}
+
+void Graphics::MeshOptimizer::OptimizeVertexCache(std::vector<Indice>& indices, size_t vertexCount)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return;
+
+    // Triangles of every vertex, live ones are kept at the front of each list
+    std::vector<size_t> remaining(vertexCount, 0);
+    for (Indice indice : indices)
+        ++remaining[indice];
+
+    std::vector<size_t> offsets(vertexCount + 1, 0);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+        offsets[vertex + 1] = offsets[vertex] + remaining[vertex];
+
+    std::vector<size_t> adjacency(indices.size());
+    std::vector<size_t> filled(offsets.begin(), offsets.end() - 1);
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        for (size_t corner = 0; corner < 3; ++corner)
+            adjacency[filled[indices[triangle * 3 + corner]]++] = triangle;
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+        vertexScores[vertex] = MeshOptimizerData::VertexScore(-1, remaining[vertex]);
+
+    std::vector<float> triangleScores(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    size_t best = 0;
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        triangleScores[triangle] = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+        if (triangleScores[triangle] > triangleScores[best])
+            best = triangle;
+    }
+
+    std::vector<Indice> result;
+    result.reserve(indices.size());
+    std::vector<Indice> cache, nextCache;
+    cache.reserve(CacheSize + 3);
+    nextCache.reserve(CacheSize + 3);
+    size_t cursor = 0;
+    while (result.size() < indices.size())
+    {
+        if (best == triangleCount)
+        {
+            // Nothing in cache has triangles left, continue with the first unemitted one
+            while (emitted[cursor])
+                ++cursor;
+            best = cursor;
+        }
+
+        emitted[best] = true;
+        nextCache.clear();
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            Indice vertex = indices[best * 3 + corner];
+            result.push_back(vertex);
+            if (std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end())
+                nextCache.push_back(vertex);
+
+            // Move emitted triangle behind live ones
+            size_t* begin = adjacency.data() + offsets[vertex];
+            size_t* live = std::find(begin, begin + remaining[vertex], best);
+            if (live != begin + remaining[vertex])
+                std::swap(*live, begin[--remaining[vertex]]);
+        }
+
+        for (Indice vertex : cache)
+        {
+            if (std::find(nextCache.begin(), nextCache.end(), vertex) == nextCache.end())
+                nextCache.push_back(vertex);
+        }
+
+        // Rescore touched vertices, evicted ones included
+        for (size_t position = 0, size = nextCache.size(); position < size; ++position)
+        {
+            Indice vertex = nextCache[position];
+            cachePositions[vertex] = position < CacheSize ? static_cast<int>(position) : -1;
+            vertexScores[vertex] = MeshOptimizerData::VertexScore(cachePositions[vertex], remaining[vertex]);
+        }
+
+        // Only triangles of touched vertices changed score, the best one among them goes next
+        best = triangleCount;
+        float bestScore = -std::numeric_limits<float>::max();
+        for (Indice vertex : nextCache)
+        {
+            for (size_t index = offsets[vertex], end = offsets[vertex] + remaining[vertex]; index < end; ++index)
+            {
+                size_t triangle = adjacency[index];
+                triangleScores[triangle] = vertexScores[indices[triangle * 3]] + vertexScores[indices[triangle * 3 + 1]] + vertexScores[indices[triangle * 3 + 2]];
+                if (triangleScores[triangle] > bestScore)
+                {
+                    bestScore = triangleScores[triangle];
+                    best = triangle;
+                }
+            }
+        }
+
+        nextCache.resize(std::min(nextCache.size(), CacheSize));
+        std::swap(cache, nextCache);
+    }
+
+    indices = std::move(result);
+}
+
+void Graphics::MeshOptimizer::OptimizeOverdraw(std::span<const Vertex> vertices, std::vector<Indice>& indices)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0 || vertices.empty())
+        return;
+
+    // Clusters start where the cache was cold anyway, so reordering them costs almost no cache misses
+    std::vector<size_t> clusters;
+    std::vector<size_t> timestamps(vertices.size(), std::numeric_limits<size_t>::max());
+    size_t misses = 0;
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        size_t triangleMisses = 0;
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            Indice vertex = indices[triangle * 3 + corner];
+            if (timestamps[vertex] == std::numeric_limits<size_t>::max() || misses - timestamps[vertex] > SimulatedCacheSize)
+            {
+                timestamps[vertex] = misses++;
+                ++triangleMisses;
+            }
+        }
+
+        if (triangleMisses == 3)
+            clusters.push_back(triangle);
+    }
+    clusters.push_back(triangleCount);
+
+    glm::vec3 meshCentroid(0.0f);
+    for (const Vertex& vertex : vertices)
+        meshCentroid += vertex.position;
+    meshCentroid /= static_cast<float>(vertices.size());
+
+    // Clusters far out along their own normal are likely to occlude the rest
+    struct Cluster
+    {
+        size_t begin;
+        size_t end;
+        float sortKey;
+    };
+    std::vector<Cluster> sorted;
+    sorted.reserve(clusters.size() - 1);
+    for (size_t cluster = 0; cluster + 1 < clusters.size(); ++cluster)
+    {
+        glm::vec3 centroid(0.0f), normal(0.0f);
+        float area = 0.0f;
+        for (size_t triangle = clusters[cluster]; triangle < clusters[cluster + 1]; ++triangle)
+        {
+            const glm::vec3& a = vertices[indices[triangle * 3]].position;
+            const glm::vec3& b = vertices[indices[triangle * 3 + 1]].position;
+            const glm::vec3& c = vertices[indices[triangle * 3 + 2]].position;
+            glm::vec3 cross = glm::cross(b - a, c - a);
+            float triangleArea = glm::length(cross);
+            centroid += (a + b + c) * (triangleArea / 3.0f);
+            normal += cross;
+            area += triangleArea;
+        }
+
+        float sortKey = 0.0f;
+        float normalLength = glm::length(normal);
+        if (area > 0.0f && normalLength > 0.0f)
+            sortKey = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+        sorted.push_back({ clusters[cluster], clusters[cluster + 1], sortKey });
+    }
+
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Cluster& left, const Cluster& right)
+    {
+        return left.sortKey > right.sortKey;
+    });
+
+    std::vector<Indice> result;
+    result.reserve(indices.size());
+    for (const Cluster& cluster : sorted)
+        result.insert(result.end(), indices.begin() + cluster.begin * 3, indices.begin() + cluster.end * 3);
+    indices = std::move(result);
+}
+
+void Graphics::MeshOptimizer::OptimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<Indice>& indices)
+{
+    std::vector<Indice> remap(vertices.size(), MeshOptimizerData::Unused);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+    for (Indice& indice : indices)
+    {
+        if (remap[indice] == MeshOptimizerData::Unused)
+        {
+            remap[indice] = static_cast<Indice>(reordered.size());
+            reordered.push_back(vertices[indice]);
+        }
+        indice = remap[indice];
+    }
+
+    vertices = std::move(reordered);
+}
+
+float Graphics::MeshOptimizer::Acmr(std::span<const Indice> indices, size_t vertexCount, size_t cacheSize)
+{
+    size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0)
+        return 0.0f;
+
+    std::vector<size_t> timestamps(vertexCount, std::numeric_limits<size_t>::max());
+    size_t misses = 0;
+    for (Indice indice : indices)
+    {
+        if (timestamps[indice] == std::numeric_limits<size_t>::max() || misses - timestamps[indice] > cacheSize)
+            timestamps[indice] = misses++;
+    }
+    return static_cast<float>(misses) / triangleCount;
+}
+
+std::vector<Graphics::Indice> Graphics::MeshOptimizer::Simplify(std::span<const Vertex> vertices, std::span<const Indice> indices, size_t targetIndexCount, float targetError)
+{
+    using MeshOptimizerData::Quadric;
+    size_t vertexCount = vertices.size();
+    std::vector<Indice> result(indices.begin(), indices.end());
+    if (vertexCount == 0 || result.size() <= targetIndexCount)
+        return result;
+
+    // Vertices split by normals or texture coordinates share a position, topology is built on positions
+    std::unordered_map<glm::vec3, Indice, MeshOptimizerData::PositionHash, MeshOptimizerData::PositionEqual> positions;
+    positions.reserve(vertexCount);
+    std::vector<Indice> canonical(vertexCount);
+    std::vector<size_t> groupSizes(vertexCount, 0);
+    glm::vec3 minimum = vertices[0].position, maximum = vertices[0].position;
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        canonical[vertex] = positions.try_emplace(vertices[vertex].position, static_cast<Indice>(vertex)).first->second;
+        ++groupSizes[canonical[vertex]];
+        minimum = glm::min(minimum, vertices[vertex].position);
+        maximum = glm::max(maximum, vertices[vertex].position);
+    }
+
+    // Seams can't move without tearing attributes apart, borders without changing the silhouette
+    std::vector<bool> locked(vertexCount, false);
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+        locked[vertex] = groupSizes[vertex] > 1;
+
+    std::vector<Quadric> quadrics(vertexCount);
+    std::unordered_map<uint64_t, size_t> edges;
+    edges.reserve(result.size());
+    for (size_t triangle = 0; triangle < result.size() / 3; ++triangle)
+    {
+        Indice corners[3] = { canonical[result[triangle * 3]], canonical[result[triangle * 3 + 1]], canonical[result[triangle * 3 + 2]] };
+        Quadric quadric = MeshOptimizerData::PlaneQuadric(vertices[corners[0]].position, vertices[corners[1]].position, vertices[corners[2]].position);
+        for (size_t corner = 0; corner < 3; ++corner)
+        {
+            quadrics[corners[corner]] += quadric;
+            Indice first = std::min(corners[corner], corners[(corner + 1) % 3]);
+            Indice second = std::max(corners[corner], corners[(corner + 1) % 3]);
+            ++edges[(static_cast<uint64_t>(first) << 32) | second];
+        }
+    }
+
+    for (const auto& [edge, count] : edges)
+    {
+        if (count != 2)
+        {
+            locked[edge >> 32] = true;
+            locked[edge & 0xFFFFFFFF] = true;
+        }
+    }
+
+    struct Candidate
+    {
+        double cost;
+        Indice from;    // canonical vertex that goes away
+        Indice to;      // vertex that replaces it
+    };
+
+    double diagonal = glm::length(maximum - minimum) * targetError;
+    double maximumCost = diagonal * diagonal;
+    std::vector<Candidate> candidates;
+    std::vector<size_t> offsets(vertexCount + 1), adjacency;
+    std::vector<bool> touched(vertexCount);
+    std::vector<Indice> remap(vertexCount);
+
+    // Collapse independent edges in passes, cheapest first, rebuilding topology between passes
+    while (result.size() > targetIndexCount)
+    {
+        size_t triangleCount = result.size() / 3;
+        std::fill(offsets.begin(), offsets.end(), 0);
+        for (Indice indice : result)
+            ++offsets[canonical[indice] + 1];
+        for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+            offsets[vertex + 1] += offsets[vertex];
+        adjacency.resize(result.size());
+        std::vector<size_t> filled(offsets.begin(), offsets.end() - 1);
+        for (size_t index = 0; index < result.size(); ++index)
+            adjacency[filled[canonical[result[index]]]++] = index / 3;
+
+        std::vector<Candidate> best(vertexCount, { std::numeric_limits<double>::max(), 0, 0 });
+        for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+        {
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                Indice ends[2] = { result[triangle * 3 + corner], result[triangle * 3 + (corner + 1) % 3] };
+                for (size_t direction = 0; direction < 2; ++direction)
+                {
+                    Indice from = canonical[ends[direction]];
+                    Indice to = ends[1 - direction];
+                    if (locked[from])
+                        continue;
+
+                    Quadric quadric = quadrics[from];
+                    quadric += quadrics[canonical[to]];
+                    double cost = quadric.evaluate(vertices[to].position);
+                    if (cost < best[from].cost)
+                        best[from] = { cost, from, to };
+                }
+            }
+        }
+
+        candidates.clear();
+        for (const Candidate& candidate : best)
+        {
+            if (candidate.cost <= maximumCost)
+                candidates.push_back(candidate);
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate& left, const Candidate& right)
+        {
+            return left.cost < right.cost;
+        });
+
+        std::fill(touched.begin(), touched.end(), false);
+        std::iota(remap.begin(), remap.end(), 0);
+        size_t removeCount = (result.size() - targetIndexCount + 2) / 3;
+        size_t removed = 0;
+        for (const Candidate& candidate : candidates)
+        {
+            if (removed >= removeCount)
+                break;
+
+            Indice from = candidate.from, to = canonical[candidate.to];
+            if (touched[from] || touched[to])
+                continue;
+
+            // Moving a corner must not flip any triangle that survives the collapse
+            bool valid = true;
+            size_t collapsed = 0;
+            for (size_t index = offsets[from]; index < offsets[from + 1] && valid; ++index)
+            {
+                size_t triangle = adjacency[index];
+                glm::vec3 corners[3], moved[3];
+                bool degenerate = false;
+                for (size_t corner = 0; corner < 3; ++corner)
+                {
+                    Indice vertex = canonical[result[triangle * 3 + corner]];
+                    degenerate = degenerate || vertex == to;
+                    corners[corner] = vertices[vertex].position;
+                    moved[corner] = vertex == from ? vertices[to].position : corners[corner];
+                }
+
+                if (degenerate)
+                {
+                    ++collapsed;
+                    continue;
+                }
+
+                glm::vec3 before = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                glm::vec3 after = glm::cross(moved[1] - moved[0], moved[2] - moved[0]);
+                valid = glm::dot(before, after) > 0.0f;
+            }
+
+            if (!valid)
+                continue;
+
+            // Unlocked vertices have one attribute set, so canonical vertex is the only one to remap
+            remap[from] = candidate.to;
+            quadrics[to] += quadrics[from];
+            removed += collapsed;
+            for (size_t index = offsets[from]; index < offsets[from + 1]; ++index)
+            {
+                for (size_t corner = 0; corner < 3; ++corner)
+                    touched[canonical[result[adjacency[index] * 3 + corner]]] = true;
+            }
+        }
+
+        if (removed == 0)
+            break;
+
+        std::vector<Indice> collapsed;
+        collapsed.reserve(result.size());
+        for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+        {
+            Indice corners[3] = { remap[result[triangle * 3]], remap[result[triangle * 3 + 1]], remap[result[triangle * 3 + 2]] };
+            if (canonical[corners[0]] == canonical[corners[1]] || canonical[corners[1]] == canonical[corners[2]] || canonical[corners[0]] == canonical[corners[2]])
+                continue;
+            collapsed.insert(collapsed.end(), corners, corners + 3);
+        }
+        result = std::move(collapsed);
+    }
+
+    return result;
+}
+
+std::vector<std::vector<Graphics::Indice>> Graphics::MeshOptimizer::GenerateLods(std::span<const Vertex> vertices, std::span<const Indice> indices)
+{
+    std::vector<std::vector<Indice>> lods;
+    size_t previousCount = indices.size();
+    for (size_t level = 1; level < Lod::Count; ++level)
+    {
+        // Every level is simplified from the original, so errors don't pile up
+        size_t targetCount = static_cast<size_t>(previousCount / 3 * Lod::Reduction) * 3;
+        std::vector<Indice> lod = Simplify(vertices, indices, targetCount, Lod::MaximumError);
+        if (lod.empty() || lod.size() > previousCount * Lod::MinimumReduction)
+            break;
+
+        OptimizeVertexCache(lod, vertices.size());
+        previousCount = lod.size();
+        lods.push_back(std::move(lod));
+    }
+    return lods;
+}
+
+Graphics::MeshOptimizer::Statistics Graphics::MeshOptimizer::Optimize(std::vector<Vertex>& vertices, std::vector<Indice>& indices)
+{
+    Statistics statistics;
+    statistics.verticesBefore = vertices.size();
+    statistics.acmrBefore = Acmr(indices, vertices.size());
+
+    Weld(vertices, indices);
+    OptimizeVertexCache(indices, vertices.size());
+    OptimizeOverdraw(vertices, indices);
+    OptimizeVertexFetch(vertices, indices);
+
+    statistics.verticesAfter = vertices.size();
+    statistics.acmrAfter = Acmr(indices, vertices.size());
+    return statistics;
+}
+
+} // namespace kc
@@ -2,50 +2,141 @@
 
 namespace kc {
 
-void Graphics::Model::processNode(const aiScene* scene, aiNode* node)
+namespace ModelData
 {
-    m_meshes.reserve(m_meshes.size() + node->mNumMeshes);
+    /// @brief Get residency policy name for logs
+    /// @param residency Residency policy
+    /// @return Residency policy name
+    const char* ResidencyName(Graphics::Mesh::Residency residency)
+    {
+        switch (residency)
+        {
+            case Graphics::Mesh::Residency::Keep:
+                return "keep";
+            case Graphics::Mesh::Residency::Compact:
+                return "compact";
+            default:
+                return "discard";
+        }
+    }
+
+    /// @brief Get vertex format name for logs
+    /// @param format Vertex format
+    /// @return Vertex format name
+    const char* VertexFormatName(Graphics::VertexFormat format)
+    {
+        switch (format)
+        {
+            case Graphics::VertexFormat::Compact:
+                return "compact";
+            case Graphics::VertexFormat::Quantized:
+                return "quantized";
+            default:
+                return "full";
+        }
+    }
+
+    /// @brief Get render queue material id of texture set
+    /// @param textures The texture set
+    /// @return Id shared by equal texture sets, 0 for empty set
+    unsigned int MaterialId(const std::vector<Graphics::Texture::Pointer>& textures)
+    {
+        if (textures.empty())
+            return 0;
+
+        // Sets sharing a single texture must not look the same to the queue
+        uint64_t hash = textures.size();
+        for (const Graphics::Texture::Pointer& texture : textures)
+            hash ^= std::hash<unsigned int>{}(texture->id()) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        unsigned int id = static_cast<unsigned int>(hash ^ (hash >> 32));
+        return id ? id : 1;
+    }
+}
+
+std::vector<Graphics::Texture::Source> Graphics::Model::DecodeImages(const std::vector<std::string>& imageFilePaths, bool verticalFlip, JobSystem* jobs)
+{
+    std::vector<std::optional<Texture::Source>> images(imageFilePaths.size());
+    std::vector<std::exception_ptr> errors(imageFilePaths.size());
+    auto decode = [&](size_t begin, size_t end)
+    {
+        // Jobs must not throw, errors are rethrown in order once every image is done
+        for (size_t index = begin; index < end; ++index)
+        {
+            try
+            {
+                images[index].emplace(Texture::ReadSource(imageFilePaths[index], verticalFlip));
+            }
+            catch (...)
+            {
+                errors[index] = std::current_exception();
+            }
+        }
+    };
+
+    // One image per job, so one huge image doesn't hold back the rest
+    if (jobs)
+        jobs->parallelFor(imageFilePaths.size(), 1, decode);
+    else
+        decode(0, imageFilePaths.size());
+
+    std::vector<Texture::Source> result;
+    result.reserve(images.size());
+    for (size_t index = 0, size = images.size(); index < size; ++index)
+    {
+        if (errors[index])
+            std::rethrow_exception(errors[index]);
+        result.push_back(std::move(*images[index]));
+    }
+    return result;
+}
+
+void Graphics::Model::ProcessNode(const aiScene* scene, aiNode* node, Geometry& geometry, const glm::mat4& parent)
+{
+    // ASSIMP matrices are row-major
+    glm::mat4 transform = parent * glm::transpose(glm::make_mat4(&node->mTransformation.a1));
     for (unsigned int index = 0; index < node->mNumMeshes; ++index)
-        createMesh(scene, scene->mMeshes[node->mMeshes[index]]);
+        ReadMesh(scene, scene->mMeshes[node->mMeshes[index]], geometry, transform);
 
     for (unsigned int index = 0; index < node->mNumChildren; ++index)
-        processNode(scene, node->mChildren[index]);
+        ProcessNode(scene, node->mChildren[index], geometry, transform);
 }
 
-void Graphics::Model::createMesh(const aiScene* scene, aiMesh* mesh)
+void Graphics::Model::ReadMesh(const aiScene* scene, aiMesh* mesh, Geometry& geometry, const glm::mat4& transform)
 {
-    Mesh& meshEntry = m_meshes.emplace_back();
+    // Node transform is baked into vertices, so meshes of any node still share one draw call
+    glm::mat3 normalTransform = glm::transpose(glm::inverse(glm::mat3(transform)));
 
-    std::vector<Mesh::Vertex>& vertices = meshEntry.vertices();
+    // Inner vectors keep their storage when outer ones grow, so entry spans stay valid
+    std::vector<Mesh::Vertex>& vertices = geometry.vertices.emplace_back();
     vertices.reserve(mesh->mNumVertices);
     for (unsigned int index = 0; index < mesh->mNumVertices; ++index)
     {
         Mesh::Vertex& vertex = vertices.emplace_back();
-        vertex.position = { mesh->mVertices[index].x, mesh->mVertices[index].y, mesh->mVertices[index].z };
-        vertex.normal = { mesh->mNormals[index].x, mesh->mNormals[index].y, mesh->mNormals[index].z };
+        vertex.position = glm::vec3(transform * glm::vec4(mesh->mVertices[index].x, mesh->mVertices[index].y, mesh->mVertices[index].z, 1.0f));
+        vertex.normal = glm::normalize(normalTransform * glm::vec3(mesh->mNormals[index].x, mesh->mNormals[index].y, mesh->mNormals[index].z));
         vertex.texCoords = mesh->mTextureCoords[0] ? glm::vec2(mesh->mTextureCoords[0][index].x, mesh->mTextureCoords[0][index].y) : glm::vec2(0.0f);
     }
 
-    std::vector<Mesh::Indice>& indices = meshEntry.indices();
+    std::vector<Mesh::Indice>& indices = geometry.indices.emplace_back();
+    indices.reserve(mesh->mNumFaces * 3);
     for (unsigned int faceIndex = 0; faceIndex < mesh->mNumFaces; ++faceIndex)
     {
-        indices.reserve(indices.size() + mesh->mNumFaces);
         for (unsigned int indiceIndex = 0; indiceIndex < mesh->mFaces[faceIndex].mNumIndices; ++indiceIndex)
             indices.push_back(mesh->mFaces[faceIndex].mIndices[indiceIndex]);
     }
 
+    MeshCache::Entry& entry = geometry.entries.emplace_back();
+    entry.vertices = vertices;
+    entry.indices = indices;
     if (mesh->mMaterialIndex >= 0)
     {
         aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-        std::vector<Texture::Pointer>& textures = meshEntry.textures();
-        loadTextures(textures, material, aiTextureType_DIFFUSE);
-        loadTextures(textures, material, aiTextureType_SPECULAR);
+        CollectTextures(entry.textures, material, aiTextureType_DIFFUSE);
+        CollectTextures(entry.textures, material, aiTextureType_SPECULAR);
     }
-
-    meshEntry.create();
 }
 
-void Graphics::Model::loadTextures(std::vector<Texture::Pointer>& textures, aiMaterial* material, aiTextureType type)
+void Graphics::Model::CollectTextures(std::vector<MeshCache::TextureReference>& references, aiMaterial* material, aiTextureType type)
 {
     Texture::Type textureType = Texture::Type::None;
     switch (type)
@@ -62,50 +153,339 @@ void Graphics::Model::loadTextures(std::vector<Texture::Pointer>& textures, aiMa
     }
 
     unsigned int textureCount = material->GetTextureCount(type);
-    textures.reserve(textures.size() + textureCount);
+    references.reserve(references.size() + textureCount);
     for (unsigned int index = 0; index < textureCount; ++index)
     {
         aiString filename;
         material->GetTexture(type, index, &filename);
+        references.emplace_back(textureType, filename.C_Str());
+    }
+}
+
+Graphics::Model::Geometry Graphics::Model::ReadGeometry(const std::string& modelFilePath, spdlog::logger& logger)
+{
+    Geometry geometry;
+    geometry.directory = modelFilePath.substr(0, modelFilePath.find_last_of("/"));
+
+    std::string cacheFilePath = modelFilePath + MeshCacheConst::Extension;
+    try
+    {
+        geometry.cache = std::make_unique<MeshCache>(cacheFilePath, modelFilePath);
+        geometry.entries = geometry.cache->entries();
+        logger.info("\"{}\" loaded from mesh cache", modelFilePath);
+    }
+    catch (const std::exception& error)
+    {
+        logger.info("Mesh cache skipped: {}", error.what());
+        geometry.cache.reset();
+
+        Assimp::Importer importer;
+        const aiScene* scene = importer.ReadFile(modelFilePath, aiProcess_Triangulate | aiProcess_FlipUVs);
+        if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
+            throw std::runtime_error(fmt::format("kc::Graphics::Model::ReadGeometry(): Couldn't load model \"{}\"", modelFilePath));
+        ProcessNode(scene, scene->mRootNode, geometry, glm::mat4(1.0f));
+
+        // Optimized geometry goes to the cache, so warm loads get it for free
+        MeshOptimizer::Statistics total;
+        size_t triangleCount = 0, lodCount = 0;
+        for (size_t index = 0, size = geometry.entries.size(); index < size; ++index)
+        {
+            MeshOptimizer::Statistics statistics = MeshOptimizer::Optimize(geometry.vertices[index], geometry.indices[index]);
+            geometry.entries[index].vertices = geometry.vertices[index];
+            geometry.entries[index].indices = geometry.indices[index];
+
+            // Detail levels share optimized vertices
+            std::vector<std::vector<Mesh::Indice>>& lods = geometry.lods.emplace_back(MeshOptimizer::GenerateLods(geometry.vertices[index], geometry.indices[index]));
+            geometry.entries[index].lods.assign(lods.begin(), lods.end());
+            lodCount += lods.size();
+
+            size_t meshTriangles = geometry.indices[index].size() / 3;
+            total.verticesBefore += statistics.verticesBefore;
+            total.verticesAfter += statistics.verticesAfter;
+            total.acmrBefore += statistics.acmrBefore * meshTriangles;
+            total.acmrAfter += statistics.acmrAfter * meshTriangles;
+            triangleCount += meshTriangles;
+        }
+
+        if (triangleCount)
+        {
+            logger.info("\"{}\" optimized: {} -> {} vertices, ACMR {:.3f} -> {:.3f}, {} detail levels", modelFilePath,
+                total.verticesBefore, total.verticesAfter, total.acmrBefore / triangleCount, total.acmrAfter / triangleCount, lodCount);
+        }
+
+        try
+        {
+            // Cache is only an optimization, model is usable without it
+            MeshCache::Write(cacheFilePath, modelFilePath, geometry.entries);
+        }
+        catch (const std::exception& error)
+        {
+            logger.warn("Couldn't write mesh cache: {}", error.what());
+        }
+    }
+
+    geometry.minimum = glm::vec3(std::numeric_limits<float>::max());
+    geometry.maximum = glm::vec3(std::numeric_limits<float>::lowest());
+    for (const MeshCache::Entry& entry : geometry.entries)
+    {
+        for (const Mesh::Vertex& vertex : entry.vertices)
+        {
+            geometry.minimum = glm::min(geometry.minimum, vertex.position);
+            geometry.maximum = glm::max(geometry.maximum, vertex.position);
+        }
+    }
+    return geometry;
+}
+
+std::vector<Graphics::MeshCache::TextureReference> Graphics::Model::UniqueTextures(const Geometry& geometry)
+{
+    std::vector<MeshCache::TextureReference> references;
+    for (const MeshCache::Entry& entry : geometry.entries)
+    {
+        for (const MeshCache::TextureReference& reference : entry.textures)
+        {
+            auto found = std::find_if(references.begin(), references.end(), [&reference](const MeshCache::TextureReference& other)
+            {
+                return other.filename == reference.filename;
+            });
+            if (found == references.end())
+                references.push_back(reference);
+        }
+    }
+    return references;
+}
+
+void Graphics::Model::buildBatches()
+{
+    m_batches.clear();
+    if (m_meshes.empty() || m_createdMeshes != m_meshes.size())
+        return;
+
+    std::vector<size_t> order(m_meshes.size());
+    for (size_t index = 0, size = order.size(); index < size; ++index)
+        order[index] = index;
+    // One multi-draw call takes one index type, so it splits batches too
+    std::stable_sort(order.begin(), order.end(), [this](size_t left, size_t right)
+    {
+        const Mesh& leftMesh = m_meshes[left];
+        const Mesh& rightMesh = m_meshes[right];
+        if (leftMesh.textures() != rightMesh.textures())
+            return leftMesh.textures() < rightMesh.textures();
+        return leftMesh.range().indexType < rightMesh.range().indexType;
+    });
+
+    for (size_t index : order)
+    {
+        const Mesh& mesh = m_meshes[index];
+        if (m_batches.empty() || m_meshes[m_batches.back().meshes.front()].textures() != mesh.textures() || m_batches.back().indexType != mesh.range().indexType)
+        {
+            m_batches.emplace_back();
+            m_batches.back().indexType = mesh.range().indexType;
+            m_batches.back().material = ModelData::MaterialId(mesh.textures());
+        }
+        m_batches.back().meshes.push_back(index);
+    }
+}
+
+size_t Graphics::Model::SelectLod(const Mesh& mesh, const glm::mat4& modelView, const Camera& camera)
+{
+    if (mesh.lodCount() == 1)
+        return 0;
 
-        if (m_textures.find(filename.C_Str()) != m_textures.end())
+    // Bounding sphere in view space, scaled by the largest axis scale
+    glm::vec3 center = glm::vec3(modelView * glm::vec4((mesh.minimum() + mesh.maximum()) * 0.5f, 1.0f));
+    float scale = std::max({ glm::length(glm::vec3(modelView[0])), glm::length(glm::vec3(modelView[1])), glm::length(glm::vec3(modelView[2])) });
+    float radius = glm::length(mesh.maximum() - mesh.minimum()) * 0.5f * scale;
+    float distance = glm::length(center);
+    if (distance <= radius)
+        return 0;
+
+    // Projection [1][1] is cot(fov / 2), so zoom is accounted for
+    float screenSize = radius * camera.projection()[1][1] / distance;
+    if (screenSize >= ModelConst::Lod::FullDetailScreenSize)
+        return 0;
+    return std::min(static_cast<size_t>(std::log2(ModelConst::Lod::FullDetailScreenSize / screenSize)), mesh.lodCount() - 1);
+}
+
+void Graphics::Model::reportMemory()
+{
+    size_t cpuMemory = 0, indexCount = 0;
+    for (const Mesh& mesh : m_meshes)
+    {
+        cpuMemory += mesh.memory();
+        indexCount += mesh.indexCount();
+    }
+
+    m_logger.info("\"{}\" geometry: {} meshes, {} triangles, {:.2f} MiB GPU, {:.2f} MiB CPU ({} residency, {} vertices)",
+        m_directory, m_meshes.size(), indexCount / 3, m_arena.memory() / 1048576.0, cpuMemory / 1048576.0,
+        ModelData::ResidencyName(m_residency), ModelData::VertexFormatName(m_vertexFormat));
+}
+
+Graphics::Model::Model()
+    : m_logger(Utility::CreateLogger("model"))
+    , m_minimum(0.0f)
+    , m_maximum(0.0f)
+    , m_createdMeshes(0)
+    , m_bounded(false)
+    , m_ready(false)
+    , m_residency(Mesh::Residency::Discard)
+    , m_vertexFormat(VertexFormat::Full)
+{}
+
+void Graphics::Model::load(const std::string& modelFilePath, JobSystem* jobs)
+{
+    Geometry geometry = ReadGeometry(modelFilePath, m_logger);
+    prepare(geometry);
+    for (size_t index = 0, size = geometry.entries.size(); index < size; ++index)
+        createMesh(index, geometry.entries[index]);
+
+    // Textures shared with other models come from the cache, the rest is decoded on workers
+    Textures textures;
+    std::vector<MeshCache::TextureReference> references;
+    std::vector<std::string> imageFilePaths;
+    for (const MeshCache::TextureReference& reference : UniqueTextures(geometry))
+    {
+        std::string imageFilePath = geometry.directory + '/' + reference.filename;
+        if (Texture::Pointer texture = TextureCache::Find(reference.type, imageFilePath, GL_RGB, true))
         {
-            textures.push_back(m_textures[filename.C_Str()]);
+            textures[reference.filename] = texture;
             continue;
         }
 
-        auto texture = m_textures.try_emplace(filename.C_Str());
-        texture.first->second = std::make_shared<Texture>(textureType, m_directory + '/' + filename.C_Str(), GL_RGB, true);
-        textures.push_back(texture.first->second);
+        references.push_back(reference);
+        imageFilePaths.push_back(std::move(imageFilePath));
+    }
+
+    // Upload on the context thread
+    std::vector<Texture::Source> images = DecodeImages(imageFilePaths, true, jobs);
+    for (size_t index = 0, size = images.size(); index < size; ++index)
+    {
+        auto texture = std::make_shared<Texture>(references[index].type, images[index], GL_RGB);
+        TextureCache::Insert(references[index].type, imageFilePaths[index], GL_RGB, true, texture);
+        textures[references[index].filename] = texture;
+    }
+    attachTextures(geometry, std::move(textures));
+}
+
+void Graphics::Model::prepare(const Geometry& geometry)
+{
+    m_ready = false;
+    m_bounded = false;
+    m_directory = geometry.directory;
+    m_minimum = geometry.minimum;
+    m_maximum = geometry.maximum;
+    m_meshes.clear();
+    m_meshes.resize(geometry.entries.size());
+    m_batches.clear();
+    m_createdMeshes = 0;
+
+    // Every mesh lives in one pair of buffers, sized up front so the arena never grows
+    size_t vertexCount = 0, indexCount = 0;
+    for (const MeshCache::Entry& entry : geometry.entries)
+    {
+        vertexCount += entry.vertices.size();
+        indexCount += entry.indices.size();
+        for (std::span<const Mesh::Indice> lod : entry.lods)
+            indexCount += lod.size();
+    }
+    m_arena.create(vertexCount, indexCount, m_vertexFormat, geometry.minimum, geometry.maximum);
+    m_textures.clear();
+
+    Material material = { std::make_shared<Texture>(Texture::Type::Diffuse), std::make_shared<Texture>(Texture::Type::Specular) };
+    Transform transform = { (geometry.minimum + geometry.maximum) * 0.5f, glm::vec3(0.0f), geometry.maximum - geometry.minimum };
+    m_placeholder.emplace(transform, Color(), material);
+    m_bounded.store(true, std::memory_order_release);
+}
+
+void Graphics::Model::createMesh(size_t index, const MeshCache::Entry& entry)
+{
+    m_meshes[index].create(m_arena, entry.vertices, entry.indices, m_residency);
+    for (std::span<const Mesh::Indice> lod : entry.lods)
+        m_meshes[index].addLod(lod);
+    ++m_createdMeshes;
+    if (m_createdMeshes == m_meshes.size())
+    {
+        buildBatches();
+        reportMemory();
+        m_ready.store(true, std::memory_order_release);
+    }
+}
+
+void Graphics::Model::attachTextures(const Geometry& geometry, Textures&& textures)
+{
+    m_textures = std::move(textures);
+    for (size_t index = 0, size = geometry.entries.size(); index < size; ++index)
+    {
+        std::vector<Texture::Pointer>& meshTextures = m_meshes[index].textures();
+        meshTextures.clear();
+        meshTextures.reserve(geometry.entries[index].textures.size());
+        for (const MeshCache::TextureReference& reference : geometry.entries[index].textures)
+            meshTextures.push_back(m_textures.at(reference.filename));
     }
+    buildBatches();
 }
 
-void Graphics::Model::load(const std::string& modelFilePath)
+void Graphics::Model::submit(RenderQueue& queue, ShaderProgram& shaderProgram, const Camera& camera, const glm::mat4& parent, unsigned int condition) const
 {
-    m_directory = modelFilePath.substr(0, modelFilePath.find_last_of("/"));
-    Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(modelFilePath, aiProcess_Triangulate | aiProcess_FlipUVs);
-    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
-        throw std::runtime_error(fmt::format("kc::Graphics::Model::load(): Couldn't load model \"{}\"", modelFilePath));
-    processNode(scene, scene->mRootNode);
+    if (!ready())
+    {
+        // Show where the model will appear while its meshes are still being created
+        if (m_placeholder)
+            m_placeholder->submit(queue, shaderProgram, camera, parent * m_transform.matrix(), condition);
+        return;
+    }
+
+    // Cull every mesh in one pass, scratch is per thread since jobs may submit the same model
+    thread_local std::vector<BoundingSphere> spheres;
+    thread_local std::vector<uint8_t> visible;
+    glm::mat4 model = parent * m_transform.matrix();
+    spheres.clear();
+    for (const Mesh& mesh : m_meshes)
+        spheres.push_back(mesh.boundingSphere().transformed(model));
+    visible.resize(spheres.size());
+    if (camera.frustum().cull(spheres, visible) == 0)
+        return;
+
+    // One packet per material, the same model may be submitted several times a frame so ranges travel with it
+    glm::mat4 modelView = camera.view() * model;
+    float depth = -(modelView * glm::vec4(boundingSphere().center, 1.0f)).z;
+    UniformBlocks::Object object = UniformBlocks::MakeObject(modelView, m_arena.dequantization());
+    for (const MaterialBatch& batch : m_batches)
+    {
+        GeometryArena::Batch ranges;
+        ranges.indexType = batch.indexType;
+        for (size_t mesh : batch.meshes)
+        {
+            if (visible[mesh])
+                ranges.add(m_meshes[mesh].range(SelectLod(m_meshes[mesh], modelView, camera)));
+        }
+        if (ranges.counts.empty())
+            continue;
+
+        const Mesh& first = m_meshes[batch.meshes.front()];
+        queue.submit({ &shaderProgram, m_arena.vertexArray(), batch.material, condition, depth, RenderQueue::Layer::Opaque, object,
+            [this, &first, ranges = std::move(ranges)](ShaderProgram& shaderProgram)
+            {
+                shaderProgram.set("Material.shininess", 32.0f);
+                first.bindTextures(shaderProgram);
+                m_arena.draw(ranges);
+            }
+        });
+    }
 }
 
-void Graphics::Model::draw(ShaderProgram& shaderProgram) const
+void Graphics::Model::drawInstanced(ShaderProgram& shaderProgram, const InstanceBuffer& instances) const
 {
-    // Transform
-    // TODO: Rotate model around a single axis rather than three
-    glm::mat4 model(1.0f);
-    model = glm::translate(model, m_transform.position);
-    model = glm::rotate(model, glm::radians(m_transform.rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
-    model = glm::rotate(model, glm::radians(m_transform.rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
-    model = glm::rotate(model, glm::radians(m_transform.rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
-    model = glm::scale(model, m_transform.scale);
-    shaderProgram.set("Model", model);
+    if (!ready() || !instances.count())
+        return;
 
-    // Draw
+    // Every mesh lives in the arena vertex array, so instances are attached once for all of them
     shaderProgram.set("Material.shininess", 32.0f);
+    shaderProgram.set("Dequantization", m_arena.dequantization());
+    instances.attach(m_arena.vertexArray());
     for (const Mesh& mesh : m_meshes)
-        mesh.draw(shaderProgram);
+        mesh.drawInstanced(shaderProgram, instances.count());
+    instances.detach(m_arena.vertexArray());
 }
 
 } // namespace kc
@@ -0,0 +1,135 @@
+#include "graphics/occlusion_culler.hpp"
+using namespace kc::Graphics::OcclusionCullerConst;
+
+namespace kc {
+
+void Graphics::OcclusionCuller::free()
+{
+    if (!m_queries.empty())
+    {
+        glDeleteQueries(static_cast<int>(m_queries.size()), m_queries.data());
+        m_queries.clear();
+    }
+
+    m_issued.clear();
+    m_pending.clear();
+    m_visible.clear();
+    m_tests.clear();
+    m_box.reset();
+}
+
+Graphics::OcclusionCuller::OcclusionCuller()
+    : m_frame(0)
+    , m_enabled(false)
+{}
+
+Graphics::OcclusionCuller::OcclusionCuller(OcclusionCuller&& other) noexcept
+    : m_queries(std::move(other.m_queries))
+    , m_issued(std::move(other.m_issued))
+    , m_pending(std::move(other.m_pending))
+    , m_visible(std::move(other.m_visible))
+    , m_tests(std::move(other.m_tests))
+    , m_box(std::move(other.m_box))
+    , m_statistics(other.m_statistics)
+    , m_frame(other.m_frame)
+    , m_enabled(other.m_enabled)
+{
+    other.m_queries.clear();
+    other.m_box.reset();
+}
+
+Graphics::OcclusionCuller::~OcclusionCuller()
+{
+    free();
+}
+
+void Graphics::OcclusionCuller::create()
+{
+    free(); // avoid memory leaks if create() was called already
+    m_box.emplace();
+}
+
+void Graphics::OcclusionCuller::begin(size_t objects)
+{
+    m_statistics = {};
+    m_tests.clear();
+    ++m_frame;
+    if (objects > m_queries.size())
+    {
+        size_t first = m_queries.size();
+        m_queries.resize(objects);
+        glGenQueries(static_cast<int>(objects - first), m_queries.data() + first);
+        m_issued.resize(objects, 0);
+        m_pending.resize(objects, false);
+        m_visible.resize(objects, true);
+    }
+
+    // Results that aren't ready yet are picked up next frame, conditional render keeps drawing meanwhile
+    for (size_t object = 0; object < m_queries.size(); ++object)
+    {
+        if (!m_pending[object])
+            continue;
+
+        unsigned int available = GL_FALSE;
+        glGetQueryObjectuiv(m_queries[object], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            continue;
+
+        unsigned int passed = GL_FALSE;
+        glGetQueryObjectuiv(m_queries[object], GL_QUERY_RESULT, &passed);
+        m_visible[object] = passed != GL_FALSE;
+        m_pending[object] = false;
+    }
+}
+
+unsigned int Graphics::OcclusionCuller::condition(uint32_t object, const BoundingBox& box, const Camera& camera)
+{
+    if (!m_enabled || object >= m_queries.size())
+        return 0;
+
+    // Near plane clips box faces around camera, such box would hide what camera is inside of
+    BoundingBox grown = { box.minimum - Margin, box.maximum + Margin };
+    if (grown.contains(camera.position()))
+    {
+        m_issued[object] = 0;
+        m_pending[object] = false;
+        m_visible[object] = true;
+        return 0;
+    }
+
+    // Result of an object that left the view long ago may be stale, such object waits for a fresh one
+    m_tests.push_back({ object, box });
+    if (!m_issued[object] || m_issued[object] + 1 != m_frame)
+        return 0;
+
+    ++m_statistics.tested;
+    if (!m_visible[object])
+        ++m_statistics.occluded;
+    return m_queries[object];
+}
+
+void Graphics::OcclusionCuller::test(ShaderProgram& shaderProgram, const Camera& camera, StreamBuffer& stream)
+{
+    if (!m_enabled || m_tests.empty())
+        return;
+
+    // Boxes only touch queries, depth and color stay as objects left them
+    StateCache::ColorMask(false);
+    StateCache::DepthMask(false);
+    for (const Test& test : m_tests)
+    {
+        // Margin keeps flat boxes from covering no samples at all
+        glm::mat4 model = glm::translate(glm::mat4(1.0f), test.box.center());
+        model = glm::scale(model, test.box.maximum - test.box.minimum + Margin);
+
+        glBeginQuery(GL_ANY_SAMPLES_PASSED, m_queries[test.object]);
+        m_box->drawGeometry(shaderProgram, camera.view() * model, stream);
+        glEndQuery(GL_ANY_SAMPLES_PASSED);
+        m_issued[test.object] = m_frame;
+        m_pending[test.object] = true;
+    }
+    StateCache::DepthMask(true);
+    StateCache::ColorMask(true);
+}
+
+} // namespace kc
@@ -0,0 +1,243 @@
+#include "graphics/profiler.hpp"
+using namespace kc::Graphics::ProfilerConst;
+
+namespace kc {
+
+namespace ProfilerData
+{
+    /// @brief Escape string for JSON
+    /// @param string The string to escape
+    /// @return Escaped string
+    std::string Escape(std::string_view string)
+    {
+        std::string result;
+        for (char character : string)
+        {
+            if (character == '"' || character == '\\')
+                result.push_back('\\');
+            result.push_back(character);
+        }
+        return result;
+    }
+}
+
+void Graphics::Profiler::Push(std::vector<float>& samples, size_t& next, float sample)
+{
+    if (samples.size() < History)
+    {
+        samples.push_back(sample);
+        return;
+    }
+
+    samples[next] = sample;
+    next = (next + 1) % History;
+}
+
+Graphics::Profiler::Percentiles Graphics::Profiler::Calculate(std::vector<float> samples)
+{
+    if (samples.empty())
+        return {};
+
+    // Nearest rank, history is short enough to sort
+    std::sort(samples.begin(), samples.end());
+    auto rank = [&samples](float percentile)
+    {
+        size_t index = static_cast<size_t>(percentile * samples.size());
+        return samples[std::min(index, samples.size() - 1)];
+    };
+    return { rank(0.50f), rank(0.95f), rank(0.99f) };
+}
+
+void Graphics::Profiler::free()
+{
+    for (Frame& frame : m_frames)
+    {
+        if (!frame.queries.empty())
+            glDeleteQueries(static_cast<int>(frame.queries.size()), frame.queries.data());
+        frame = {};
+    }
+    m_gpu = false;
+}
+
+int64_t Graphics::Profiler::now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - m_epoch).count();
+}
+
+void Graphics::Profiler::calibrate()
+{
+    // Timestamp of the moment all previous commands reached GPU, close enough to line both timelines up
+    GLint64 timestamp = 0;
+    glGetInteger64v(GL_TIMESTAMP, &timestamp);
+    m_gpuOffset = timestamp - now();
+}
+
+void Graphics::Profiler::collect(Frame& frame)
+{
+    frame.submitted = false;
+    if (!m_gpu || frame.records.empty())
+        return;
+
+    // Timestamps complete in issue order, the one issued last being ready means all of them are
+    unsigned int available = 0;
+    glGetQueryObjectuiv(frame.queries[frame.lastQuery], GL_QUERY_RESULT_AVAILABLE, &available);
+    if (!available)
+    {
+        ++m_droppedFrames;
+        return;
+    }
+
+    for (const Record& record : frame.records)
+    {
+        GLuint64 begin = 0, end = 0;
+        glGetQueryObjectui64v(frame.queries[record.query], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[record.query + 1], GL_QUERY_RESULT, &end);
+
+        ScopeData& scope = m_scopes[record.scope];
+        int64_t duration = static_cast<int64_t>(end - begin);
+        Push(scope.gpu, scope.gpuNext, duration / 1000.0f);
+        trace(record.scope, true, static_cast<int64_t>(begin) - m_gpuOffset, duration);
+    }
+}
+
+void Graphics::Profiler::trace(ScopeId scope, bool gpu, int64_t begin, int64_t duration)
+{
+    if (m_capturing && m_trace.size() < MaximumTraceEvents)
+        m_trace.push_back({ scope, gpu, begin, duration });
+}
+
+Graphics::Profiler::Profiler()
+    : m_epoch(Clock::now())
+    , m_gpuOffset(0)
+    , m_frame(0)
+    , m_droppedFrames(0)
+    , m_gpu(false)
+    , m_capturing(false)
+{}
+
+Graphics::Profiler::~Profiler()
+{
+    free();
+}
+
+void Graphics::Profiler::create()
+{
+    free(); // avoid memory leaks if create() was called already
+    m_gpu = GLEW_ARB_timer_query;
+    if (m_gpu)
+        calibrate();
+}
+
+void Graphics::Profiler::beginFrame()
+{
+    m_frame = (m_frame + 1) % Latency;
+    Frame& frame = m_frames[m_frame];
+    if (frame.submitted)
+        collect(frame);
+
+    frame.records.clear();
+    frame.usedQueries = 0;
+    frame.lastQuery = 0;
+}
+
+void Graphics::Profiler::endFrame()
+{
+    if (!m_stack.empty())
+        throw std::runtime_error(fmt::format("kc::Graphics::Profiler::endFrame(): {} scopes are still open", m_stack.size()));
+
+    m_frames[m_frame].submitted = true;
+}
+
+void Graphics::Profiler::begin(std::string_view name)
+{
+    auto iterator = m_scopeIds.find(name);
+    if (iterator == m_scopeIds.end())
+    {
+        iterator = m_scopeIds.emplace(std::string(name), static_cast<ScopeId>(m_scopes.size())).first;
+        m_scopes.push_back({ std::string(name), m_stack.size(), {}, {}, 0, 0 });
+    }
+
+    Frame& frame = m_frames[m_frame];
+    Record record = { iterator->second, 0, 0, static_cast<unsigned int>(frame.usedQueries) };
+    if (m_gpu)
+    {
+        // Elapsed time queries can't nest, a pair of timestamps per scope can
+        if (frame.usedQueries + 2 > frame.queries.size())
+        {
+            size_t size = frame.queries.size();
+            frame.queries.resize(std::max<size_t>(size * 2, 16));
+            glGenQueries(static_cast<int>(frame.queries.size() - size), frame.queries.data() + size);
+        }
+        glQueryCounter(frame.queries[frame.usedQueries], GL_TIMESTAMP);
+        frame.lastQuery = frame.usedQueries;
+        frame.usedQueries += 2;
+    }
+
+    m_stack.push_back(frame.records.size());
+    record.cpuBegin = now();
+    frame.records.push_back(record);
+}
+
+void Graphics::Profiler::end()
+{
+    int64_t cpuEnd = now();
+    if (m_stack.empty())
+        throw std::runtime_error("kc::Graphics::Profiler::end(): No scope is open");
+
+    Frame& frame = m_frames[m_frame];
+    Record& record = frame.records[m_stack.back()];
+    m_stack.pop_back();
+    record.cpuEnd = cpuEnd;
+    if (m_gpu)
+    {
+        glQueryCounter(frame.queries[record.query + 1], GL_TIMESTAMP);
+        frame.lastQuery = record.query + 1;
+    }
+
+    ScopeData& scope = m_scopes[record.scope];
+    Push(scope.cpu, scope.cpuNext, (record.cpuEnd - record.cpuBegin) / 1000.0f);
+    trace(record.scope, false, record.cpuBegin, record.cpuEnd - record.cpuBegin);
+}
+
+void Graphics::Profiler::startCapture()
+{
+    // Clocks drift apart over long runs, line them up again for every capture
+    m_trace.clear();
+    m_capturing = true;
+    if (m_gpu)
+        calibrate();
+}
+
+void Graphics::Profiler::stopCapture(const std::string& filePath)
+{
+    m_capturing = false;
+    std::ofstream file(filePath);
+    if (!file)
+        throw std::runtime_error(fmt::format("kc::Graphics::Profiler::stopCapture(): Couldn't open file \"{}\"", filePath));
+
+    // Complete events in microseconds, CPU and GPU are two threads of one process
+    file << "{\"traceEvents\":[\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":1,\"args\":{\"name\":\"CPU\"}},\n";
+    file << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":2,\"args\":{\"name\":\"GPU\"}}";
+    for (const TraceEvent& event : m_trace)
+    {
+        file << fmt::format(",\n{{\"name\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+            ProfilerData::Escape(m_scopes[event.scope].name), event.gpu ? 2 : 1, event.begin / 1000.0, event.duration / 1000.0);
+    }
+    file << "\n]}\n";
+    m_trace.clear();
+
+    if (!file)
+        throw std::runtime_error(fmt::format("kc::Graphics::Profiler::stopCapture(): Couldn't write file \"{}\"", filePath));
+}
+
+std::vector<Graphics::Profiler::Summary> Graphics::Profiler::summary() const
+{
+    std::vector<Summary> result;
+    result.reserve(m_scopes.size());
+    for (const ScopeData& scope : m_scopes)
+        result.push_back({ scope.name, scope.depth, scope.cpu.size(), Calculate(scope.cpu), Calculate(scope.gpu) });
+    return result;
+}
+
+} // namespace kc
@@ -0,0 +1,130 @@
+#include "graphics/render_queue.hpp"
+using namespace kc::Graphics::RenderQueueConst;
+
+namespace kc {
+
+void Graphics::RenderQueue::RadixSort(std::vector<Entry>& entries, std::vector<Entry>& scratch)
+{
+    // One counting pass gives histograms of every byte
+    size_t counts[8][256] = {};
+    for (const Entry& entry : entries)
+    {
+        for (size_t byte = 0; byte < 8; ++byte)
+            ++counts[byte][(entry.key >> (byte * 8)) & 0xFF];
+    }
+
+    scratch.resize(entries.size());
+    for (size_t byte = 0; byte < 8; ++byte)
+    {
+        // Byte is the same in every key, pass wouldn't move anything
+        if (counts[byte][(entries.front().key >> (byte * 8)) & 0xFF] == entries.size())
+            continue;
+
+        size_t offsets[256];
+        size_t offset = 0;
+        for (size_t bucket = 0; bucket < 256; ++bucket)
+        {
+            offsets[bucket] = offset;
+            offset += counts[byte][bucket];
+        }
+
+        for (const Entry& entry : entries)
+            scratch[offsets[(entry.key >> (byte * 8)) & 0xFF]++] = entry;
+        entries.swap(scratch);
+    }
+}
+
+uint64_t Graphics::RenderQueue::key(const Packet& packet)
+{
+    uint64_t program = Id(m_programIds, static_cast<const ShaderProgram*>(packet.program), Key::ProgramBits);
+    uint64_t vertexArray = Id(m_vertexArrayIds, packet.vertexArray, Key::VertexArrayBits);
+    uint64_t material = Id(m_materialIds, packet.material, Key::MaterialBits);
+
+    constexpr uint64_t MaximumDepth = (uint64_t(1) << Key::DepthBits) - 1;
+    uint64_t depth = static_cast<uint64_t>(std::clamp(packet.depth / DepthRange, 0.0f, 1.0f) * MaximumDepth);
+
+    uint64_t state = (program << (Key::VertexArrayBits + Key::MaterialBits)) | (vertexArray << Key::MaterialBits) | material;
+    constexpr int StateBits = Key::ProgramBits + Key::VertexArrayBits + Key::MaterialBits;
+    constexpr int LayerShift = 64 - Key::LayerBits;
+    if (packet.layer == Layer::Opaque)
+    {
+        // State switches cost more than overdraw, so state comes first and depth only orders draws sharing it
+        return (state << Key::DepthBits) | depth;
+    }
+
+    // Blending needs farther draws first, whatever they switch
+    return (uint64_t(1) << LayerShift) | ((MaximumDepth - depth) << StateBits) | state;
+}
+
+Graphics::RenderQueue::Packet& Graphics::RenderQueue::submit(Packet&& packet)
+{
+    return m_packets.emplace_back(std::move(packet));
+}
+
+void Graphics::RenderQueue::append(RenderQueue& other)
+{
+    m_packets.insert(m_packets.end(), std::make_move_iterator(other.m_packets.begin()), std::make_move_iterator(other.m_packets.end()));
+    other.m_packets.clear();
+}
+
+void Graphics::RenderQueue::execute(StreamBuffer& stream)
+{
+    m_statistics = {};
+    m_statistics.packets = m_packets.size();
+    if (m_packets.empty())
+        return;
+
+    m_entries.clear();
+    for (size_t index = 0; index < m_packets.size(); ++index)
+        m_entries.push_back({ key(m_packets[index]), static_cast<uint32_t>(index) });
+    RadixSort(m_entries, m_scratch);
+
+    // Object blocks of the whole frame are written in issue order at once, each draw binds its own range
+    size_t stride = (sizeof(UniformBlocks::Object) + stream.uniformAlignment() - 1) / stream.uniformAlignment() * stream.uniformAlignment();
+    StreamBuffer::Mapping objects = stream.map(m_entries.size() * stride, stream.uniformAlignment());
+    for (size_t index = 0; index < m_entries.size(); ++index)
+        std::memcpy(objects.data + index * stride, &m_packets[m_entries[index].packet].object, sizeof(UniformBlocks::Object));
+    stream.unmap();
+
+    const ShaderProgram* program = nullptr;
+    unsigned int vertexArray = 0, material = 0, condition = 0;
+    for (size_t index = 0; index < m_entries.size(); ++index)
+    {
+        Packet& packet = m_packets[m_entries[index].packet];
+        if (packet.program != program)
+        {
+            program = packet.program;
+            program->use();
+            ++m_statistics.programSwitches;
+        }
+        if (packet.vertexArray != vertexArray)
+        {
+            vertexArray = packet.vertexArray;
+            StateCache::BindVertexArray(vertexArray);
+            ++m_statistics.vertexArraySwitches;
+        }
+        if (packet.material != material)
+        {
+            // Commands bind textures themselves, the state cache elides repeated binds
+            material = packet.material;
+            ++m_statistics.materialSwitches;
+        }
+        if (packet.condition != condition)
+        {
+            if (condition)
+                glEndConditionalRender();
+            condition = packet.condition;
+            if (condition)
+                glBeginConditionalRender(condition, GL_QUERY_NO_WAIT);
+        }
+
+        stream.bind(UniformBuffer::Binding::Object, objects.offset + index * stride, sizeof(UniformBlocks::Object));
+        packet.command(*packet.program);
+    }
+    if (condition)
+        glEndConditionalRender();
+
+    m_packets.clear();
+}
+
+} // namespace kc
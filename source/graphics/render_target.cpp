@@ -0,0 +1,91 @@
+#include "graphics/render_target.hpp"
+
+namespace kc {
+
+void Graphics::RenderTarget::free()
+{
+    if (m_frameBuffer)
+    {
+        glDeleteFramebuffers(1, &m_frameBuffer);
+        m_frameBuffer = 0;
+    }
+
+    if (m_color)
+    {
+        glDeleteRenderbuffers(1, &m_color);
+        m_color = 0;
+    }
+
+    if (m_depth)
+    {
+        glDeleteRenderbuffers(1, &m_depth);
+        m_depth = 0;
+    }
+
+    m_width = 0;
+    m_height = 0;
+}
+
+Graphics::RenderTarget::RenderTarget()
+    : m_frameBuffer(0)
+    , m_color(0)
+    , m_depth(0)
+    , m_width(0)
+    , m_height(0)
+{}
+
+Graphics::RenderTarget::RenderTarget(RenderTarget&& other) noexcept
+    : m_frameBuffer(other.m_frameBuffer)
+    , m_color(other.m_color)
+    , m_depth(other.m_depth)
+    , m_width(other.m_width)
+    , m_height(other.m_height)
+{
+    other.m_frameBuffer = 0;
+    other.m_color = 0;
+    other.m_depth = 0;
+    other.m_width = 0;
+    other.m_height = 0;
+}
+
+Graphics::RenderTarget::~RenderTarget()
+{
+    free();
+}
+
+void Graphics::RenderTarget::create(int width, int height)
+{
+    free(); // avoid memory leaks if create() was called already
+    m_width = width;
+    m_height = height;
+
+    // Nothing samples the result, renderbuffers are enough
+    glGenRenderbuffers(1, &m_color);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &m_depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+
+    glGenFramebuffers(1, &m_frameBuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, m_color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, m_depth);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        free();
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        throw std::runtime_error(fmt::format("kc::Graphics::RenderTarget::create(): Framebuffer is incomplete [0x{:04X}]", status));
+    }
+}
+
+void Graphics::RenderTarget::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, m_frameBuffer);
+    glViewport(0, 0, m_width, m_height);
+}
+
+} // namespace kc
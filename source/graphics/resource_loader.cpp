@@ -0,0 +1,191 @@
+#include "graphics/resource_loader.hpp"
+
+namespace kc {
+
+void Graphics::ResourceLoader::enqueue(Task&& job)
+{
+    ++m_pending;
+
+    // Context thread never helps with loader jobs while it waits for frame jobs, without workers nobody else would run them
+    if (!m_jobs.workers())
+    {
+        job();
+        finish();
+        return;
+    }
+
+    m_jobs.run(m_counter, [this, job = std::move(job)]()
+    {
+        if (!m_stopping)
+            job();
+        finish();
+    });
+}
+
+void Graphics::ResourceLoader::upload(Task&& task)
+{
+    ++m_pending;
+    std::lock_guard lock(m_uploadsMutex);
+    m_uploads.push_back(std::move(task));
+}
+
+void Graphics::ResourceLoader::finish()
+{
+    --m_pending;
+}
+
+Graphics::ResourceLoader::ResourceLoader(JobSystem& jobs, float uploadBudget)
+    : m_logger(Utility::CreateLogger("loader"))
+    , m_jobs(jobs)
+    , m_stopping(false)
+    , m_pending(0)
+    , m_uploadBudget(uploadBudget)
+{}
+
+Graphics::ResourceLoader::~ResourceLoader()
+{
+    // Queued jobs still hold the loader, they're emptied out instead of dropped
+    m_stopping = true;
+    m_jobs.wait(m_counter);
+}
+
+Graphics::Texture::Pointer Graphics::ResourceLoader::loadTexture(Texture::Type type, const std::string& imageFilePath, int format, bool verticalFlip)
+{
+    if (Texture::Pointer texture = TextureCache::Find(type, imageFilePath, format, verticalFlip))
+        return texture;
+
+    // Jobs only hold weak references, so resources are always destroyed on context thread
+    Texture::Pointer texture = std::make_shared<Texture>(type);
+    TextureCache::Insert(type, imageFilePath, format, verticalFlip, texture);
+    std::weak_ptr<Texture> weakTexture = texture;
+    enqueue([this, weakTexture, imageFilePath, format, verticalFlip]()
+    {
+        try
+        {
+            auto image = std::make_shared<Texture::Source>(Texture::ReadSource(imageFilePath, verticalFlip));
+            upload([weakTexture, image, format]()
+            {
+                if (Texture::Pointer texture = weakTexture.lock())
+                {
+                    texture->upload(*image, format);
+                    TextureCache::Trim();
+                }
+            });
+        }
+        catch (const std::exception& error)
+        {
+            m_logger.error("Couldn't load texture: {}", error.what());
+        }
+    });
+    return texture;
+}
+
+std::shared_ptr<Graphics::ShaderProgram> Graphics::ResourceLoader::loadShaderProgram(const std::string& vertexShaderFilePath, const std::string& fragmentShaderFilePath)
+{
+    auto shaderProgram = std::make_shared<ShaderProgram>();
+    std::weak_ptr<ShaderProgram> weakShaderProgram = shaderProgram;
+    enqueue([this, weakShaderProgram, vertexShaderFilePath, fragmentShaderFilePath]()
+    {
+        try
+        {
+            auto sources = std::make_shared<std::pair<std::string, std::string>>(
+                ShaderProgram::ReadFile(vertexShaderFilePath),
+                ShaderProgram::ReadFile(fragmentShaderFilePath)
+            );
+
+            upload([this, weakShaderProgram, sources]()
+            {
+                std::shared_ptr<ShaderProgram> shaderProgram = weakShaderProgram.lock();
+                if (!shaderProgram)
+                    return;
+
+                try
+                {
+                    shaderProgram->compile(sources->first, sources->second);
+                }
+                catch (const std::exception& error)
+                {
+                    m_logger.error("Couldn't build shader program: {}", error.what());
+                }
+            });
+        }
+        catch (const std::exception& error)
+        {
+            m_logger.error("Couldn't load shader program: {}", error.what());
+        }
+    });
+    return shaderProgram;
+}
+
+std::shared_ptr<Graphics::Model> Graphics::ResourceLoader::loadModel(const std::string& modelFilePath, Mesh::Residency residency, VertexFormat format)
+{
+    auto model = std::make_shared<Model>();
+    model->setResidency(residency);
+    model->setVertexFormat(format);
+    std::weak_ptr<Model> weakModel = model;
+    enqueue([this, weakModel, modelFilePath]()
+    {
+        std::shared_ptr<const Model::Geometry> geometry;
+        try
+        {
+            geometry = std::make_shared<const Model::Geometry>(Model::ReadGeometry(modelFilePath, m_logger));
+        }
+        catch (const std::exception& error)
+        {
+            m_logger.error("Couldn't load model: {}", error.what());
+            return;
+        }
+
+        upload([this, weakModel, geometry]()
+        {
+            std::shared_ptr<Model> model = weakModel.lock();
+            if (!model)
+                return;
+
+            // Textures stream in on their own, meshes show placeholders until then
+            model->prepare(*geometry);
+            Model::Textures textures;
+            for (const MeshCache::TextureReference& reference : Model::UniqueTextures(*geometry))
+                textures[reference.filename] = loadTexture(reference.type, geometry->directory + '/' + reference.filename, GL_RGB, true);
+            model->attachTextures(*geometry, std::move(textures));
+
+            // One upload per mesh, so a large model is spread over several frames
+            for (size_t index = 0, size = geometry->entries.size(); index < size; ++index)
+            {
+                upload([weakModel, geometry, index]()
+                {
+                    if (std::shared_ptr<Model> model = weakModel.lock())
+                        model->createMesh(index, geometry->entries[index]);
+                });
+            }
+        });
+    });
+    return model;
+}
+
+size_t Graphics::ResourceLoader::drain()
+{
+    using clock = std::chrono::steady_clock;
+    clock::time_point deadline = clock::now() + std::chrono::duration_cast<clock::duration>(std::chrono::duration<float, std::milli>(m_uploadBudget));
+
+    size_t count = 0;
+    do
+    {
+        Task task;
+        {
+            std::lock_guard lock(m_uploadsMutex);
+            if (m_uploads.empty())
+                break;
+
+            task = std::move(m_uploads.front());
+            m_uploads.pop_front();
+        }
+
+        task();
+        finish();
+        ++count;
+    } while (clock::now() < deadline);
+    return count;
+}
+
+} // namespace kc
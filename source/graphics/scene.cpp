@@ -0,0 +1,238 @@
+#include "graphics/scene.hpp"
+using namespace kc::Graphics::SceneConst;
+
+namespace kc {
+
+Graphics::BoundingBox Graphics::Scene::ContentBox(const Node& node)
+{
+    if (const std::shared_ptr<Model>* model = std::get_if<std::shared_ptr<Model>>(&node.content))
+        return (*model)->boundingBox().transformed(node.world * (*model)->transform().matrix());
+    if (const std::shared_ptr<Cube>* cube = std::get_if<std::shared_ptr<Cube>>(&node.content))
+        return (*cube)->boundingBox().transformed(node.world * (*cube)->transform().matrix());
+    return BoundingBox();
+}
+
+Graphics::Scene::Node& Graphics::Scene::at(NodeId node, const char* function)
+{
+    if (node >= m_nodes.size())
+        throw std::runtime_error(fmt::format("kc::Graphics::Scene::{}(): Node {} doesn't exist", function, node));
+    return m_nodes[node];
+}
+
+Graphics::Scene::Scene()
+    : m_structure(0)
+    , m_rebuild(false)
+{
+    m_nodes.push_back({ None, {}, Transform(), glm::mat4(1.0f), {}, BvhConst::Invalid, false });
+}
+
+Graphics::Scene::NodeId Graphics::Scene::add(NodeId parent, const Transform& transform, Content content)
+{
+    at(parent, "add");
+    NodeId node = static_cast<NodeId>(m_nodes.size());
+    m_nodes[parent].children.push_back(node);
+
+    uint32_t object = BvhConst::Invalid;
+    if (!std::holds_alternative<std::monostate>(content))
+    {
+        object = static_cast<uint32_t>(m_objects.size());
+        m_objects.push_back(node);
+        m_boxes.emplace_back();
+        m_rebuild = true;
+
+        // Model bounds are unknown until it is prepared, so its box is rechecked until it is ready
+        if (std::holds_alternative<std::shared_ptr<Model>>(content))
+            m_pending.push_back(node);
+    }
+
+    ++m_structure;
+    m_nodes.push_back({ parent, {}, transform, glm::mat4(1.0f), std::move(content), object, true });
+    m_dirty.push_back(node);
+    return node;
+}
+
+void Graphics::Scene::setTransform(NodeId node, const Transform& transform)
+{
+    Node& moved = at(node, "setTransform");
+    moved.transform = transform;
+    if (!moved.dirty)
+    {
+        moved.dirty = true;
+        m_dirty.push_back(node);
+    }
+}
+
+void Graphics::Scene::submitObject(RenderQueue& queue, uint32_t object, ShaderProgram& shaderProgram, const Camera& camera, unsigned int condition) const
+{
+    const Node& node = m_nodes[m_objects[object]];
+    if (const std::shared_ptr<Model>* model = std::get_if<std::shared_ptr<Model>>(&node.content))
+        (*model)->submit(queue, shaderProgram, camera, node.world, condition);
+    else if (const std::shared_ptr<Cube>* cube = std::get_if<std::shared_ptr<Cube>>(&node.content))
+        (*cube)->submit(queue, shaderProgram, camera, node.world, condition);
+}
+
+void Graphics::Scene::updateSubtree(NodeId root, std::vector<NodeId>& stack, std::vector<uint32_t>& moved)
+{
+    stack.push_back(root);
+    while (!stack.empty())
+    {
+        Node& node = m_nodes[stack.back()];
+        stack.pop_back();
+
+        node.world = m_nodes[node.parent].world * node.transform.matrix();
+        if (node.object != BvhConst::Invalid)
+        {
+            m_boxes[node.object] = ContentBox(node);
+            moved.push_back(node.object);
+        }
+        stack.insert(stack.end(), node.children.begin(), node.children.end());
+    }
+}
+
+void Graphics::Scene::update(JobSystem* jobs)
+{
+    // Nodes below other moved nodes are updated with them, so the remaining subtrees never overlap
+    m_roots.clear();
+    for (NodeId dirty : m_dirty)
+    {
+        NodeId ancestor = m_nodes[dirty].parent;
+        while (ancestor != None && !m_nodes[ancestor].dirty)
+            ancestor = m_nodes[ancestor].parent;
+        if (ancestor == None)
+            m_roots.push_back(dirty);
+    }
+
+    if (jobs && m_roots.size() > UpdateGrain)
+    {
+        m_chunkMoved.resize((m_roots.size() + UpdateGrain - 1) / UpdateGrain);
+        jobs->parallelFor(m_roots.size(), UpdateGrain, [this](size_t begin, size_t end)
+        {
+            std::vector<NodeId> stack;
+            std::vector<uint32_t>& moved = m_chunkMoved[begin / UpdateGrain];
+            moved.clear();
+            for (size_t root = begin; root < end; ++root)
+                updateSubtree(m_roots[root], stack, moved);
+        });
+
+        for (const std::vector<uint32_t>& moved : m_chunkMoved)
+            m_moved.insert(m_moved.end(), moved.begin(), moved.end());
+    }
+    else
+    {
+        std::vector<NodeId> stack;
+        for (NodeId root : m_roots)
+            updateSubtree(root, stack, m_moved);
+    }
+
+    for (NodeId dirty : m_dirty)
+        m_nodes[dirty].dirty = false;
+    m_dirty.clear();
+
+    for (size_t index = 0; index < m_pending.size();)
+    {
+        const Node& node = m_nodes[m_pending[index]];
+        m_boxes[node.object] = ContentBox(node);
+        m_moved.push_back(node.object);
+
+        if (std::get<std::shared_ptr<Model>>(node.content)->ready())
+        {
+            m_pending[index] = m_pending.back();
+            m_pending.pop_back();
+            continue;
+        }
+        ++index;
+    }
+
+    // Structure only changes when objects are added, otherwise moved boxes are refitted in place
+    if (m_rebuild)
+        m_bvh.build(m_boxes);
+    else if (m_moved.size() > m_objects.size() * RefitRatio)
+        m_bvh.refit(m_boxes);
+    else
+    {
+        for (uint32_t object : m_moved)
+            m_bvh.update(object, m_boxes[object]);
+    }
+    m_rebuild = false;
+    m_moved.clear();
+}
+
+void Graphics::Scene::snapshot(Scene& target) const
+{
+    // Nodes own children lists and content references, copy them only when the structure changed
+    if (target.m_structure != m_structure || target.m_nodes.size() != m_nodes.size())
+    {
+        target.m_nodes = m_nodes;
+        target.m_objects = m_objects;
+        target.m_structure = m_structure;
+    }
+    else
+    {
+        for (size_t index = 0, size = m_nodes.size(); index < size; ++index)
+        {
+            target.m_nodes[index].transform = m_nodes[index].transform;
+            target.m_nodes[index].world = m_nodes[index].world;
+        }
+    }
+
+    // Same sizes reuse target storage, so steady frames copy without allocating
+    target.m_boxes = m_boxes;
+    target.m_bvh = m_bvh;
+}
+
+void Graphics::Scene::submit(RenderQueue& queue, ShaderProgram& shaderProgram, const Camera& camera, OcclusionCuller* occlusion, JobSystem* jobs) const
+{
+    if (occlusion)
+        occlusion->begin(m_objects.size());
+
+    // Hierarchy and occlusion bookkeeping aren't shared between threads, they run first
+    m_visible.clear();
+    m_conditions.clear();
+    m_bvh.cull(camera.frustum(), [&](uint32_t object)
+    {
+        m_visible.push_back(object);
+        m_conditions.push_back(occlusion ? occlusion->condition(object, m_boxes[object], camera) : 0);
+    });
+
+    if (!jobs || m_visible.size() <= SubmitGrain)
+    {
+        for (size_t index = 0; index < m_visible.size(); ++index)
+            submitObject(queue, m_visible[index], shaderProgram, camera, m_conditions[index]);
+        return;
+    }
+
+    // Every job fills a queue of its own, merged in a fixed order so the frame doesn't depend on scheduling
+    m_chunkQueues.resize((m_visible.size() + SubmitGrain - 1) / SubmitGrain);
+    jobs->parallelFor(m_visible.size(), SubmitGrain, [&](size_t begin, size_t end)
+    {
+        RenderQueue& chunk = m_chunkQueues[begin / SubmitGrain];
+        for (size_t index = begin; index < end; ++index)
+            submitObject(chunk, m_visible[index], shaderProgram, camera, m_conditions[index]);
+    });
+
+    for (RenderQueue& chunk : m_chunkQueues)
+        queue.append(chunk);
+}
+
+Graphics::Scene::NodeId Graphics::Scene::pick(const glm::vec3& origin, const glm::vec3& direction) const
+{
+    float distance = 0.0f;
+    uint32_t object = m_bvh.raycast(origin, direction, distance);
+    return object == BvhConst::Invalid ? None : m_objects[object];
+}
+
+void Graphics::Scene::query(const BoundingSphere& sphere, const Visitor& visitor) const
+{
+    BoundingBox box = { sphere.center - sphere.radius, sphere.center + sphere.radius };
+    m_bvh.query(box, [&](uint32_t object)
+    {
+        // Box overlap is coarse, drop objects whose boxes are out of sphere reach
+        const BoundingBox& objectBox = m_boxes[object];
+        glm::vec3 closest = glm::clamp(sphere.center, objectBox.minimum, objectBox.maximum);
+        glm::vec3 offset = closest - sphere.center;
+        if (glm::dot(offset, offset) <= sphere.radius * sphere.radius)
+            visitor(m_objects[object]);
+    });
+}
+
+} // namespace kc
@@ -67,6 +67,55 @@ unsigned int Graphics::ShaderProgram::LinkShaderProgram(unsigned int vertexShade
     ));
 }
 
+Graphics::ShaderProgram::Uniforms Graphics::ShaderProgram::ReadUniforms(unsigned int program)
+{
+    int count = 0, maxNameLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+    Uniforms uniforms;
+    uniforms.reserve(count);
+    std::string name(maxNameLength, '\0');
+    for (int index = 0; index < count; ++index)
+    {
+        int length = 0, size = 0;
+        unsigned int type = 0;
+        glGetActiveUniform(program, index, maxNameLength, &length, &size, &type, name.data());
+
+        // Uniform block members don't have locations
+        int location = glGetUniformLocation(program, name.c_str());
+        if (location == InvalidHandle)
+            continue;
+
+        // Arrays are reported as "uName[0]", strip subscript and "u" prefix
+        std::string_view key(name.data(), length);
+        if (key.ends_with("[0]"))
+            key.remove_suffix(3);
+        if (key.starts_with('u'))
+            key.remove_prefix(1);
+        uniforms.emplace(key, location);
+    }
+    return uniforms;
+}
+
+void Graphics::ShaderProgram::BindUniformBlocks(unsigned int program)
+{
+    int count = 0, maxNameLength = 0;
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(program, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxNameLength);
+
+    std::string name(maxNameLength, '\0');
+    for (int index = 0; index < count; ++index)
+    {
+        int length = 0;
+        glGetActiveUniformBlockName(program, index, maxNameLength, &length, name.data());
+
+        std::optional<UniformBuffer::Binding> binding = UniformBuffer::BlockBinding({ name.data(), static_cast<size_t>(length) });
+        if (binding)
+            glUniformBlockBinding(program, index, static_cast<unsigned int>(*binding));
+    }
+}
+
 void Graphics::ShaderProgram::free(bool freeProgram)
 {
     if (m_vertexShader)
@@ -83,8 +132,10 @@ void Graphics::ShaderProgram::free(bool freeProgram)
 
     if (freeProgram && m_shaderProgram)
     {
+        StateCache::ForgetProgram(m_shaderProgram);
         glDeleteProgram(m_shaderProgram);
         m_shaderProgram = 0;
+        m_uniforms.clear();
     }
 }
 
@@ -101,92 +152,149 @@ Graphics::ShaderProgram::~ShaderProgram()
 
 void Graphics::ShaderProgram::make(const std::string& vertexShaderFilePath, const std::string& fragmentShaderFilePath)
 {
-    free(); // avoid memory leaks if make() was called already
-    m_vertexShader = CompileShader(ReadFile(vertexShaderFilePath).c_str(), GL_VERTEX_SHADER);
-    m_fragmentShader = CompileShader(ReadFile(fragmentShaderFilePath).c_str(), GL_FRAGMENT_SHADER);
+    compile(ReadFile(vertexShaderFilePath), ReadFile(fragmentShaderFilePath));
+}
+
+void Graphics::ShaderProgram::compile(const std::string& vertexShaderSource, const std::string& fragmentShaderSource)
+{
+    free(); // avoid memory leaks if make() or compile() was called already
+    m_vertexShader = CompileShader(vertexShaderSource.c_str(), GL_VERTEX_SHADER);
+    m_fragmentShader = CompileShader(fragmentShaderSource.c_str(), GL_FRAGMENT_SHADER);
     m_shaderProgram = LinkShaderProgram(m_vertexShader, m_fragmentShader);
+    m_uniforms = ReadUniforms(m_shaderProgram);
+    BindUniformBlocks(m_shaderProgram);
     free(false);
 }
 
 void Graphics::ShaderProgram::use() const
 {
-    glUseProgram(m_shaderProgram);
+    StateCache::UseProgram(m_shaderProgram);
+}
+
+Graphics::ShaderProgram::UniformHandle Graphics::ShaderProgram::uniform(std::string_view name) const
+{
+    auto entry = m_uniforms.find(name);
+    return entry == m_uniforms.end() ? InvalidHandle : entry->second;
+}
+
+Graphics::ShaderProgram::UniformHandle Graphics::ShaderProgram::uniform(std::string_view name, std::string_view member) const
+{
+    // Reuse buffer to avoid allocating on every struct member lookup
+    m_nameBuffer.assign(name);
+    m_nameBuffer += '.';
+    m_nameBuffer += member;
+    return uniform(m_nameBuffer);
 }
 
-void Graphics::ShaderProgram::set(const std::string& name, bool boolean)
+void Graphics::ShaderProgram::set(UniformHandle handle, bool boolean)
 {
     use();
-    int location = glGetUniformLocation(m_shaderProgram, ('u' + name).c_str());
-    glUniform1i(location, static_cast<int>(boolean));
+    glUniform1i(handle, static_cast<int>(boolean));
 }
 
-void Graphics::ShaderProgram::set(const std::string& name, int integer)
+void Graphics::ShaderProgram::set(UniformHandle handle, int integer)
 {
     use();
-    int location = glGetUniformLocation(m_shaderProgram, ('u' + name).c_str());
-    glUniform1i(location, integer);
+    glUniform1i(handle, integer);
 }
 
-void Graphics::ShaderProgram::set(const std::string& name, float real)
+void Graphics::ShaderProgram::set(UniformHandle handle, float real)
 {
     use();
-    int location = glGetUniformLocation(m_shaderProgram, ('u' + name).c_str());
-    glUniform1f(location, real);
+    glUniform1f(handle, real);
 }
 
-void Graphics::ShaderProgram::set(const std::string& name, const glm::vec3& vector)
+void Graphics::ShaderProgram::set(UniformHandle handle, const glm::vec3& vector)
 {
     use();
-    int location = glGetUniformLocation(m_shaderProgram, ('u' + name).c_str());
-    glUniform3fv(location, 1, glm::value_ptr(vector));
+    glUniform3fv(handle, 1, glm::value_ptr(vector));
 }
 
-void Graphics::ShaderProgram::set(const std::string& name, const glm::mat4& matrix)
+void Graphics::ShaderProgram::set(UniformHandle handle, const glm::mat4& matrix)
 {
     use();
-    int location = glGetUniformLocation(m_shaderProgram, ('u' + name).c_str());
-    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(matrix));
+    glUniformMatrix4fv(handle, 1, GL_FALSE, glm::value_ptr(matrix));
+}
+
+void Graphics::ShaderProgram::set(UniformHandle handle, const glm::mat3& matrix)
+{
+    use();
+    glUniformMatrix3fv(handle, 1, GL_FALSE, glm::value_ptr(matrix));
+}
+
+void Graphics::ShaderProgram::set(UniformHandle handle, Color color)
+{
+    set(handle, glm::vec3(color.red / 255.0f, color.green / 255.0f, color.blue / 255.0f));
+}
+
+void Graphics::ShaderProgram::set(UniformHandle handle, const Texture& texture, int id)
+{
+    StateCache::BindTexture(id, texture.id());
+    set(handle, id);
+}
+
+void Graphics::ShaderProgram::set(std::string_view name, bool boolean)
+{
+    set(uniform(name), boolean);
+}
+
+void Graphics::ShaderProgram::set(std::string_view name, int integer)
+{
+    set(uniform(name), integer);
+}
+
+void Graphics::ShaderProgram::set(std::string_view name, float real)
+{
+    set(uniform(name), real);
+}
+
+void Graphics::ShaderProgram::set(std::string_view name, const glm::vec3& vector)
+{
+    set(uniform(name), vector);
+}
+
+void Graphics::ShaderProgram::set(std::string_view name, const glm::mat4& matrix)
+{
+    set(uniform(name), matrix);
 }
 
-void Graphics::ShaderProgram::set(const std::string& name, Color color)
+void Graphics::ShaderProgram::set(std::string_view name, Color color)
 {
-    set(name, glm::vec3(color.red / 255.0f, color.green / 255.0f, color.blue / 255.0f));
+    set(uniform(name), color);
 }
 
-void Graphics::ShaderProgram::set(const std::string& name, const LightAttenuation& attenuation)
+void Graphics::ShaderProgram::set(std::string_view name, const LightAttenuation& attenuation)
 {
-    set(name + ".constant", attenuation.constant);
-    set(name + ".linear", attenuation.linear);
-    set(name + ".quadratic", attenuation.quadratic);
+    set(uniform(name, "constant"), attenuation.constant);
+    set(uniform(name, "linear"), attenuation.linear);
+    set(uniform(name, "quadratic"), attenuation.quadratic);
 }
 
-void Graphics::ShaderProgram::set(const std::string& name, const LightCutoff& cutoff)
+void Graphics::ShaderProgram::set(std::string_view name, const LightCutoff& cutoff)
 {
-    set(name + ".inner", glm::cos(glm::radians(cutoff.inner)));
-    set(name + ".outer", glm::cos(glm::radians(cutoff.outer)));
+    set(uniform(name, "inner"), glm::cos(glm::radians(cutoff.inner)));
+    set(uniform(name, "outer"), glm::cos(glm::radians(cutoff.outer)));
 }
 
-void Graphics::ShaderProgram::set(const std::string& name, const LightProperties& properties)
+void Graphics::ShaderProgram::set(std::string_view name, const LightProperties& properties)
 {
-    set(name + ".ambient", properties.ambient);
-    set(name + ".diffuse", properties.diffuse);
-    set(name + ".specular", properties.specular);
+    set(uniform(name, "ambient"), properties.ambient);
+    set(uniform(name, "diffuse"), properties.diffuse);
+    set(uniform(name, "specular"), properties.specular);
 }
 
-void Graphics::ShaderProgram::set(const std::string& name, const Material& material)
+void Graphics::ShaderProgram::set(std::string_view name, const Material& material)
 {
     if (material.diffuse)
-        set(name + ".diffuse", *material.diffuse, 0);
+        set(uniform(name, "diffuse"), *material.diffuse, 0);
     if (material.specular)
-        set(name + ".specular", *material.specular, 1);
-    set(name + ".shininess", material.shininess);
+        set(uniform(name, "specular"), *material.specular, 1);
+    set(uniform(name, "shininess"), material.shininess);
 }
 
-void Graphics::ShaderProgram::set(const std::string& name, const Texture& texture, int id)
+void Graphics::ShaderProgram::set(std::string_view name, const Texture& texture, int id)
 {
-    glActiveTexture(GL_TEXTURE0 + id);
-    texture.bind();
-    set(name, id);
+    set(uniform(name), texture, id);
 }
 
 } // namespace kc
@@ -0,0 +1,280 @@
+#include "graphics/state_cache.hpp"
+using namespace kc::Graphics::StateCacheConst;
+
+namespace kc {
+
+namespace StateData
+{
+    /// @brief Value that never matches real GL state
+    constexpr unsigned int Unknown = ~0u;
+
+    /// @brief Non-indexed buffer targets tracked by the cache
+    constexpr unsigned int BufferTargets[] = {
+        GL_ARRAY_BUFFER,
+        GL_UNIFORM_BUFFER,
+        GL_TEXTURE_BUFFER,
+        GL_COPY_READ_BUFFER,
+        GL_COPY_WRITE_BUFFER,
+    };
+    constexpr size_t BufferTargetCount = sizeof(BufferTargets) / sizeof(BufferTargets[0]);
+
+    /// @brief Get cache slot of buffer target
+    /// @param target Buffer target
+    /// @return Slot index or BufferTargetCount if target is not tracked
+    size_t BufferTargetSlot(unsigned int target)
+    {
+        for (size_t slot = 0; slot < BufferTargetCount; ++slot)
+        {
+            if (BufferTargets[slot] == target)
+                return slot;
+        }
+        return BufferTargetCount;
+    }
+
+    struct State
+    {
+        unsigned int program = Unknown;
+        unsigned int activeTexture = Unknown;
+        unsigned int textures[TextureUnits] = {};
+        unsigned int textureBuffers[TextureUnits] = {};
+        unsigned int buffers[BufferTargetCount] = {};
+        unsigned int vertexArray = Unknown;
+        int polygonMode = -1;
+        int depthTest = -1;
+        int depthFunction = -1;
+        int depthMask = -1;
+        int colorMask = -1;
+        Graphics::StateCache::Statistics statistics;
+    };
+
+    /// @brief Cached state of the one and only GL context
+    State Current;
+
+    /// @brief Update cached value and count the call
+    /// @param cached Cached value
+    /// @param value New value
+    /// @return True if the call must be issued
+    template <typename Type>
+    bool Change(Type& cached, Type value)
+    {
+        if (cached == value)
+        {
+            ++Current.statistics.elided;
+            return false;
+        }
+
+        cached = value;
+        ++Current.statistics.issued;
+        return true;
+    }
+}
+
+void Graphics::StateCache::Invalidate()
+{
+    Statistics statistics = StateData::Current.statistics;
+    StateData::Current = {};
+    for (unsigned int& texture : StateData::Current.textures)
+        texture = StateData::Unknown;
+    for (unsigned int& texture : StateData::Current.textureBuffers)
+        texture = StateData::Unknown;
+    for (unsigned int& buffer : StateData::Current.buffers)
+        buffer = StateData::Unknown;
+    StateData::Current.statistics = statistics;
+}
+
+void Graphics::StateCache::UseProgram(unsigned int program)
+{
+    if (StateData::Change(StateData::Current.program, program))
+        glUseProgram(program);
+}
+
+void Graphics::StateCache::ActiveTexture(unsigned int unit)
+{
+    if (StateData::Change(StateData::Current.activeTexture, unit))
+        glActiveTexture(GL_TEXTURE0 + unit);
+}
+
+void Graphics::StateCache::BindTexture(unsigned int unit, unsigned int texture)
+{
+    if (unit >= TextureUnits)
+    {
+        ActiveTexture(unit);
+        glBindTexture(GL_TEXTURE_2D, texture);
+        ++StateData::Current.statistics.issued;
+        return;
+    }
+
+    if (StateData::Current.textures[unit] == texture)
+    {
+        ++StateData::Current.statistics.elided;
+        return;
+    }
+
+    ActiveTexture(unit);
+    BindTexture(texture);
+}
+
+void Graphics::StateCache::BindTexture(unsigned int texture)
+{
+    unsigned int unit = StateData::Current.activeTexture;
+    if (unit >= TextureUnits)
+    {
+        // Active unit is unknown or untracked, make it known first
+        ActiveTexture(0);
+        unit = 0;
+    }
+
+    if (StateData::Change(StateData::Current.textures[unit], texture))
+        glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void Graphics::StateCache::BindTextureBuffer(unsigned int unit, unsigned int texture)
+{
+    if (unit >= TextureUnits)
+    {
+        ActiveTexture(unit);
+        glBindTexture(GL_TEXTURE_BUFFER, texture);
+        ++StateData::Current.statistics.issued;
+        return;
+    }
+
+    if (StateData::Current.textureBuffers[unit] == texture)
+    {
+        ++StateData::Current.statistics.elided;
+        return;
+    }
+
+    ActiveTexture(unit);
+    StateData::Current.textureBuffers[unit] = texture;
+    glBindTexture(GL_TEXTURE_BUFFER, texture);
+    ++StateData::Current.statistics.issued;
+}
+
+void Graphics::StateCache::BindBuffer(unsigned int target, unsigned int buffer)
+{
+    size_t slot = StateData::BufferTargetSlot(target);
+    if (slot == StateData::BufferTargetCount)
+    {
+        glBindBuffer(target, buffer);
+        ++StateData::Current.statistics.issued;
+        return;
+    }
+
+    if (StateData::Change(StateData::Current.buffers[slot], buffer))
+        glBindBuffer(target, buffer);
+}
+
+void Graphics::StateCache::BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer)
+{
+    // Indexed bind also replaces generic binding of the target
+    glBindBufferBase(target, index, buffer);
+    ++StateData::Current.statistics.issued;
+
+    size_t slot = StateData::BufferTargetSlot(target);
+    if (slot != StateData::BufferTargetCount)
+        StateData::Current.buffers[slot] = buffer;
+}
+
+void Graphics::StateCache::BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, size_t offset, size_t size)
+{
+    // Ranges move every draw, nothing to elide
+    glBindBufferRange(target, index, buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+    ++StateData::Current.statistics.issued;
+
+    size_t slot = StateData::BufferTargetSlot(target);
+    if (slot != StateData::BufferTargetCount)
+        StateData::Current.buffers[slot] = buffer;
+}
+
+void Graphics::StateCache::BindVertexArray(unsigned int vertexArray)
+{
+    if (StateData::Change(StateData::Current.vertexArray, vertexArray))
+        glBindVertexArray(vertexArray);
+}
+
+void Graphics::StateCache::PolygonMode(int mode)
+{
+    if (StateData::Change(StateData::Current.polygonMode, mode))
+        glPolygonMode(GL_FRONT_AND_BACK, mode);
+}
+
+void Graphics::StateCache::DepthTest(bool enabled)
+{
+    if (!StateData::Change(StateData::Current.depthTest, static_cast<int>(enabled)))
+        return;
+
+    if (enabled)
+        glEnable(GL_DEPTH_TEST);
+    else
+        glDisable(GL_DEPTH_TEST);
+}
+
+void Graphics::StateCache::DepthFunction(int function)
+{
+    if (StateData::Change(StateData::Current.depthFunction, function))
+        glDepthFunc(function);
+}
+
+void Graphics::StateCache::DepthMask(bool enabled)
+{
+    if (StateData::Change(StateData::Current.depthMask, static_cast<int>(enabled)))
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+}
+
+void Graphics::StateCache::ColorMask(bool enabled)
+{
+    if (StateData::Change(StateData::Current.colorMask, static_cast<int>(enabled)))
+        glColorMask(enabled, enabled, enabled, enabled);
+}
+
+void Graphics::StateCache::ForgetProgram(unsigned int program)
+{
+    // GL keeps deleted program in use until another one is used
+    if (StateData::Current.program == program)
+        StateData::Current.program = StateData::Unknown;
+}
+
+void Graphics::StateCache::ForgetTexture(unsigned int texture)
+{
+    // GL resets deleted texture bindings to 0
+    for (unsigned int& boundTexture : StateData::Current.textures)
+    {
+        if (boundTexture == texture)
+            boundTexture = 0;
+    }
+
+    for (unsigned int& boundTexture : StateData::Current.textureBuffers)
+    {
+        if (boundTexture == texture)
+            boundTexture = 0;
+    }
+}
+
+void Graphics::StateCache::ForgetBuffer(unsigned int buffer)
+{
+    // GL resets deleted buffer bindings to 0
+    for (unsigned int& boundBuffer : StateData::Current.buffers)
+    {
+        if (boundBuffer == buffer)
+            boundBuffer = 0;
+    }
+}
+
+void Graphics::StateCache::ForgetVertexArray(unsigned int vertexArray)
+{
+    // GL resets deleted vertex array binding to 0
+    if (StateData::Current.vertexArray == vertexArray)
+        StateData::Current.vertexArray = 0;
+}
+
+Graphics::StateCache::Statistics Graphics::StateCache::GetStatistics()
+{
+    return StateData::Current.statistics;
+}
+
+void Graphics::StateCache::ResetStatistics()
+{
+    StateData::Current.statistics = {};
+}
+
+} // namespace kc
@@ -0,0 +1,181 @@
+#include "graphics/stream_buffer.hpp"
+using namespace kc::Graphics::StreamBufferConst;
+
+namespace kc {
+
+void Graphics::StreamBuffer::free()
+{
+    for (GLsync& fence : m_fences)
+    {
+        if (fence)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    if (m_buffer)
+    {
+        // Deleting a mapped buffer unmaps it
+        StateCache::ForgetBuffer(m_buffer);
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+    }
+
+    m_persistent = nullptr;
+    m_regionSize = 0;
+    m_region = Frames - 1;
+    m_head = 0;
+    m_mapped = false;
+}
+
+Graphics::StreamBuffer::StreamBuffer()
+    : m_buffer(0)
+    , m_persistent(nullptr)
+    , m_fences{}
+    , m_regionSize(0)
+    , m_region(Frames - 1)
+    , m_head(0)
+    , m_uniformAlignment(1)
+    , m_mapped(false)
+{}
+
+Graphics::StreamBuffer::StreamBuffer(StreamBuffer&& other) noexcept
+    : m_buffer(other.m_buffer)
+    , m_persistent(other.m_persistent)
+    , m_regionSize(other.m_regionSize)
+    , m_region(other.m_region)
+    , m_head(other.m_head)
+    , m_uniformAlignment(other.m_uniformAlignment)
+    , m_mapped(other.m_mapped)
+    , m_statistics(other.m_statistics)
+{
+    for (size_t region = 0; region < Frames; ++region)
+    {
+        m_fences[region] = other.m_fences[region];
+        other.m_fences[region] = nullptr;
+    }
+
+    other.m_buffer = 0;
+    other.m_persistent = nullptr;
+    other.m_regionSize = 0;
+    other.m_mapped = false;
+}
+
+Graphics::StreamBuffer::~StreamBuffer()
+{
+    free();
+}
+
+void Graphics::StreamBuffer::create(size_t regionSize)
+{
+    free(); // avoid memory leaks if create() was called already
+
+    int alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    m_uniformAlignment = std::max(alignment, 1);
+    m_regionSize = (regionSize + m_uniformAlignment - 1) / m_uniformAlignment * m_uniformAlignment;
+    m_statistics = {};
+
+    glGenBuffers(1, &m_buffer);
+    StateCache::BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    if (GLEW_ARB_buffer_storage)
+    {
+        // Coherent mapping makes plain memory writes visible to the next draw without flushes
+        GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        glBufferStorage(GL_COPY_WRITE_BUFFER, m_regionSize * Frames, nullptr, flags);
+        m_persistent = static_cast<uint8_t*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, m_regionSize * Frames, flags));
+        if (!m_persistent)
+        {
+            free();
+            throw std::runtime_error("kc::Graphics::StreamBuffer::create(): Couldn't map buffer persistently");
+        }
+    }
+    else
+    {
+        glBufferData(GL_COPY_WRITE_BUFFER, m_regionSize * Frames, nullptr, GL_STREAM_DRAW);
+    }
+}
+
+void Graphics::StreamBuffer::begin()
+{
+    m_region = (m_region + 1) % Frames;
+    m_head = 0;
+    m_statistics.written = 0;
+
+    GLsync& fence = m_fences[m_region];
+    if (!fence)
+        return;
+
+    // Fences of frames a ring ago have almost always signaled, poll before counting a wait
+    GLenum result = glClientWaitSync(fence, 0, 0);
+    if (result == GL_TIMEOUT_EXPIRED)
+    {
+        ++m_statistics.waits;
+        do
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, WaitTimeout);
+        while (result == GL_TIMEOUT_EXPIRED);
+    }
+    glDeleteSync(fence);
+    fence = nullptr;
+
+    if (result == GL_WAIT_FAILED)
+        throw std::runtime_error("kc::Graphics::StreamBuffer::begin(): Couldn't wait for frame region fence");
+}
+
+void Graphics::StreamBuffer::end()
+{
+    m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
+
+Graphics::StreamBuffer::Mapping Graphics::StreamBuffer::map(size_t size, size_t alignment)
+{
+    size_t head = (m_head + alignment - 1) / alignment * alignment;
+    if (head + size > m_regionSize)
+    {
+        throw std::runtime_error(fmt::format(
+            "kc::Graphics::StreamBuffer::map(): {} bytes don't fit in frame region, {} of {} bytes are used",
+            size, m_head, m_regionSize
+        ));
+    }
+
+    size_t offset = m_region * m_regionSize + head;
+    m_head = head + size;
+    m_statistics.written += size;
+    if (m_persistent)
+        return { m_persistent + offset, offset };
+
+    // Range is fenced, driver mustn't wait for or copy the frames still reading the buffer
+    StateCache::BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    void* data = glMapBufferRange(GL_COPY_WRITE_BUFFER, offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+    if (!data)
+        throw std::runtime_error(fmt::format("kc::Graphics::StreamBuffer::map(): Couldn't map {} bytes", size));
+
+    m_mapped = true;
+    return { static_cast<uint8_t*>(data), offset };
+}
+
+void Graphics::StreamBuffer::unmap()
+{
+    if (!m_mapped)
+        return;
+
+    StateCache::BindBuffer(GL_COPY_WRITE_BUFFER, m_buffer);
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    m_mapped = false;
+}
+
+size_t Graphics::StreamBuffer::write(const void* data, size_t size, size_t alignment)
+{
+    Mapping mapping = map(size, alignment);
+    std::memcpy(mapping.data, data, size);
+    unmap();
+    return mapping.offset;
+}
+
+void Graphics::StreamBuffer::bind(UniformBuffer::Binding binding, size_t offset, size_t size) const
+{
+    StateCache::BindBufferRange(GL_UNIFORM_BUFFER, static_cast<unsigned int>(binding), m_buffer, offset, size);
+}
+
+} // namespace kc
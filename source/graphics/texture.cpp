@@ -2,16 +2,81 @@
 
 namespace kc {
 
-unsigned int Graphics::Texture::LoadTexture(const std::string& imageFilePath, int format, bool verticalFlip)
+bool Graphics::Texture::Supported(unsigned int format)
 {
-    Image image(imageFilePath, verticalFlip);
+    switch (format)
+    {
+        case GL_COMPRESSED_RED_RGTC1:
+        case GL_COMPRESSED_SIGNED_RED_RGTC1:
+        case GL_COMPRESSED_RG_RGTC2:
+        case GL_COMPRESSED_SIGNED_RG_RGTC2:
+            return true; // core since OpenGL 3.0
+        case GL_COMPRESSED_RGBA_BPTC_UNORM:
+        case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            return GLEW_ARB_texture_compression_bptc;
+        default:
+            if (CompressedImage::BlockSize(format) == 0)
+                return false;
+            if (format >= GL_COMPRESSED_RGB8_ETC2 && format <= GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC)
+                return GLEW_ARB_ES3_compatibility;
+            if (format >= GL_COMPRESSED_R11_EAC && format <= GL_COMPRESSED_SIGNED_RG11_EAC)
+                return GLEW_ARB_ES3_compatibility;
+            return GLEW_EXT_texture_compression_s3tc;
+    }
+}
+
+Graphics::Texture::Source Graphics::Texture::ReadSource(const std::string& imageFilePath, bool verticalFlip)
+{
+    if (CompressedImage::IsContainer(imageFilePath))
+        return CompressedImage(imageFilePath);
+
+    // Prefer compressor output next to the image unless the image was changed after compressing
+    std::filesystem::path compressedFilePath = imageFilePath;
+    compressedFilePath.replace_extension();
+    compressedFilePath += verticalFlip ? CompressedImageConst::FlippedExtension : CompressedImageConst::Extension;
+
+    std::error_code error;
+    std::filesystem::file_time_type compressedTime = std::filesystem::last_write_time(compressedFilePath, error);
+    if (!error && compressedTime >= std::filesystem::last_write_time(imageFilePath, error) && !error)
+    {
+        try
+        {
+            CompressedImage image(compressedFilePath.string());
+            if (Supported(image.format()))
+                return image;
+        }
+        catch (const std::exception&)
+        {
+            // Broken compressed file, the source image is still fine
+        }
+    }
+
+    return Image(imageFilePath, verticalFlip);
+}
+
+size_t Graphics::Texture::Memory(int width, int height, int format)
+{
+    // Drivers pad RGB texels to four bytes, mipmaps add another third
+    size_t texelSize = (format == GL_RED ? 1 : (format == GL_RG ? 2 : 4));
+    return static_cast<size_t>(width) * height * texelSize * 4 / 3;
+}
+
+unsigned int Graphics::Texture::LoadPlaceholder()
+{
+    using namespace TextureConst::Placeholder;
+
+    uint8_t texels[Size][Size][4];
+    for (int y = 0; y < Size; ++y)
+    {
+        for (int x = 0; x < Size; ++x)
+            std::copy(std::begin(Colors[(x + y) % 2]), std::end(Colors[(x + y) % 2]), texels[y][x]);
+    }
 
     unsigned int texture;
     glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
-    glTexImage2D(GL_TEXTURE_2D, 0, format, image.width(), image.height(), 0, format, GL_UNSIGNED_BYTE, image.data());
+    StateCache::BindTexture(texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, Size, Size, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels);
     glGenerateMipmap(GL_TEXTURE_2D);
-    glBindTexture(GL_TEXTURE_2D, 0);
     return texture;
 }
 
@@ -19,24 +84,41 @@ void Graphics::Texture::free()
 {
     if (m_texture)
     {
+        StateCache::ForgetTexture(m_texture);
         glDeleteTextures(1, &m_texture);
         m_texture = 0;
     }
 }
 
+Graphics::Texture::Texture(Type type)
+    : m_texture(LoadPlaceholder())
+    , m_type(type)
+    , m_memory(Memory(TextureConst::Placeholder::Size, TextureConst::Placeholder::Size, GL_RGBA))
+{
+    setFiltering(GL_NEAREST);
+}
+
 Graphics::Texture::Texture(Type type, const std::string& imageFilePath, int format, bool verticalFlip)
-    : m_texture(LoadTexture(imageFilePath, format, verticalFlip))
+    : Texture(type, ReadSource(imageFilePath, verticalFlip), format)
+{}
+
+Graphics::Texture::Texture(Type type, const Source& source, int format)
+    : m_texture(0)
     , m_type(type)
+    , m_memory(0)
 {
-    setFiltering(GL_LINEAR);
+    glGenTextures(1, &m_texture);
+    upload(source, format);
 }
 
 Graphics::Texture::Texture(Texture&& other) noexcept
     : m_texture(other.m_texture)
     , m_type(other.m_type)
+    , m_memory(other.m_memory)
 {
     other.m_texture = 0;
     other.m_type = Type::None;
+    other.m_memory = 0;
 }
 
 Graphics::Texture::~Texture()
@@ -46,14 +128,41 @@ Graphics::Texture::~Texture()
 
 void Graphics::Texture::bind() const
 {
-    glBindTexture(GL_TEXTURE_2D, m_texture);
+    StateCache::BindTexture(m_texture);
+}
+
+void Graphics::Texture::upload(const Source& source, int format)
+{
+    bind();
+    if (const CompressedImage* compressed = std::get_if<CompressedImage>(&source))
+    {
+        // Mipmap chain comes precomputed, nothing to generate
+        const std::vector<CompressedImage::Level>& levels = compressed->levels();
+        for (size_t level = 0, size = levels.size(); level < size; ++level)
+        {
+            glCompressedTexImage2D(
+                GL_TEXTURE_2D, static_cast<int>(level), compressed->format(), levels[level].width, levels[level].height,
+                0, static_cast<int>(levels[level].size), compressed->data(level)
+            );
+        }
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, static_cast<int>(levels.size()) - 1);
+        m_memory = compressed->size();
+    }
+    else
+    {
+        const Image& image = std::get<Image>(source);
+        glTexImage2D(GL_TEXTURE_2D, 0, format, image.width(), image.height(), 0, format, GL_UNSIGNED_BYTE, image.data());
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+        glGenerateMipmap(GL_TEXTURE_2D);
+        m_memory = Memory(image.width(), image.height(), format);
+    }
+    setFiltering(GL_LINEAR);
 }
 
 void Graphics::Texture::setFiltering(int direction, int mode)
 {
     bind();
     glTexParameteri(GL_TEXTURE_2D, direction, mode);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Graphics::Texture::setFiltering(int mode)
@@ -61,14 +170,12 @@ void Graphics::Texture::setFiltering(int mode)
     bind();
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mode);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, mode);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Graphics::Texture::setWrapping(int direction, int mode)
 {
     bind();
     glTexParameteri(GL_TEXTURE_2D, direction, mode);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 void Graphics::Texture::setWrapping(int mode)
@@ -76,7 +183,6 @@ void Graphics::Texture::setWrapping(int mode)
     bind();
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, mode);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, mode);
-    glBindTexture(GL_TEXTURE_2D, 0);
 }
 
 } // namespace kc
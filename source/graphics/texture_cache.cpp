@@ -0,0 +1,178 @@
+#include "graphics/texture_cache.hpp"
+using namespace kc::Graphics::TextureCacheConst;
+
+namespace kc {
+
+namespace TextureCacheData
+{
+    struct Key
+    {
+        std::string path;
+        Graphics::Texture::Type type;
+        int format;
+        bool verticalFlip;
+
+        inline bool operator==(const Key& other) const = default;
+    };
+
+    struct KeyHash
+    {
+        inline size_t operator()(const Key& key) const
+        {
+            size_t hash = std::hash<std::string>{}(key.path);
+            hash ^= std::hash<int>{}(key.format) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            hash ^= (static_cast<size_t>(key.type) << 1 | key.verticalFlip) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+            return hash;
+        }
+    };
+
+    struct Entry
+    {
+        std::weak_ptr<Graphics::Texture> texture;
+        Graphics::Texture::Pointer retained;
+        std::list<Key>::iterator usage;
+    };
+
+    struct State
+    {
+        std::unordered_map<Key, Entry, KeyHash> entries;
+        std::list<Key> usage; // most recently used first
+        size_t budget = MemoryBudget;
+        Graphics::TextureCache::Statistics statistics;
+    };
+
+    /// @brief Cache of the one and only GL context
+    State Current;
+
+    /// @brief Make cache key, equal files reached by different paths share one key
+    /// @param type Texture type
+    /// @param imageFilePath Path to image file
+    /// @param format Image format
+    /// @param verticalFlip Whether texture is flipped vertically or not
+    /// @return Cache key
+    Key MakeKey(Graphics::Texture::Type type, const std::string& imageFilePath, int format, bool verticalFlip)
+    {
+        std::error_code error;
+        std::filesystem::path path = std::filesystem::weakly_canonical(imageFilePath, error);
+        return { error ? imageFilePath : path.string(), type, format, verticalFlip };
+    }
+
+    /// @brief Drop entry
+    /// @param entry The entry to drop
+    void Erase(std::unordered_map<Key, Entry, KeyHash>::iterator entry)
+    {
+        Current.usage.erase(entry->second.usage);
+        Current.entries.erase(entry);
+    }
+}
+
+Graphics::Texture::Pointer Graphics::TextureCache::Find(Texture::Type type, const std::string& imageFilePath, int format, bool verticalFlip)
+{
+    auto entry = TextureCacheData::Current.entries.find(TextureCacheData::MakeKey(type, imageFilePath, format, verticalFlip));
+    if (entry == TextureCacheData::Current.entries.end())
+    {
+        ++TextureCacheData::Current.statistics.misses;
+        return nullptr;
+    }
+
+    Texture::Pointer texture = entry->second.texture.lock();
+    if (!texture)
+    {
+        TextureCacheData::Erase(entry);
+        ++TextureCacheData::Current.statistics.misses;
+        return nullptr;
+    }
+
+    // Used again, keep it around even if it was released before
+    TextureCacheData::Current.usage.splice(TextureCacheData::Current.usage.begin(), TextureCacheData::Current.usage, entry->second.usage);
+    entry->second.retained = texture;
+    ++TextureCacheData::Current.statistics.hits;
+    return texture;
+}
+
+void Graphics::TextureCache::Insert(Texture::Type type, const std::string& imageFilePath, int format, bool verticalFlip, const Texture::Pointer& texture)
+{
+    TextureCacheData::Key key = TextureCacheData::MakeKey(type, imageFilePath, format, verticalFlip);
+    auto entry = TextureCacheData::Current.entries.find(key);
+    if (entry != TextureCacheData::Current.entries.end())
+        TextureCacheData::Erase(entry);
+
+    TextureCacheData::Current.usage.push_front(key);
+    TextureCacheData::Current.entries.emplace(std::move(key), TextureCacheData::Entry{ texture, texture, TextureCacheData::Current.usage.begin() });
+    Trim();
+}
+
+Graphics::Texture::Pointer Graphics::TextureCache::Load(Texture::Type type, const std::string& imageFilePath, int format, bool verticalFlip)
+{
+    if (Texture::Pointer texture = Find(type, imageFilePath, format, verticalFlip))
+        return texture;
+
+    auto texture = std::make_shared<Texture>(type, imageFilePath, format, verticalFlip);
+    Insert(type, imageFilePath, format, verticalFlip, texture);
+    return texture;
+}
+
+void Graphics::TextureCache::Trim()
+{
+    // Count every alive texture, forget entries whose textures are gone
+    size_t memory = 0;
+    for (auto entry = TextureCacheData::Current.entries.begin(); entry != TextureCacheData::Current.entries.end();)
+    {
+        Texture::Pointer texture = entry->second.texture.lock();
+        if (!texture)
+        {
+            auto expired = entry++;
+            TextureCacheData::Erase(expired);
+            continue;
+        }
+
+        memory += texture->memory();
+        ++entry;
+    }
+
+    // Release least recently used first, only textures nobody else holds actually free memory
+    for (auto usage = TextureCacheData::Current.usage.rbegin(); usage != TextureCacheData::Current.usage.rend() && memory > TextureCacheData::Current.budget; ++usage)
+    {
+        TextureCacheData::Entry& entry = TextureCacheData::Current.entries.at(*usage);
+        if (!entry.retained)
+            continue;
+
+        if (entry.retained.use_count() == 1)
+            memory -= entry.retained->memory();
+        entry.retained.reset();
+        ++TextureCacheData::Current.statistics.evictions;
+    }
+}
+
+void Graphics::TextureCache::SetBudget(size_t budget)
+{
+    TextureCacheData::Current.budget = budget;
+    Trim();
+}
+
+void Graphics::TextureCache::Clear()
+{
+    TextureCacheData::Current.entries.clear();
+    TextureCacheData::Current.usage.clear();
+}
+
+Graphics::TextureCache::Statistics Graphics::TextureCache::GetStatistics()
+{
+    Statistics statistics = TextureCacheData::Current.statistics;
+    statistics.entries = 0;
+    statistics.retained = 0;
+    statistics.memory = 0;
+    for (const auto& [key, entry] : TextureCacheData::Current.entries)
+    {
+        if (Texture::Pointer texture = entry.texture.lock())
+        {
+            ++statistics.entries;
+            statistics.memory += texture->memory();
+            if (entry.retained)
+                ++statistics.retained;
+        }
+    }
+    return statistics;
+}
+
+} // namespace kc
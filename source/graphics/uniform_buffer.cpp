@@ -0,0 +1,61 @@
+#include "graphics/uniform_buffer.hpp"
+
+namespace kc {
+
+std::optional<Graphics::UniformBuffer::Binding> Graphics::UniformBuffer::BlockBinding(std::string_view blockName)
+{
+    if (blockName == "Frame")
+        return Binding::Frame;
+    if (blockName == "Lights")
+        return Binding::Lights;
+    if (blockName == "Object")
+        return Binding::Object;
+    return {};
+}
+
+void Graphics::UniformBuffer::free()
+{
+    if (m_buffer)
+    {
+        StateCache::ForgetBuffer(m_buffer);
+        glDeleteBuffers(1, &m_buffer);
+        m_buffer = 0;
+        m_size = 0;
+    }
+}
+
+Graphics::UniformBuffer::UniformBuffer()
+    : m_buffer(0)
+    , m_size(0)
+{}
+
+Graphics::UniformBuffer::UniformBuffer(UniformBuffer&& other) noexcept
+    : m_buffer(other.m_buffer)
+    , m_size(other.m_size)
+{
+    other.m_buffer = 0;
+    other.m_size = 0;
+}
+
+Graphics::UniformBuffer::~UniformBuffer()
+{
+    free();
+}
+
+void Graphics::UniformBuffer::create(Binding binding, size_t size)
+{
+    free(); // avoid memory leaks if create() was called already
+    glGenBuffers(1, &m_buffer);
+    StateCache::BindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+    StateCache::BindBufferBase(GL_UNIFORM_BUFFER, static_cast<unsigned int>(binding), m_buffer);
+    m_size = size;
+}
+
+void Graphics::UniformBuffer::update(const void* data, size_t size, size_t offset)
+{
+    StateCache::BindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+}
+
+} // namespace kc
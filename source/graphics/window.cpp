@@ -8,6 +8,10 @@ void Graphics::Window::FrameBufferSizeCallback(GLFWwindow* window, int width, in
     root->m_width = width;
     root->m_height = height;
     glViewport(0, 0, width, height);
+
+    std::lock_guard lock(root->m_inputMutex);
+    root->m_input.width = width;
+    root->m_input.height = height;
 }
 
 void Graphics::Window::KeyCallback(GLFWwindow* window, int key, int scancode, int action, int mods)
@@ -35,10 +39,11 @@ void Graphics::Window::KeyCallback(GLFWwindow* window, int key, int scancode, in
         }
         case GLFW_KEY_R:
         {
+            std::lock_guard lock(root->m_inputMutex);
             if (action == GLFW_PRESS)
-                root->m_camera.resetZoom();
+                root->m_input.resetZoom = true;
             else if (action == GLFW_REPEAT)
-                root->m_camera.resetPosition();
+                root->m_input.resetPosition = true;
             break;
         }
         case GLFW_KEY_1:
@@ -53,6 +58,18 @@ void Graphics::Window::KeyCallback(GLFWwindow* window, int key, int scancode, in
                 root->m_pointLightEnabled = !root->m_pointLightEnabled;
             break;
         }
+        case GLFW_KEY_3:
+        {
+            if (action == GLFW_PRESS)
+                root->m_lightFieldEnabled = !root->m_lightFieldEnabled;
+            break;
+        }
+        case GLFW_KEY_4:
+        {
+            if (action == GLFW_PRESS)
+                root->m_crowdEnabled = !root->m_crowdEnabled;
+            break;
+        }
         case GLFW_KEY_F:
         {
             if (action == GLFW_PRESS)
@@ -61,8 +78,32 @@ void Graphics::Window::KeyCallback(GLFWwindow* window, int key, int scancode, in
         }
         case GLFW_KEY_G:
         {
+            std::lock_guard lock(root->m_inputMutex);
             if (action == GLFW_PRESS)
-                root->m_spotLightAttached = !root->m_spotLightAttached;
+                root->m_input.spotLightAttached = !root->m_input.spotLightAttached;
+            break;
+        }
+        case GLFW_KEY_O:
+        {
+            if (action == GLFW_PRESS)
+                root->m_occlusionCuller.toggle();
+            break;
+        }
+        case GLFW_KEY_P:
+        {
+            if (action != GLFW_PRESS)
+                break;
+
+            if (root->m_profiler.capturing())
+            {
+                root->stopCapture();
+                root->showProfile();
+            }
+            else
+            {
+                root->m_profiler.startCapture();
+                root->m_logger.info("Profiler capture started");
+            }
             break;
         }
     }
@@ -74,14 +115,18 @@ void Graphics::Window::CursorPositionCallback(GLFWwindow* window, double x, doub
     float xOffset = x - lastX, yOffset = lastY - y;
     lastX = x; lastY = y;
 
+    // Offsets accumulate until simulation takes them
     Window* root = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
-    root->m_camera.mouseMoved(xOffset, yOffset);
+    std::lock_guard lock(root->m_inputMutex);
+    root->m_input.xOffset += xOffset;
+    root->m_input.yOffset += yOffset;
 }
 
 void Graphics::Window::ScrollCallback(GLFWwindow* window, double xOffset, double yOffset)
 {
     Window* root = reinterpret_cast<Window*>(glfwGetWindowUserPointer(window));
-    root->m_camera.mouseScrolled(yOffset);
+    std::lock_guard lock(root->m_inputMutex);
+    root->m_input.scroll += yOffset;
 }
 
 void Graphics::Window::processInput()
@@ -93,26 +138,87 @@ void Graphics::Window::processInput()
     if (glfwGetKey(m_window, GLFW_KEY_LEFT_ALT) == GLFW_PRESS)
         movementMode = Camera::MovementMode::Slow;
 
-    /* Camera movement */
+    /* Camera movement, applied by simulation with its own delta time */
+    std::lock_guard lock(m_inputMutex);
+    m_input.movementMode = movementMode;
+    m_input.keys.clear();
     if (glfwGetKey(m_window, GLFW_KEY_SPACE) == GLFW_PRESS)
-        m_camera.keyPressed(Camera::Key::Up, movementMode, m_deltaTime);
+        m_input.keys.push_back(Camera::Key::Up);
     if (glfwGetKey(m_window, GLFW_KEY_LEFT_CONTROL) == GLFW_PRESS)
-        m_camera.keyPressed(Camera::Key::Down, movementMode, m_deltaTime);
+        m_input.keys.push_back(Camera::Key::Down);
     if (glfwGetKey(m_window, GLFW_KEY_W) == GLFW_PRESS)
-        m_camera.keyPressed(Camera::Key::Forward, movementMode, m_deltaTime);
+        m_input.keys.push_back(Camera::Key::Forward);
     if (glfwGetKey(m_window, GLFW_KEY_S) == GLFW_PRESS)
-        m_camera.keyPressed(Camera::Key::Backward, movementMode, m_deltaTime);
+        m_input.keys.push_back(Camera::Key::Backward);
     if (glfwGetKey(m_window, GLFW_KEY_A) == GLFW_PRESS)
-        m_camera.keyPressed(Camera::Key::Left, movementMode, m_deltaTime);
+        m_input.keys.push_back(Camera::Key::Left);
     if (glfwGetKey(m_window, GLFW_KEY_D) == GLFW_PRESS)
-        m_camera.keyPressed(Camera::Key::Right, movementMode, m_deltaTime);
+        m_input.keys.push_back(Camera::Key::Right);
+}
+
+void Graphics::Window::simulate(Frame& frame, Lighting::DirectionalLight& directionalLight, Lighting::PointLight& pointLight, Lighting::SpotLight& spotLight)
+{
+    // Scripted runs advance by fixed steps so every run simulates the same frames
+    float time = m_scripted ? m_scriptFrame++ * WindowConst::Script::Step : glfwGetTime();
+    float deltaTime = m_scripted ? WindowConst::Script::Step : time - m_lastSimulationTime;
+    m_lastSimulationTime = time;
+
+    // Take input under lock, apply it without holding main thread
+    Input input;
+    {
+        std::lock_guard lock(m_inputMutex);
+        input = m_input;
+        m_input.xOffset = m_input.yOffset = m_input.scroll = 0.0f;
+        m_input.resetZoom = m_input.resetPosition = false;
+    }
+
+    /* Camera */
+    if (m_scripted)
+    {
+        float angle = time / WindowConst::Script::Period * 2.0f * M_PI;
+        glm::vec3 position(std::sin(angle) * WindowConst::Script::Radius, WindowConst::Script::Height, std::cos(angle) * WindowConst::Script::Radius);
+        m_camera.lookAt(position, glm::vec3(0.0f));
+    }
+    else
+    {
+        if (input.xOffset != 0.0f || input.yOffset != 0.0f)
+            m_camera.mouseMoved(input.xOffset, input.yOffset);
+        if (input.scroll != 0.0f)
+            m_camera.mouseScrolled(input.scroll);
+        if (input.resetZoom)
+            m_camera.resetZoom();
+        if (input.resetPosition)
+            m_camera.resetPosition();
+        for (Camera::Key key : input.keys)
+            m_camera.keyPressed(key, input.movementMode, deltaTime);
+    }
+    m_camera.update(input.width, input.height);
+
+    /* Transform */
+    pointLight.transform().position.x = std::sin(time) * 2.0f;
+    pointLight.transform().position.z = std::cos(time) * 2.0f;
+    if (input.spotLightAttached)
+    {
+        spotLight.transform().position = m_camera.position() + m_camera.direction() * -0.3f;
+        spotLight.direction() = m_camera.direction();
+    }
+    m_scene.update(&m_jobs);
+
+    // Snapshot reuses frame's storage, render thread only reads it
+    frame.camera = m_camera;
+    m_scene.snapshot(frame.scene);
+    frame.directionalLight = directionalLight;
+    frame.pointLight = pointLight;
+    frame.spotLight = spotLight;
+    frame.width = input.width;
+    frame.height = input.height;
 }
 
 void Graphics::Window::toggleWireframe()
 {
     static bool wireframe = false;
     wireframe = !wireframe;
-    glPolygonMode(GL_FRONT_AND_BACK, wireframe ? GL_LINE : GL_FILL);
+    StateCache::PolygonMode(wireframe ? GL_LINE : GL_FILL);
 }
 
 void Graphics::Window::toggleVSync()
@@ -122,7 +228,34 @@ void Graphics::Window::toggleVSync()
     glfwSwapInterval(static_cast<int>(enabled));
 }
 
-void Graphics::Window::showFps() const
+void Graphics::Window::stopCapture()
+{
+    // Called from GLFW callbacks too, exceptions mustn't pass through C code
+    try
+    {
+        m_profiler.stopCapture(WindowConst::TraceFilePath);
+        m_logger.info("Profiler capture written to \"{}\"", WindowConst::TraceFilePath);
+    }
+    catch (const std::runtime_error& error)
+    {
+        m_logger.error("Couldn't write profiler capture: {}", error.what());
+    }
+}
+
+void Graphics::Window::showProfile()
+{
+    m_logger.info("{:<24} {:>28} {:>28}", "Scope", "CPU p50/p95/p99 [us]", m_profiler.gpu() ? "GPU p50/p95/p99 [us]" : "GPU unavailable");
+    for (const Profiler::Summary& scope : m_profiler.summary())
+    {
+        m_logger.info("{:<24} {:>8.1f} {:>9.1f} {:>9.1f} {:>8.1f} {:>9.1f} {:>9.1f}",
+            std::string(scope.depth * 2, ' ') + scope.name,
+            scope.cpu.p50, scope.cpu.p95, scope.cpu.p99, scope.gpu.p50, scope.gpu.p95, scope.gpu.p99);
+    }
+    if (m_profiler.droppedFrames())
+        m_logger.info("GPU timestamps of {} frames weren't ready in time and were skipped", m_profiler.droppedFrames());
+}
+
+void Graphics::Window::showFps(const Camera& camera) const
 {
     float fps = 1.0f / m_deltaTime;
     static float min, max, resetTime = -1.0f;
@@ -136,27 +269,53 @@ void Graphics::Window::showFps() const
         min = fps;
     if (fps > max)
         max = fps;
-    fmt::print("FPS: {:>6.1f} (min/max for 3s: {:>6.1f}, {:6.1f})\r", fps, min, max);
+    const Frustum::Statistics& culling = camera.frustum().statistics();
+    const OcclusionCuller::Statistics& occlusion = m_occlusionCuller.statistics();
+    const RenderQueue::Statistics& queue = m_renderQueue.statistics();
+    fmt::print("FPS: {:>6.1f} (min/max for 3s: {:>6.1f}, {:6.1f}) | Visible: {:>4}, culled: {:>4} | Occluded: {:>4}/{:<4} | Packets: {:>4}, switches: {:>3}/{:>3}/{:>3}\r",
+        fps, min, max, culling.visible, culling.culled, occlusion.occluded, occlusion.tested,
+        queue.packets, queue.programSwitches, queue.vertexArraySwitches, queue.materialSwitches);
 }
 
-Graphics::Window::Window(unsigned int width, unsigned int height, const std::string& resourcesPath)
+Graphics::Window::Window(unsigned int width, unsigned int height, const std::string& resourcesPath, size_t latency, Backend backend)
     : m_logger(Utility::CreateLogger("window"))
     , m_window(nullptr)
     , m_width(static_cast<int>(width))
     , m_height(static_cast<int>(height))
+    , m_latency(latency)
+    , m_backend(backend)
+    , m_lastSimulationTime(0.0f)
+    , m_scripted(false)
+    , m_scriptFrame(0)
+    , m_loader(m_jobs)
     , m_currentFrameTime(0.0f)
     , m_deltaTime(0.0f)
     , m_lastFrameTime(0.0f)
     , m_directionalLightEnabled(false)
     , m_pointLightEnabled(true)
     , m_spotLightEnabled(false)
-    , m_spotLightAttached(true)
+    , m_lightFieldEnabled(false)
+    , m_crowdEnabled(false)
 {
+#ifdef GLFW_PLATFORM_NULL
+    // Null platform needs no display server, context APIs below work without one
+    if (m_backend != Backend::Windowed)
+        glfwInitHint(GLFW_PLATFORM, GLFW_PLATFORM_NULL);
+#else
+    // Older GLFW always connects to display server, headless runs would fail somewhere far less obvious
+    if (m_backend != Backend::Windowed)
+        throw std::runtime_error("kc::Graphics::Window::Window(): Headless backends need GLFW 3.4 or newer built with null platform");
+#endif
     if (glfwInit() != GLFW_TRUE)
         throw std::runtime_error("kc::Graphics::Window::Window(): Couldn't initialize GLFW");
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    if (m_backend != Backend::Windowed)
+    {
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+        glfwWindowHint(GLFW_CONTEXT_CREATION_API, GLFW_EGL_CONTEXT_API);
+    }
 
     m_window = glfwCreateWindow(m_width, m_height, "LearnOpenGL", NULL, NULL);
     if (!m_window)
@@ -167,6 +326,11 @@ Graphics::Window::Window(unsigned int width, unsigned int height, const std::str
     glfwMakeContextCurrent(m_window);
 
     GLenum result = glewInit();
+#ifdef GLEW_ERROR_NO_GLX_DISPLAY
+    // GLX build of GLEW fails on GLX extensions only after core functions are loaded
+    if (m_backend != Backend::Windowed && result == GLEW_ERROR_NO_GLX_DISPLAY)
+        result = GLEW_OK;
+#endif
     if (result != GLEW_OK)
     {
         glfwTerminate();
@@ -176,30 +340,45 @@ Graphics::Window::Window(unsigned int width, unsigned int height, const std::str
         )));
     }
 
-    glEnable(GL_DEPTH_TEST);
+    StateCache::Invalidate();
+    StateCache::DepthTest(true);
     glViewport(0, 0, m_width, m_height);
+    m_input.width = m_width;
+    m_input.height = m_height;
     glfwSetWindowUserPointer(m_window, this);
     glfwSetFramebufferSizeCallback(m_window, &Window::FrameBufferSizeCallback);
     glfwSetKeyCallback(m_window, &Window::KeyCallback);
     glfwSetCursorPosCallback(m_window, &Window::CursorPositionCallback);
     glfwSetScrollCallback(m_window, &Window::ScrollCallback);
-    glfwSetInputMode(m_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    if (m_backend == Backend::Windowed)
+        glfwSetInputMode(m_window, GLFW_CURSOR, GLFW_CURSOR_DISABLED);
 
     try
     {
+        // Headless contexts may have no default framebuffer worth drawing to
+        if (m_backend != Backend::Windowed)
+        {
+            m_target.create(m_width, m_height);
+            m_target.bind();
+        }
+
+        // Buffers are tiny and needed by every draw, create them right away
+        m_stream.create(WindowConst::StreamSize);
+        m_lightClusters.create();
+        m_occlusionCuller.create();
+        m_profiler.create();
+
+        // Everything else streams in while frames are already rendered
         Stopwatch stopwatch;
-        m_shaderProgram.make(resourcesPath + "/shaders/cube.vert", resourcesPath + "/shaders/cube.frag");
-        m_lightShaderProgram.make(resourcesPath + "/shaders/light.vert", resourcesPath + "/shaders/light.frag");
-        m_logger.info("Shader programs built [{} ms]", stopwatch.milliseconds());
-
-        stopwatch.reset();
-        m_containerTexture = std::make_shared<Texture>(Texture::Type::Diffuse, resourcesPath + "/textures/container2.png", GL_RGBA, true);
-        m_containerSpecularTexture = std::make_shared<Texture>(Texture::Type::Specular, resourcesPath + "/textures/container2_specular.png", GL_RGBA, true);
-        m_logger.info("Textures loaded [{} ms]", stopwatch.milliseconds());
-
-        stopwatch.reset();
-        m_backpack.load(resourcesPath + "/models/backpack/backpack.obj");
-        m_logger.info("Models loaded [{} ms]", stopwatch.milliseconds());
+        m_shaderProgram = m_loader.loadShaderProgram(resourcesPath + "/shaders/cube.vert", resourcesPath + "/shaders/cube.frag");
+        m_lightShaderProgram = m_loader.loadShaderProgram(resourcesPath + "/shaders/light.vert", resourcesPath + "/shaders/light.frag");
+        m_instancedLightShaderProgram = m_loader.loadShaderProgram(resourcesPath + "/shaders/light_instanced.vert", resourcesPath + "/shaders/light_instanced.frag");
+        m_instancedShaderProgram = m_loader.loadShaderProgram(resourcesPath + "/shaders/instanced.vert", resourcesPath + "/shaders/cube.frag");
+        m_containerTexture = m_loader.loadTexture(Texture::Type::Diffuse, resourcesPath + "/textures/container2.png", GL_RGBA, true);
+        m_containerSpecularTexture = m_loader.loadTexture(Texture::Type::Specular, resourcesPath + "/textures/container2_specular.png", GL_RGBA, true);
+        m_backpack = m_loader.loadModel(resourcesPath + "/models/backpack/backpack.obj", Mesh::Residency::Discard, VertexFormat::Quantized);
+        m_scene.add(SceneConst::Root, Transform(), m_backpack);
+        m_logger.info("Resources requested [{} ms]", stopwatch.milliseconds());
     }
     catch (...)
     {
@@ -210,10 +389,16 @@ Graphics::Window::Window(unsigned int width, unsigned int height, const std::str
 
 Graphics::Window::~Window()
 {
+    // Textures and models die with their last reference, every holder lets go while context is still alive
+    m_scene = Scene();
+    m_backpack.reset();
+    m_containerTexture.reset();
+    m_containerSpecularTexture.reset();
+    TextureCache::Clear();
     glfwTerminate();
 }
 
-void Graphics::Window::run()
+void Graphics::Window::run(size_t frames, bool capture)
 {
     Lighting::DirectionalLight directionalLight;
     directionalLight.direction() = { -1.0f, -1.0f, -1.0f };
@@ -226,41 +411,192 @@ void Graphics::Window::run()
     spotLight.transform().scale = { 0.2f, 0.2f, 0.2f };
     spotLight.direction() = { 0.0f, 0.0f, -1.0f };
 
-    while (!glfwWindowShouldClose(m_window))
+    // Every light field body shares this cube's geometry
+    Cube lightFieldBody;
+    std::vector<Lighting::PointLight> lightField;
+    lightField.reserve(WindowConst::LightField::Size);
+    for (size_t index = 0; index < WindowConst::LightField::Size; ++index)
     {
+        float angle = Utility::Random(0.0, 2.0 * M_PI);
+        float distance = Utility::Random(WindowConst::LightField::InnerRadius, WindowConst::LightField::OuterRadius);
+        Transform transform = { glm::vec3(std::sin(angle) * distance, Utility::Random(-2.0, 2.0), std::cos(angle) * distance), glm::vec3(0.0f), glm::vec3(0.05f) };
+        Color color = { static_cast<uint8_t>(Utility::Random(64, 255)), static_cast<uint8_t>(Utility::Random(64, 255)), static_cast<uint8_t>(Utility::Random(64, 255)) };
+        lightField.emplace_back(transform, color, LightAttenuation{ 1.0f, 1.0f, 4.0f });
+    }
+
+    // Scripted runs measure the loaded scene only, simulation starts from the first measured frame
+    Stopwatch loadStopwatch;
+    bool loading = true;
+    m_scripted = frames != 0;
+    m_scriptFrame = 0;
+    if (m_scripted)
+    {
+        while (m_loader.pending())
+        {
+            m_loader.drain();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        m_logger.info("Resources loaded [{} ms]", loadStopwatch.milliseconds());
+        loading = false;
+    }
+
+    // Declared after everything simulation references, so it's stopped first on any exit
+    FramePipeline<Frame> pipeline;
+    pipeline.start([&](Frame& frame) { simulate(frame, directionalLight, pointLight, spotLight); }, m_latency);
+
+    if (capture)
+        m_profiler.startCapture();
+    Stopwatch runStopwatch;
+    size_t renderedFrames = 0;
+    while (!glfwWindowShouldClose(m_window) && (!m_scripted || renderedFrames < frames))
+    {
+        m_profiler.beginFrame();
+        m_profiler.begin("Frame");
+
+        // Finish streamed resources without stalling the frame
+        m_profiler.begin("Resources");
+        m_loader.drain();
+        if (loading && !m_loader.pending())
+        {
+            m_logger.info("Resources loaded [{} ms]", loadStopwatch.milliseconds());
+            loading = false;
+        }
+        m_profiler.end();
+
         m_currentFrameTime = glfwGetTime();
         m_deltaTime = m_currentFrameTime - m_lastFrameTime;
         m_lastFrameTime = m_currentFrameTime;
-        showFps();
 
+        // Input reaches simulation of a later frame, the one being rendered is already simulated
         processInput();
+        m_profiler.begin("Simulation wait");
+        Frame& frame = pipeline.acquire();
+        const Camera& camera = frame.camera;
+        m_profiler.end();
         glClearColor(0.1f, 0.1f, 0.1f, 1.0f); 
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Transform
-        pointLight.transform().position.x = std::sin(m_currentFrameTime) * 2.0f;
-        pointLight.transform().position.z = std::cos(m_currentFrameTime) * 2.0f;
-        if (m_spotLightAttached)
+        // Cluster enabled lights, disabled ones cost nothing
+        m_profiler.begin("Lights");
+        m_stream.begin();
+        camera.upload(m_stream);
+        m_lightClusters.clear();
+        if (m_pointLightEnabled)
+            m_lightClusters.add(frame.pointLight, camera);
+        if (m_spotLightEnabled)
+            m_lightClusters.add(frame.spotLight, camera);
+        if (m_lightFieldEnabled)
         {
-            spotLight.transform().position = m_camera.position() + m_camera.direction() * -0.3f;
-            spotLight.direction() = m_camera.direction();
+            for (const Lighting::PointLight& light : lightField)
+                m_lightClusters.add(light, camera);
         }
+        m_lightClusters.build(camera, frame.width, frame.height, &m_jobs);
+
+        // Upload per-frame uniform blocks
+        UniformBlocks::Lights lights = {};
+        if (m_directionalLightEnabled)
+            frame.directionalLight.illuminate(lights, camera);
+        m_lightClusters.illuminate(lights);
+        m_stream.upload(UniformBuffer::Binding::Lights, lights);
+        m_profiler.end();
+
+        // Draw, shader programs may still be streaming in
+        if (m_shaderProgram->ready() && m_lightShaderProgram->ready() && m_instancedLightShaderProgram->ready() && m_instancedShaderProgram->ready())
+        {
+            // Traversal only submits, the queue decides draw order
+            m_profiler.begin("Submit");
+            if (m_directionalLightEnabled)
+                frame.directionalLight.submit(m_renderQueue, *m_lightShaderProgram, camera);
+            if (m_pointLightEnabled)
+                frame.pointLight.submit(m_renderQueue, *m_lightShaderProgram, camera);
+            if (m_spotLightEnabled)
+                frame.spotLight.submit(m_renderQueue, *m_lightShaderProgram, camera);
+            frame.scene.submit(m_renderQueue, *m_shaderProgram, camera, &m_occlusionCuller, &m_jobs);
+            m_profiler.end();
+
+            if (m_lightFieldEnabled)
+            {
+                // One instanced draw instead of a draw per light
+                m_profiler.begin("Light field");
+                m_lightFieldBatch.clear();
+                for (const Lighting::PointLight& light : lightField)
+                    m_lightFieldBatch.add(light.transform(), light.color());
+                m_lightFieldBatch.draw(*m_instancedLightShaderProgram, lightFieldBody, camera.frustum(), m_stream);
+                m_profiler.end();
+            }
+
+            m_profiler.begin("Execute");
+            m_lightClusters.bind(*m_shaderProgram);
+            m_renderQueue.execute(m_stream);
+            m_profiler.end();
 
-        directionalLight.color() = m_directionalLightEnabled ? Color{ 255, 255, 255 } : Color{ 0, 0, 0 };
-        pointLight.color() = m_pointLightEnabled ? Color{ 255, 255, 255 } : Color{ 0, 0, 0 };
-        spotLight.color() = m_spotLightEnabled ? Color{ 255, 255, 255 } : Color{ 0, 0, 0 };
+            if (m_crowdEnabled && m_backpack->ready())
+            {
+                // Identical props cost one instanced draw per mesh however many there are
+                m_profiler.begin("Crowd");
+                m_crowdBatch.clear();
+                glm::mat4 model = m_backpack->transform().matrix();
+                for (size_t row = 0; row < WindowConst::Crowd::Rows; ++row)
+                {
+                    for (size_t column = 0; column < WindowConst::Crowd::Columns; ++column)
+                    {
+                        glm::vec3 position = {
+                            (column - (WindowConst::Crowd::Columns - 1) / 2.0f) * WindowConst::Crowd::Spacing,
+                            0.0f,
+                            -(row + 1.0f) * WindowConst::Crowd::Spacing
+                        };
+                        m_crowdBatch.add(glm::translate(glm::mat4(1.0f), position) * model);
+                    }
+                }
+                m_lightClusters.bind(*m_instancedShaderProgram);
+                m_crowdBatch.draw(*m_instancedShaderProgram, *m_backpack, camera.frustum(), m_stream);
+                m_profiler.end();
+            }
+
+            // Boxes go after every object, so they're tested against the whole frame's depth
+            m_profiler.begin("Occlusion test");
+            m_occlusionCuller.test(*m_lightShaderProgram, camera, m_stream);
+            m_profiler.end();
+        }
+        m_stream.end();
+        if (!m_scripted)
+            showFps(camera);
+        pipeline.release();
 
-        // Draw
-        directionalLight.draw(m_shaderProgram, m_lightShaderProgram);
-        pointLight.draw(m_shaderProgram, m_lightShaderProgram);
-        spotLight.draw(m_shaderProgram, m_lightShaderProgram);
-        m_backpack.draw(m_shaderProgram);
+        // Nothing to present offscreen, flushing keeps the GPU fed all the same
+        m_profiler.begin("Swap");
+        if (m_backend == Backend::Windowed)
+            glfwSwapBuffers(m_window);
+        else
+            glFlush();
+        m_profiler.end();
+        ++renderedFrames;
 
-        m_camera.capture({ m_shaderProgram, m_lightShaderProgram }, m_width, m_height);
-        glfwSwapBuffers(m_window);
+        m_profiler.end();
+        m_profiler.endFrame();
         glfwPollEvents();
     }
+    pipeline.stop();
     m_logger.warn("{:<20}", "Stopped");
+    if (m_scripted)
+    {
+        float seconds = runStopwatch.seconds();
+        m_logger.info("Rendered {} frames in {:.2f} s [{:.3f} ms per frame]", renderedFrames, seconds, seconds * 1000.0f / std::max<size_t>(renderedFrames, 1));
+    }
+
+    StateCache::Statistics statistics = StateCache::GetStatistics();
+    m_logger.info("GL state changes: {} issued, {} elided", statistics.issued, statistics.elided);
+    m_logger.info("Stream buffer: {} mapping, {} frames waited for GPU", m_stream.persistent() ? "persistent" : "per-range", m_stream.statistics().waits);
+    if (m_profiler.capturing())
+        stopCapture();
+    showProfile();
+
+    TextureCache::Statistics textureStatistics = TextureCache::GetStatistics();
+    m_logger.info(
+        "Texture cache: {} textures ({} retained, {:.1f} MiB), {} hits, {} misses, {} evictions",
+        textureStatistics.entries, textureStatistics.retained, textureStatistics.memory / 1048576.0,
+        textureStatistics.hits, textureStatistics.misses, textureStatistics.evictions
+    );
 }
 
 } // namespace kc
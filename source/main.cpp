@@ -1,3 +1,9 @@
+// STL modules
+#include <string>
+#include <string_view>
+#include <limits>
+#include <stdexcept>
+
 // Library {fmt}
 #include <fmt/format.h>
 
@@ -5,12 +11,138 @@
 #include "graphics/window.hpp"
 using namespace kc;
 
-int main()
+namespace MainConst
+{
+    constexpr const char* Usage =
+        "Usage: LearnOpenGL [options]\n"
+        "  --resources <path>        Resources directory [../../resources]\n"
+        "  --size <width>x<height>   Window or offscreen target size [800x600]\n"
+        "  --latency <frames>        Frames simulation runs ahead of rendering, 0 or 1 [1]\n"
+        "  --headless egl            Render offscreen through EGL without a window system\n"
+        "  --frames <count>          Render frames along scripted camera path and exit\n"
+        "  --trace                   Write profiler capture of the run to trace.json\n";
+}
+
+namespace MainData
+{
+    struct Options
+    {
+        std::string resourcesPath = "../../resources";
+        unsigned int width = 800;
+        unsigned int height = 600;
+        size_t latency = Graphics::WindowConst::Latency;
+        Graphics::Window::Backend backend = Graphics::Window::Backend::Windowed;
+        size_t frames = 0;
+        bool trace = false;
+    };
+
+    /// @brief Parse unsigned number argument
+    /// @param option Option the number belongs to
+    /// @param value The number
+    /// @param minimum Smallest accepted number
+    /// @param maximum Largest accepted number
+    /// @return Parsed number
+    /// @throw std::runtime_error if value isn't a number or is out of range
+    size_t ParseNumber(std::string_view option, const std::string& value, size_t minimum = 0, size_t maximum = std::numeric_limits<size_t>::max())
+    {
+        // std::stoull skips whitespace and happily wraps negative numbers around
+        size_t end = 0;
+        unsigned long long result = 0;
+        try
+        {
+            if (!value.empty() && value.front() >= '0' && value.front() <= '9')
+                result = std::stoull(value, &end);
+        }
+        catch (const std::logic_error&)
+        {}
+        if (!end || end != value.size())
+            throw std::runtime_error(fmt::format("{}: \"{}\" isn't a number", option, value));
+
+        if (result < minimum || result > maximum)
+            throw std::runtime_error(fmt::format("{}: {} isn't in range [{}, {}]", option, value, minimum, maximum));
+        return static_cast<size_t>(result);
+    }
+
+    /// @brief Parse command line
+    /// @param argc Argument count
+    /// @param argv Arguments
+    /// @return Parsed options
+    /// @throw std::runtime_error if command line is invalid
+    Options ParseOptions(int argc, char** argv)
+    {
+        Options options;
+        for (int index = 1; index < argc; ++index)
+        {
+            std::string_view option = argv[index];
+            if (option == "--trace")
+            {
+                options.trace = true;
+                continue;
+            }
+
+            if (index + 1 >= argc)
+                throw std::runtime_error(fmt::format("{}: Value expected", option));
+            std::string value = argv[++index];
+
+            if (option == "--resources")
+            {
+                options.resourcesPath = value;
+            }
+            else if (option == "--size")
+            {
+                size_t separator = value.find('x');
+                if (separator == std::string::npos)
+                    throw std::runtime_error(fmt::format("{}: \"{}\" isn't <width>x<height>", option, value));
+                // Window and framebuffer sizes are ints, zero sized ones can't be created
+                constexpr size_t maximum = std::numeric_limits<int>::max();
+                options.width = static_cast<unsigned int>(ParseNumber(option, value.substr(0, separator), 1, maximum));
+                options.height = static_cast<unsigned int>(ParseNumber(option, value.substr(separator + 1), 1, maximum));
+            }
+            else if (option == "--latency")
+            {
+                options.latency = ParseNumber(option, value, 0, Graphics::FramePipelineConst::MaximumLatency);
+            }
+            else if (option == "--headless")
+            {
+                if (value == "egl")
+                    options.backend = Graphics::Window::Backend::Egl;
+                else
+                    throw std::runtime_error(fmt::format("{}: Unknown backend \"{}\"", option, value));
+            }
+            else if (option == "--frames")
+            {
+                options.frames = ParseNumber(option, value);
+            }
+            else
+            {
+                throw std::runtime_error(fmt::format("Unknown option \"{}\"", option));
+            }
+        }
+
+        // Nobody would ever close a headless window
+        if (options.backend != Graphics::Window::Backend::Windowed && !options.frames)
+            throw std::runtime_error("--headless: Number of --frames expected");
+        return options;
+    }
+}
+
+int main(int argc, char** argv)
 {
+    MainData::Options options;
+    try
+    {
+        options = MainData::ParseOptions(argc, argv);
+    }
+    catch (const std::runtime_error& error)
+    {
+        fmt::print(stderr, "{}\n{}", error.what(), MainConst::Usage);
+        return -1;
+    }
+
     try
     {
-        Graphics::Window window(800, 600, "../../resources");
-        window.run();
+        Graphics::Window window(options.width, options.height, options.resourcesPath, options.latency, options.backend);
+        window.run(options.frames, options.trace);
     }
     catch (const std::runtime_error& error)
     {
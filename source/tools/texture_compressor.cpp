@@ -0,0 +1,346 @@
+// STL modules
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+
+// Library {fmt}
+#include <fmt/format.h>
+
+// Custom modules
+#include "common/compressed_image.hpp"
+#include "common/image.hpp"
+using namespace kc;
+
+namespace Compressor
+{
+    struct Pixels
+    {
+        int width;
+        int height;
+        std::vector<uint8_t> rgba;
+    };
+
+    using Block = uint8_t[16][4];
+
+    /// @brief Expand image of any channel count to RGBA
+    /// @param image The image to expand
+    /// @return RGBA pixels
+    Pixels ToRgba(const Image& image)
+    {
+        Pixels pixels = { image.width(), image.height(), std::vector<uint8_t>(static_cast<size_t>(image.width()) * image.height() * 4) };
+        for (size_t pixel = 0, size = static_cast<size_t>(image.width()) * image.height(); pixel < size; ++pixel)
+        {
+            const uint8_t* source = image.data() + pixel * image.channels();
+            uint8_t* target = pixels.rgba.data() + pixel * 4;
+            switch (image.channels())
+            {
+                case 1:
+                case 2:
+                    target[0] = target[1] = target[2] = source[0];
+                    target[3] = image.channels() == 2 ? source[1] : 255;
+                    break;
+                default:
+                    target[0] = source[0];
+                    target[1] = source[1];
+                    target[2] = source[2];
+                    target[3] = image.channels() == 4 ? source[3] : 255;
+                    break;
+            }
+        }
+        return pixels;
+    }
+
+    /// @brief Make next mipmap level with 2x2 box filter
+    /// @param pixels Current level
+    /// @return Next level
+    Pixels Downsample(const Pixels& pixels)
+    {
+        Pixels result = { std::max(pixels.width / 2, 1), std::max(pixels.height / 2, 1), {} };
+        result.rgba.resize(static_cast<size_t>(result.width) * result.height * 4);
+        for (int y = 0; y < result.height; ++y)
+        {
+            for (int x = 0; x < result.width; ++x)
+            {
+                for (int channel = 0; channel < 4; ++channel)
+                {
+                    int sum = 0;
+                    for (int offset = 0; offset < 4; ++offset)
+                    {
+                        int sourceX = std::min(x * 2 + offset % 2, pixels.width - 1);
+                        int sourceY = std::min(y * 2 + offset / 2, pixels.height - 1);
+                        sum += pixels.rgba[(static_cast<size_t>(sourceY) * pixels.width + sourceX) * 4 + channel];
+                    }
+                    result.rgba[(static_cast<size_t>(y) * result.width + x) * 4 + channel] = static_cast<uint8_t>((sum + 2) / 4);
+                }
+            }
+        }
+        return result;
+    }
+
+    /// @brief Quantize color to RGB565
+    /// @param color Color channels in 0..255
+    /// @return Packed color
+    uint16_t Pack565(const float color[3])
+    {
+        auto quantize = [](float value, int bits)
+        {
+            int maximum = (1 << bits) - 1;
+            return std::clamp(static_cast<int>(std::lround(value / 255.0f * maximum)), 0, maximum);
+        };
+        return static_cast<uint16_t>(quantize(color[0], 5) << 11 | quantize(color[1], 6) << 5 | quantize(color[2], 5));
+    }
+
+    /// @brief Expand RGB565 color
+    /// @param packed Packed color
+    /// @param color Color channels in 0..255
+    void Unpack565(uint16_t packed, int color[3])
+    {
+        int red = packed >> 11 & 31, green = packed >> 5 & 63, blue = packed & 31;
+        color[0] = red << 3 | red >> 2;
+        color[1] = green << 2 | green >> 4;
+        color[2] = blue << 3 | blue >> 2;
+    }
+
+    /// @brief Compress color of 4x4 block to BC1 along principal axis
+    /// @param block Block pixels
+    /// @param output 8 output bytes
+    void CompressColor(const Block& block, uint8_t* output)
+    {
+        float mean[3] = {};
+        for (const uint8_t* pixel : block)
+        {
+            for (int channel = 0; channel < 3; ++channel)
+                mean[channel] += pixel[channel] / 16.0f;
+        }
+
+        float covariance[3][3] = {};
+        for (const uint8_t* pixel : block)
+        {
+            for (int row = 0; row < 3; ++row)
+            {
+                for (int column = 0; column < 3; ++column)
+                    covariance[row][column] += (pixel[row] - mean[row]) * (pixel[column] - mean[column]);
+            }
+        }
+
+        // Power iteration converges fast enough for 3x3
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+        for (int iteration = 0; iteration < 8; ++iteration)
+        {
+            float next[3] = {};
+            for (int row = 0; row < 3; ++row)
+                next[row] = covariance[row][0] * axis[0] + covariance[row][1] * axis[1] + covariance[row][2] * axis[2];
+            float length = std::sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+            if (length < 1e-6f)
+                break;
+            for (int channel = 0; channel < 3; ++channel)
+                axis[channel] = next[channel] / length;
+        }
+
+        float minimum = 1e9f, maximum = -1e9f;
+        for (const uint8_t* pixel : block)
+        {
+            float projection = (pixel[0] - mean[0]) * axis[0] + (pixel[1] - mean[1]) * axis[1] + (pixel[2] - mean[2]) * axis[2];
+            minimum = std::min(minimum, projection);
+            maximum = std::max(maximum, projection);
+        }
+
+        // Inset endpoints a little, extremes are rarely worth the error of everything in between
+        float inset = (maximum - minimum) / 16.0f;
+        float first[3], second[3];
+        for (int channel = 0; channel < 3; ++channel)
+        {
+            first[channel] = mean[channel] + axis[channel] * (maximum - inset);
+            second[channel] = mean[channel] + axis[channel] * (minimum + inset);
+        }
+
+        uint16_t color0 = Pack565(first), color1 = Pack565(second);
+        if (color0 < color1)
+            std::swap(color0, color1);
+
+        uint32_t indices = 0;
+        if (color0 != color1)
+        {
+            int palette[4][3];
+            Unpack565(color0, palette[0]);
+            Unpack565(color1, palette[1]);
+            for (int channel = 0; channel < 3; ++channel)
+            {
+                palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+                palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+            }
+
+            for (int pixel = 0; pixel < 16; ++pixel)
+            {
+                int best = 0, bestError = INT32_MAX;
+                for (int entry = 0; entry < 4; ++entry)
+                {
+                    int error = 0;
+                    for (int channel = 0; channel < 3; ++channel)
+                        error += (block[pixel][channel] - palette[entry][channel]) * (block[pixel][channel] - palette[entry][channel]);
+                    if (error < bestError)
+                    {
+                        best = entry;
+                        bestError = error;
+                    }
+                }
+                indices |= static_cast<uint32_t>(best) << (pixel * 2);
+            }
+        }
+
+        output[0] = color0 & 0xFF;
+        output[1] = color0 >> 8;
+        output[2] = color1 & 0xFF;
+        output[3] = color1 >> 8;
+        for (int byte = 0; byte < 4; ++byte)
+            output[4 + byte] = indices >> (byte * 8) & 0xFF;
+    }
+
+    /// @brief Compress alpha of 4x4 block to BC3 alpha block
+    /// @param block Block pixels
+    /// @param output 8 output bytes
+    void CompressAlpha(const Block& block, uint8_t* output)
+    {
+        int alpha0 = 0, alpha1 = 255;
+        for (const uint8_t* pixel : block)
+        {
+            alpha0 = std::max<int>(alpha0, pixel[3]);
+            alpha1 = std::min<int>(alpha1, pixel[3]);
+        }
+
+        uint64_t indices = 0;
+        if (alpha0 != alpha1)
+        {
+            // Eight value mode: endpoints and six interpolated values in between
+            int palette[8] = { alpha0, alpha1 };
+            for (int entry = 1; entry < 7; ++entry)
+                palette[entry + 1] = ((7 - entry) * alpha0 + entry * alpha1) / 7;
+
+            for (int pixel = 0; pixel < 16; ++pixel)
+            {
+                int best = 0;
+                for (int entry = 1; entry < 8; ++entry)
+                {
+                    if (std::abs(block[pixel][3] - palette[entry]) < std::abs(block[pixel][3] - palette[best]))
+                        best = entry;
+                }
+                indices |= static_cast<uint64_t>(best) << (pixel * 3);
+            }
+        }
+
+        output[0] = static_cast<uint8_t>(alpha0);
+        output[1] = static_cast<uint8_t>(alpha1);
+        for (int byte = 0; byte < 6; ++byte)
+            output[2 + byte] = indices >> (byte * 8) & 0xFF;
+    }
+
+    /// @brief Compress one mipmap level
+    /// @param pixels Level pixels
+    /// @param alpha Whether to compress to BC3 (with alpha) or BC1
+    /// @return Compressed blocks
+    std::vector<uint8_t> CompressLevel(const Pixels& pixels, bool alpha)
+    {
+        int blocksX = (pixels.width + 3) / 4, blocksY = (pixels.height + 3) / 4;
+        size_t blockSize = alpha ? 16 : 8;
+        std::vector<uint8_t> result(static_cast<size_t>(blocksX) * blocksY * blockSize);
+        for (int blockY = 0; blockY < blocksY; ++blockY)
+        {
+            for (int blockX = 0; blockX < blocksX; ++blockX)
+            {
+                // Edge blocks repeat the last row and column
+                Block block;
+                for (int pixel = 0; pixel < 16; ++pixel)
+                {
+                    int x = std::min(blockX * 4 + pixel % 4, pixels.width - 1);
+                    int y = std::min(blockY * 4 + pixel / 4, pixels.height - 1);
+                    std::copy_n(pixels.rgba.data() + (static_cast<size_t>(y) * pixels.width + x) * 4, 4, block[pixel]);
+                }
+
+                uint8_t* output = result.data() + (static_cast<size_t>(blockY) * blocksX + blockX) * blockSize;
+                if (alpha)
+                {
+                    CompressAlpha(block, output);
+                    output += 8;
+                }
+                CompressColor(block, output);
+            }
+        }
+        return result;
+    }
+
+    /// @brief Compress image file with full mipmap chain
+    /// @param imageFilePath Path to image file
+    /// @param verticalFlip Whether to bake vertical flip in or not
+    /// @param format Forced format ("bc1", "bc3") or empty to pick by alpha channel
+    /// @throw std::runtime_error if image couldn't be compressed
+    void Compress(const std::string& imageFilePath, bool verticalFlip, const std::string& format)
+    {
+        Image image(imageFilePath, verticalFlip);
+        bool alpha = format.empty() ? image.channels() == 2 || image.channels() == 4 : format == "bc3";
+
+        CompressedImage compressed(alpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT);
+        Pixels pixels = ToRgba(image);
+        while (true)
+        {
+            compressed.append(pixels.width, pixels.height, CompressLevel(pixels, alpha));
+            if (pixels.width == 1 && pixels.height == 1)
+                break;
+            pixels = Downsample(pixels);
+        }
+
+        std::filesystem::path outputFilePath = imageFilePath;
+        outputFilePath.replace_extension();
+        outputFilePath += verticalFlip ? CompressedImageConst::FlippedExtension : CompressedImageConst::Extension;
+        compressed.save(outputFilePath.string());
+
+        // Raw textures take 4 bytes per texel plus a third for generated mipmaps
+        double rawSize = static_cast<double>(image.width()) * image.height() * 4 * 4 / 3;
+        fmt::print(
+            "{} -> {} ({}x{}, {}, {} levels, {:.1f} KiB, {:.1f}x smaller)\n",
+            imageFilePath, outputFilePath.string(), image.width(), image.height(), alpha ? "BC3" : "BC1",
+            compressed.levels().size(), compressed.size() / 1024.0, rawSize / compressed.size()
+        );
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bool valid = true;
+    bool verticalFlip = false;
+    std::string format;
+    std::vector<std::string> imageFilePaths;
+    for (int index = 1; index < argc; ++index)
+    {
+        std::string argument = argv[index];
+        if (argument == "--flip")
+            verticalFlip = true;
+        else if (argument == "--format=bc1" || argument == "--format=bc3")
+            format = argument.substr(9);
+        else if (argument.starts_with("--"))
+            valid = false;
+        else
+            imageFilePaths.push_back(argument);
+    }
+
+    if (!valid || imageFilePaths.empty())
+    {
+        fmt::print(stderr, "Usage: TextureCompressor [--flip] [--format=bc1|bc3] <image>...\n");
+        fmt::print(stderr, "Writes <image>.dds (or <image>.flip.dds with --flip) next to every image, Texture picks them up automatically\n");
+        return -1;
+    }
+
+    try
+    {
+        for (const std::string& imageFilePath : imageFilePaths)
+            Compressor::Compress(imageFilePath, verticalFlip, format);
+    }
+    catch (const std::runtime_error& error)
+    {
+        fmt::print(stderr, "Runtime error: {}\n", error.what());
+        return -1;
+    }
+}